@@ -21,9 +21,11 @@
 
 #include <realm/group_shared.hpp>
 #include <realm/descriptor.hpp>
+#include <realm/group_by.hpp>
 #include <realm/link_view.hpp>
 #include <realm/table_view.hpp>
 #include <realm/query.hpp>
+#include <realm/query_cursor.hpp>
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
 
@@ -20,6 +20,7 @@
 #include <cstring> // std::memcpy
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <tuple>
 
 #ifdef REALM_DEBUG
@@ -32,9 +33,11 @@
 #pragma warning(disable : 4127) // Condition is constant warning
 #endif
 
+#include <realm/util/safe_int_ops.hpp>
 #include <realm/utilities.hpp>
 #include <realm/array.hpp>
 #include <realm/array_basic.hpp>
+#include <realm/impl/array_writer.hpp>
 #include <realm/impl/destroy_guard.hpp>
 #include <realm/column.hpp>
 #include <realm/query_conditions.hpp>
@@ -71,6 +74,7 @@
 //        0    |  number of bits      |  ceil(width * size / 8)
 //        1    |  number of bytes     |  width * size
 //        2    |  ignored             |  size
+//        3    |  see Encoded arrays  |  depends on the encoding
 //
 //  5: 'width_ndx' (3 bits)
 //
@@ -157,6 +161,47 @@
 // It follows from invar:bptree-nonempty-leaf that the root of an
 // empty tree (zero elements) is a leaf.
 //
+//
+// Encoded arrays:
+// ---------------
+//
+// Leaves of a B+-tree of integers (children of an inner node) that have
+// been modified, may be written to the file in an encoded form when that
+// takes up less space than the plain form (file format 11 and later), using
+// whichever encoding is smallest. Such an array has 'width_scheme' 3, 'size'
+// is the number of elements, and the header is followed by an 8-byte
+// descriptor whose first byte specifies the encoding:
+//
+//   1: Frame of reference. The descriptor is followed by the 8-byte base
+//      value and then the packed offsets, using 'width' bits per element
+//      like 'width_scheme' 0. Element i is base + offsets[i].
+//
+//   2: Run length. The second byte of the descriptor is the width (16 or
+//      32) of the run ends, and the last four bytes are the number of runs.
+//      The descriptor is followed by the packed run ends (the index of the
+//      first element after each run, in increasing order) and then, at the
+//      next 8-byte boundary, the packed run values, using 'width' bits per
+//      run like 'width_scheme' 0.
+//
+//   3: Null bitmap. The descriptor is followed by the 8-byte base value, the
+//      8-byte flagged value (the value of element 0, which is the null value
+//      of a nullable integer array), a bitmap with one bit per element that
+//      is set for the elements that have the flagged value, and then, at the
+//      next 8-byte boundary, the packed offsets of the other elements like
+//      for frame of reference. The offsets of flagged elements are zero.
+//
+//   4: Ranges. Laid out like run length, except that a run is a range of
+//      consecutive values rather than a run of equal ones, and the run
+//      value is that of its first element. 'width' is enough for every
+//      element, not just the run values. This suits sorted lists of row
+//      indexes with few gaps, such as the rows of a view.
+//
+// Encoded arrays are never modified in place. When copy-on-write happens,
+// the array is turned into a plain array (see Array::do_decode()). Besides
+// being written to the file, a leaf can be encoded in memory by
+// Array::encode(), which the views do for their row indexes. Such a leaf is
+// not read-only, but it is decoded in the same way before it is modified.
+//
 // It follows from invar:bptree-nonempty-inner and
 // invar:bptree-nonempty-leaf that in a tree with precisely one
 // element, every inner node has precisely one child, there is
@@ -233,6 +278,12 @@ void Array::init_from_mem(MemRef mem) noexcept
 
     m_ref = mem.get_ref();
     m_data = get_data_from_header(header);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Encoded)) {
+        init_encoded();
+        return;
+    }
+    m_encoding = encoding_None;
+    m_base = 0;
     set_width(m_width);
 }
 
@@ -378,8 +429,14 @@ void Array::destroy_children(size_t offset) noexcept
 }
 
 
-ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
+ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out, bool compress) const
 {
+    if (compress && out.compress_leaves) {
+        ref_type new_ref = do_write_encoded(out); // Throws
+        if (new_ref)
+            return new_ref;
+    }
+
     // Write flat array
     const char* header = get_header_from_data(m_data);
     size_t byte_size = get_byte_size();
@@ -405,7 +462,10 @@ ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified
         bool is_ref = (value != 0 && (value & 1) == 0);
         if (is_ref) {
             ref_type subref = to_ref(value);
-            ref_type new_subref = write(subref, m_alloc, out, only_if_modified); // Throws
+            // All but the first child (the offsets) of an inner B+-tree node are either
+            // inner nodes or leaves
+            bool compress = m_is_inner_bptree_node && i != 0;
+            ref_type new_subref = write(subref, m_alloc, out, only_if_modified, compress); // Throws
             value = from_ref(new_subref);
         }
         new_array.add(value); // Throws
@@ -558,6 +618,11 @@ void Array::add_to_column(IntegerColumn* column, int64_t value)
     column->add(value);
 }
 
+void Array::add_to_column(IntegerColumn* column, const int64_t* values, size_t num_values)
+{
+    column->add(values, num_values);
+}
+
 void Array::set(size_t ndx, int64_t value)
 {
     REALM_ASSERT_3(ndx, <, m_size);
@@ -619,6 +684,7 @@ void Array::insert(size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_DEBUG(ndx <= m_size);
 
+    decode(); // Throws
 
     Getter old_getter = m_getter; // Save old getter before potential width expansion
 
@@ -743,6 +809,7 @@ void Array::truncate_and_destroy_children(size_t new_size)
 
 void Array::do_ensure_minimum_width(int_fast64_t value)
 {
+    decode(); // Throws
 
     // Make room for the new value
     size_t width = bit_width(value);
@@ -778,6 +845,11 @@ void Array::set_all_to_zero()
 void Array::adjust_ge(int_fast64_t limit, int_fast64_t diff)
 {
     if (diff != 0) {
+        // An encoded array is left alone unless it has elements to adjust
+        int64_t max_value;
+        if (REALM_UNLIKELY(m_encoding != encoding_None) && (!maximum(max_value) || max_value < limit))
+            return;
+        decode(); // Throws
         for (size_t i = 0, n = size(); i != n;) {
             REALM_TEMPEX(i = adjust_ge, m_width, (i, n, limit, diff))
         }
@@ -819,6 +891,39 @@ size_t Array::adjust_ge(size_t start, size_t end, int_fast64_t limit, int_fast64
 // This method is mostly used by query_engine to enumerate table row indexes in increasing order through a TableView
 size_t Array::find_gte(const int64_t target, size_t start, size_t end) const
 {
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        if (m_encoding == encoding_RunLength) {
+            size_t result = not_found;
+            for_each_run(start, std::min(end, m_size), [&](int64_t v, size_t run_begin, size_t) {
+                if (v < target)
+                    return true;
+                result = run_begin;
+                return false;
+            });
+            return result;
+        }
+        if (m_encoding == encoding_Ranges) {
+            size_t result = not_found;
+            for_each_run(start, std::min(end, m_size), [&](int64_t v, size_t run_begin, size_t run_end) {
+                if (v + int64_t(run_end - run_begin - 1) < target)
+                    return true;
+                result = v >= target ? run_begin : run_begin + size_t(target - v);
+                return false;
+            });
+            return result;
+        }
+        if (m_encoding == encoding_NullBitmap) {
+            for (size_t i = start; i < std::min(end, m_size); ++i) {
+                if (get(i) >= target)
+                    return i;
+            }
+            return not_found;
+        }
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        return offsets.find_gte(to_offset(target), start, end);
+    }
+
     switch (m_width) {
         case 0:
             return find_gte<0>(target, start, end);
@@ -1150,16 +1255,137 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
 
 bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
+    if (REALM_UNLIKELY(m_encoding == encoding_NullBitmap)) {
+        if (end == size_t(-1))
+            end = m_size;
+        bool found = false;
+        for (size_t i = start; i < end; ++i) {
+            int64_t v = get(i);
+            if (!found || v > result) {
+                result = v;
+                if (return_ndx)
+                    *return_ndx = i;
+                found = true;
+            }
+        }
+        return found;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_RunLength)) {
+        if (end == size_t(-1))
+            end = m_size;
+        bool found = false;
+        for_each_run(start, end, [&](int64_t v, size_t run_begin, size_t) {
+            if (!found || v > result) {
+                result = v;
+                if (return_ndx)
+                    *return_ndx = run_begin;
+                found = true;
+            }
+            return true;
+        });
+        return found;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_Ranges)) {
+        if (end == size_t(-1))
+            end = m_size;
+        bool found = false;
+        for_each_run(start, end, [&](int64_t v, size_t run_begin, size_t run_end) {
+            int64_t last = v + int64_t(run_end - run_begin - 1);
+            if (!found || last > result) {
+                result = last;
+                if (return_ndx)
+                    *return_ndx = run_end - 1;
+                found = true;
+            }
+            return true;
+        });
+        return found;
+    }
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        bool found = offsets.maximum(result, start, end, return_ndx);
+        if (found)
+            result += m_base;
+        return found;
+    }
     REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx));
 }
 
 bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
 {
+    if (REALM_UNLIKELY(m_encoding == encoding_NullBitmap)) {
+        if (end == size_t(-1))
+            end = m_size;
+        bool found = false;
+        for (size_t i = start; i < end; ++i) {
+            int64_t v = get(i);
+            if (!found || v < result) {
+                result = v;
+                if (return_ndx)
+                    *return_ndx = i;
+                found = true;
+            }
+        }
+        return found;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_RunLength || m_encoding == encoding_Ranges)) {
+        if (end == size_t(-1))
+            end = m_size;
+        bool found = false;
+        for_each_run(start, end, [&](int64_t v, size_t run_begin, size_t) {
+            if (!found || v < result) {
+                result = v;
+                if (return_ndx)
+                    *return_ndx = run_begin;
+                found = true;
+            }
+            return true;
+        });
+        return found;
+    }
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        bool found = offsets.minimum(result, start, end, return_ndx);
+        if (found)
+            result += m_base;
+        return found;
+    }
     REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx));
 }
 
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        if (end == size_t(-1))
+            end = m_size;
+        // Computed with unsigned arithmetic, so that the result is right whenever the sum of the values fits
+        uint64_t s = 0;
+        if (m_encoding == encoding_RunLength) {
+            for_each_run(start, end, [&](int64_t v, size_t run_begin, size_t run_end) {
+                s += uint64_t(v) * (run_end - run_begin);
+                return true;
+            });
+        }
+        else if (m_encoding == encoding_Ranges) {
+            for_each_run(start, end, [&](int64_t v, size_t run_begin, size_t run_end) {
+                uint64_t n = run_end - run_begin;
+                s += uint64_t(v) * n + n * (n - 1) / 2;
+                return true;
+            });
+        }
+        else {
+            // Offsets of flagged elements are zero
+            size_t num_flagged = m_encoding == encoding_NullBitmap ? count_flagged(m_data, start, end) : 0;
+            int64_t flagged = num_flagged ? get_flagged_value(m_data) : 0;
+            Array offsets(m_alloc);
+            init_offsets_view(offsets);
+            s = uint64_t(m_base) * (end - start - num_flagged) + uint64_t(flagged) * num_flagged +
+                uint64_t(offsets.sum(start, end));
+        }
+        return util::from_twos_compl<int64_t>(s);
+    }
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -1331,6 +1557,35 @@ int64_t Array::sum(size_t start, size_t end) const
 
 size_t Array::count(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_encoding == encoding_RunLength)) {
+        size_t result = 0;
+        for_each_run(0, m_size, [&](int64_t v, size_t run_begin, size_t run_end) {
+            if (v == value)
+                result += run_end - run_begin;
+            return true;
+        });
+        return result;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_Ranges)) {
+        size_t result = 0;
+        for_each_run(0, m_size, [&](int64_t v, size_t run_begin, size_t run_end) {
+            if (value >= v && uint64_t(value) - uint64_t(v) < run_end - run_begin)
+                ++result;
+            return true;
+        });
+        return result;
+    }
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        size_t num_flagged = m_encoding == encoding_NullBitmap ? count_flagged(m_data, 0, m_size) : 0;
+        if (num_flagged && value == get_flagged_value(m_data))
+            return num_flagged;
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        int64_t offset = to_offset(value);
+        // Offsets of flagged elements are zero
+        return offsets.count(offset) - (offset == 0 ? num_flagged : 0);
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -1561,6 +1816,13 @@ size_t Array::calc_item_count(size_t bytes, size_t width) const noexcept
 MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
 {
     const char* header = mem.get_addr();
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Encoded)) {
+        // The clone is writable, so it must be a plain array
+        Array array{alloc};
+        array.init_from_mem(mem);
+        return array.slice(0, array.size(), target_alloc); // Throws
+    }
+
     if (!get_hasrefs_from_header(header)) {
         // This array has no subarrays, so we can make a byte-for-byte
         // copy, which is more efficient.
@@ -1625,6 +1887,11 @@ MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
 
 void Array::do_copy_on_write(size_t minimum_size)
 {
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        do_decode(minimum_size); // Throws
+        return;
+    }
+
     // Calculate size in bytes
     size_t array_size = calc_byte_len(m_size, m_width);
     size_t new_size = std::max(array_size, minimum_size);
@@ -1718,7 +1985,7 @@ void Array::alloc(size_t init_size, size_t width)
     // needed_bytes are never larger than max_array_payload.
     REALM_ASSERT_RELEASE(init_size <= max_array_size);
 
-    if (is_read_only())
+    if (is_read_only() || m_encoding != encoding_None)
         do_copy_on_write(needed_bytes);
 
     REALM_ASSERT(!m_alloc.is_read_only(m_ref));
@@ -1950,6 +2217,719 @@ void Array::set(size_t ndx, int64_t value)
 }
 
 
+// Encoded arrays
+
+template <size_t width>
+struct Array::VTableForFrameOfReference {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_for<width>;
+            setter = nullptr; // Encoded arrays are decoded before they are modified
+            chunk_getter = &Array::get_chunk_for<width>;
+            finder[cond_Equal] = &Array::find<Equal, act_ReturnFirst, width>;
+            finder[cond_NotEqual] = &Array::find<NotEqual, act_ReturnFirst, width>;
+            finder[cond_Greater] = &Array::find<Greater, act_ReturnFirst, width>;
+            finder[cond_Less] = &Array::find<Less, act_ReturnFirst, width>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+template <size_t width>
+const typename Array::VTableForFrameOfReference<width>::PopulatedVTable
+    Array::VTableForFrameOfReference<width>::vtable;
+
+template <size_t width>
+struct Array::VTableForRunLength {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_rle<width>;
+            setter = nullptr; // Encoded arrays are decoded before they are modified
+            chunk_getter = &Array::get_chunk_rle<width>;
+            finder[cond_Equal] = &Array::find<Equal, act_ReturnFirst, width>;
+            finder[cond_NotEqual] = &Array::find<NotEqual, act_ReturnFirst, width>;
+            finder[cond_Greater] = &Array::find<Greater, act_ReturnFirst, width>;
+            finder[cond_Less] = &Array::find<Less, act_ReturnFirst, width>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+template <size_t width>
+const typename Array::VTableForRunLength<width>::PopulatedVTable Array::VTableForRunLength<width>::vtable;
+
+template <size_t width>
+struct Array::VTableForRanges {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_ranges<width>;
+            setter = nullptr; // Encoded arrays are decoded before they are modified
+            chunk_getter = &Array::get_chunk_ranges<width>;
+            finder[cond_Equal] = &Array::find<Equal, act_ReturnFirst, width>;
+            finder[cond_NotEqual] = &Array::find<NotEqual, act_ReturnFirst, width>;
+            finder[cond_Greater] = &Array::find<Greater, act_ReturnFirst, width>;
+            finder[cond_Less] = &Array::find<Less, act_ReturnFirst, width>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+template <size_t width>
+const typename Array::VTableForRanges<width>::PopulatedVTable Array::VTableForRanges<width>::vtable;
+
+template <size_t width>
+struct Array::VTableForNullBitmap {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_nb<width>;
+            setter = nullptr; // Encoded arrays are decoded before they are modified
+            chunk_getter = &Array::get_chunk_nb<width>;
+            finder[cond_Equal] = &Array::find<Equal, act_ReturnFirst, width>;
+            finder[cond_NotEqual] = &Array::find<NotEqual, act_ReturnFirst, width>;
+            finder[cond_Greater] = &Array::find<Greater, act_ReturnFirst, width>;
+            finder[cond_Less] = &Array::find<Less, act_ReturnFirst, width>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+template <size_t width>
+const typename Array::VTableForNullBitmap<width>::PopulatedVTable Array::VTableForNullBitmap<width>::vtable;
+
+void Array::init_encoded() noexcept
+{
+    REALM_ASSERT_DEBUG(!m_has_refs);
+
+    // There is never room to spare, even in an array that was encoded in memory
+    m_capacity = m_size;
+    m_encoding = Encoding(m_data[0]);
+    REALM_ASSERT(m_encoding == encoding_FrameOfReference || m_encoding == encoding_RunLength ||
+                 m_encoding == encoding_NullBitmap || m_encoding == encoding_Ranges);
+    m_base = 0;
+    if (m_encoding != encoding_RunLength && m_encoding != encoding_Ranges)
+        std::memcpy(&m_base, m_data + 8, sizeof m_base);
+    REALM_TEMPEX(set_encoded_width, m_width, ());
+}
+
+template <size_t width>
+void Array::set_encoded_width() noexcept
+{
+    m_width = width;
+
+    // The bounds are those of the plain array that the encoded array turns
+    // into when it is modified, so that ensure_minimum_width() keeps working.
+    size_t decoded_width = get_decoded_width();
+    m_lbound = lbound_for_width(decoded_width);
+    m_ubound = ubound_for_width(decoded_width);
+
+    if (m_encoding == encoding_RunLength) {
+        m_vtable = &VTableForRunLength<width>::vtable;
+    }
+    else if (m_encoding == encoding_Ranges) {
+        m_vtable = &VTableForRanges<width>::vtable;
+    }
+    else if (m_encoding == encoding_NullBitmap) {
+        m_vtable = &VTableForNullBitmap<width>::vtable;
+    }
+    else {
+        m_vtable = &VTableForFrameOfReference<width>::vtable;
+    }
+    m_getter = m_vtable->getter;
+}
+
+// Returns the width that a plain array needs in order to hold any value that
+// can be represented by this encoded array.
+size_t Array::get_decoded_width() const noexcept
+{
+    // The run values are stored like the elements of a plain array, and for
+    // ranges, the width is chosen to hold every element
+    if (m_encoding == encoding_RunLength || m_encoding == encoding_Ranges)
+        return m_width;
+
+    int64_t lower = m_base;
+    int64_t upper = m_base;
+    if (int_add_with_overflow_detect(lower, lbound_for_width(m_width)) ||
+        int_add_with_overflow_detect(upper, ubound_for_width(m_width)))
+        return 64;
+    size_t width = std::max(bit_width(lower), bit_width(upper));
+    if (m_encoding == encoding_NullBitmap)
+        width = std::max(width, bit_width(get_flagged_value(m_data)));
+    return width;
+}
+
+bool Array::get_encoded_bounds(int64_t& min, int64_t& max) const noexcept
+{
+    if (m_encoding == encoding_None)
+        return false;
+
+    if (m_encoding == encoding_RunLength || m_encoding == encoding_Ranges) {
+        // There are few runs, or the array would not have been encoded this way
+        const char* values = get_run_values(m_data);
+        size_t num_runs = get_num_runs(m_data);
+        int64_t lower = std::numeric_limits<int64_t>::max();
+        int64_t upper = std::numeric_limits<int64_t>::min();
+        size_t run_begin = 0;
+        for (size_t run_ndx = 0; run_ndx < num_runs; ++run_ndx) {
+            int64_t first = get_direct(values, m_width, run_ndx);
+            size_t run_end = get_run_end(m_data, run_ndx);
+            int64_t last = m_encoding == encoding_Ranges ? first + int64_t(run_end - run_begin - 1) : first;
+            lower = std::min(lower, first);
+            upper = std::max(upper, last);
+            run_begin = run_end;
+        }
+        min = lower;
+        max = upper;
+        return true;
+    }
+
+    // The base is chosen such that the smallest offset is the smallest value
+    // of the width (see choose_offset_width())
+    int64_t lower = m_base;
+    int64_t upper = m_base;
+    if (int_add_with_overflow_detect(lower, lbound_for_width(m_width)))
+        return false;
+    if (int_add_with_overflow_detect(upper, ubound_for_width(m_width)))
+        upper = std::numeric_limits<int64_t>::max();
+    if (m_encoding == encoding_NullBitmap) {
+        int64_t flagged = get_flagged_value(m_data);
+        lower = std::min(lower, flagged);
+        upper = std::max(upper, flagged);
+    }
+    min = lower;
+    max = upper;
+    return true;
+}
+
+size_t Array::calc_encoded_byte_size(const char* header) noexcept
+{
+    const char* data = get_data_from_header(header);
+    size_t size = get_size_from_header(header);
+    size_t width = get_width_from_header(header);
+    if (data[0] == encoding_RunLength || data[0] == encoding_Ranges)
+        return calc_rle_byte_size(get_num_runs(data), size, width);
+
+    if (data[0] == encoding_NullBitmap)
+        return calc_nb_byte_size(size, width);
+    REALM_ASSERT_DEBUG(data[0] == encoding_FrameOfReference);
+    return calc_for_byte_size(size, width);
+}
+
+// Writes this array in encoded form if possible, using the encoding that
+// takes up the least space. Returns zero if the array cannot be encoded, or if
+// no encoding would be smaller than the plain form.
+ref_type Array::do_write_encoded(_impl::ArrayWriterBase& out) const
+{
+    if (m_has_refs || m_is_inner_bptree_node || m_encoding != encoding_None || m_size == 0)
+        return 0;
+    const char* header = get_header_from_data(m_data);
+    if (get_wtype_from_header(header) != wtype_Bits)
+        return 0;
+
+    // The flagged value of the null bitmap encoding is the value of the first
+    // element, which is the null value if this is the leaf of a nullable
+    // integer column.
+    int64_t flagged = get(0);
+    int64_t min_value = flagged, max_value = flagged;
+    int64_t other_min = std::numeric_limits<int64_t>::max(), other_max = std::numeric_limits<int64_t>::min();
+    size_t num_runs = 1;
+    size_t num_ranges = 1;
+    size_t num_flagged = 1;
+    for (size_t i = 1; i < m_size; ++i) {
+        int64_t v = get(i);
+        int64_t prev = get(i - 1);
+        if (v != prev)
+            ++num_runs;
+        if (uint64_t(v) - uint64_t(prev) != 1)
+            ++num_ranges;
+        min_value = std::min(min_value, v);
+        max_value = std::max(max_value, v);
+        if (v == flagged) {
+            ++num_flagged;
+        }
+        else {
+            other_min = std::min(other_min, v);
+            other_max = std::max(other_max, v);
+        }
+    }
+
+    Encoding encoding = encoding_None;
+    size_t best_byte_size = get_byte_size();
+    size_t for_width, nb_width;
+    int64_t for_base, nb_base;
+
+    // Run values are stored at the smallest width that holds all of them
+    size_t rle_width = std::max(bit_width(min_value), bit_width(max_value));
+    size_t byte_size = calc_rle_byte_size(num_runs, m_size, rle_width);
+    if (byte_size < best_byte_size) {
+        encoding = encoding_RunLength;
+        best_byte_size = byte_size;
+    }
+
+    // The elements of a range are never beyond its first and last element, so
+    // the same width holds all of them
+    byte_size = calc_rle_byte_size(num_ranges, m_size, rle_width);
+    if (byte_size < best_byte_size) {
+        encoding = encoding_Ranges;
+        best_byte_size = byte_size;
+    }
+
+    if (choose_offset_width(min_value, max_value, for_width, for_base)) {
+        byte_size = calc_for_byte_size(m_size, for_width);
+        if (byte_size < best_byte_size) {
+            encoding = encoding_FrameOfReference;
+            best_byte_size = byte_size;
+        }
+    }
+
+    if (num_flagged < m_size && choose_offset_width(other_min, other_max, nb_width, nb_base)) {
+        byte_size = calc_nb_byte_size(m_size, nb_width);
+        if (byte_size < best_byte_size) {
+            encoding = encoding_NullBitmap;
+            best_byte_size = byte_size;
+        }
+    }
+
+    switch (encoding) {
+        case encoding_None:
+            break;
+        case encoding_FrameOfReference:
+            return do_write_for(out, for_width, for_base); // Throws
+        case encoding_RunLength:
+            return do_write_rle(out, encoding_RunLength, num_runs, rle_width); // Throws
+        case encoding_Ranges:
+            return do_write_rle(out, encoding_Ranges, num_ranges, rle_width); // Throws
+        case encoding_NullBitmap:
+            return do_write_nb(out, nb_width, nb_base); // Throws
+    }
+    return 0;
+}
+
+// Finds the smallest offset width, and a base, such that every value in
+// [min_value, max_value] can be stored as an offset from the base. Returns
+// false if no width less than 64 will do.
+bool Array::choose_offset_width(int64_t min_value, int64_t max_value, size_t& width, int64_t& base) noexcept
+{
+    uint64_t span = uint64_t(max_value) - uint64_t(min_value);
+    static const size_t widths[] = {0, 1, 2, 4, 8, 16, 32};
+    for (size_t w : widths) {
+        int64_t lbound = lbound_for_width(w);
+        if (span > uint64_t(ubound_for_width(w) - lbound))
+            continue;
+        base = min_value;
+        if (int_subtract_with_overflow_detect(base, lbound))
+            continue;
+        width = w;
+        return true;
+    }
+    return false;
+}
+
+
+// Frame-of-reference encoding
+
+// Makes 'view' a plain, read-only accessor for the packed offsets of this
+// array. It must not outlive this accessor.
+void Array::init_offsets_view(Array& view) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_encoding == encoding_FrameOfReference || m_encoding == encoding_NullBitmap);
+    view.m_is_inner_bptree_node = false;
+    view.m_has_refs = false;
+    view.m_context_flag = false;
+    view.m_data = const_cast<char*>(get_offsets_data(m_data, m_size));
+    view.m_size = m_size;
+    view.m_capacity = m_size;
+    view.set_width(m_width);
+}
+
+// Translates a search value into the corresponding offset. Values that are
+// too far from the base to be represented are clamped, which preserves the
+// outcome of any comparison with a stored offset.
+int64_t Array::to_offset(int64_t value) const noexcept
+{
+    int64_t offset = value;
+    if (int_subtract_with_overflow_detect(offset, m_base))
+        return m_base > 0 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+    return offset;
+}
+
+const char* Array::get_offsets_data(const char* data, size_t size) noexcept
+{
+    if (data[0] == encoding_FrameOfReference)
+        return data + for_prefix_size;
+    REALM_ASSERT_DEBUG(data[0] == encoding_NullBitmap);
+    size_t bitmap_bytes = ((size + 7) / 8 + 7) & ~size_t(7); // 64bit blocks
+    return data + nb_prefix_size + bitmap_bytes;
+}
+
+size_t Array::calc_for_byte_size(size_t size, size_t width) noexcept
+{
+    size_t num_bytes = ((size * width + 7) / 8 + 7) & ~size_t(7); // 64bit blocks
+    return header_size + for_prefix_size + num_bytes;
+}
+
+template <size_t w>
+int64_t Array::get_for(size_t ndx) const noexcept
+{
+    return m_base + get_universal<w>(m_data + for_prefix_size, ndx);
+}
+
+template <size_t w>
+void Array::get_chunk_for(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+
+    size_t i = 0;
+    for (; i + ndx < m_size && i < 8; i++)
+        res[i] = get_for<w>(ndx + i);
+
+    for (; i < 8; i++)
+        res[i] = 0;
+}
+
+template <size_t width>
+void Array::encode_offsets(char* data, int64_t base) const noexcept
+{
+    for (size_t i = 0; i < m_size; ++i)
+        set_direct<width>(data, i, get(i) - base);
+}
+
+ref_type Array::do_write_for(_impl::ArrayWriterBase& out, size_t width, int64_t base) const
+{
+    size_t byte_size = calc_for_byte_size(m_size, width);
+    std::unique_ptr<char[]> buffer(new char[byte_size]()); // Throws
+    char* header = buffer.get();
+    init_header(header, false, false, m_context_flag, wtype_Encoded, int(width), m_size, byte_size);
+    char* data = get_data_from_header(header);
+    data[0] = encoding_FrameOfReference;
+    std::memcpy(data + 8, &base, sizeof base);
+    REALM_TEMPEX(encode_offsets, width, (data + for_prefix_size, base));
+
+    uint32_t dummy_checksum = 0x41414141UL;                                 // "AAAA" in ASCII
+    ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);                                     // 8-byte alignment
+    return new_ref;
+}
+
+
+// Run-length encoding
+
+// Run ends are stored as 16-bit values when possible, otherwise as 32-bit values
+static size_t run_end_width(size_t size) noexcept
+{
+    return size <= size_t(std::numeric_limits<int16_t>::max()) ? 16 : 32;
+}
+
+size_t Array::get_num_runs(const char* data) noexcept
+{
+    uint32_t num_runs;
+    std::memcpy(&num_runs, data + 4, sizeof num_runs);
+    return num_runs;
+}
+
+// Returns the index of the element that follows the specified run
+size_t Array::get_run_end(const char* data, size_t run_ndx) noexcept
+{
+    const char* ends = data + rle_prefix_size;
+    if (data[1] == 16)
+        return size_t(get_direct<16>(ends, run_ndx));
+    return size_t(get_direct<32>(ends, run_ndx));
+}
+
+const char* Array::get_run_values(const char* data) noexcept
+{
+    size_t num_bytes = get_num_runs(data) * size_t(data[1]) / 8;
+    num_bytes = (num_bytes + 7) & ~size_t(7); // 64bit blocks
+    return data + rle_prefix_size + num_bytes;
+}
+
+// Returns the index of the run that contains the specified element
+size_t Array::find_run(const char* data, size_t ndx) noexcept
+{
+    const char* ends = data + rle_prefix_size;
+    size_t num_runs = get_num_runs(data);
+    if (data[1] == 16)
+        return realm::upper_bound<16>(ends, num_runs, int64_t(ndx));
+    return realm::upper_bound<32>(ends, num_runs, int64_t(ndx));
+}
+
+size_t Array::calc_rle_byte_size(size_t num_runs, size_t size, size_t width) noexcept
+{
+    size_t ends_bytes = (num_runs * run_end_width(size) / 8 + 7) & ~size_t(7);
+    size_t values_bytes = ((num_runs * width + 7) / 8 + 7) & ~size_t(7);
+    return header_size + rle_prefix_size + ends_bytes + values_bytes;
+}
+
+template <size_t w>
+int64_t Array::get_rle(size_t ndx) const noexcept
+{
+    return get_universal<w>(get_run_values(m_data), find_run(m_data, ndx));
+}
+
+template <size_t w>
+void Array::get_chunk_rle(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+
+    size_t end = std::min(ndx + 8, m_size);
+    int64_t* p = res;
+    for_each_run(ndx, end, [&](int64_t v, size_t run_begin, size_t run_end) {
+        p = std::fill_n(p, run_end - run_begin, v);
+        return true;
+    });
+    std::fill(p, res + 8, 0);
+}
+
+template <size_t w>
+int64_t Array::get_ranges(size_t ndx) const noexcept
+{
+    size_t run_ndx = find_run(m_data, ndx);
+    size_t run_begin = run_ndx == 0 ? 0 : get_run_end(m_data, run_ndx - 1);
+    return get_universal<w>(get_run_values(m_data), run_ndx) + int64_t(ndx - run_begin);
+}
+
+template <size_t w>
+void Array::get_chunk_ranges(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+
+    size_t end = std::min(ndx + 8, m_size);
+    int64_t* p = res;
+    for_each_run(ndx, end, [&](int64_t v, size_t run_begin, size_t run_end) {
+        for (size_t i = run_begin; i < run_end; ++i)
+            *p++ = v++;
+        return true;
+    });
+    std::fill(p, res + 8, 0);
+}
+
+// Also encodes ranges, depending on the encoding in `data`
+template <size_t width>
+void Array::encode_runs(char* data) const noexcept
+{
+    char* ends = data + rle_prefix_size;
+    bool wide_ends = data[1] == 32;
+    bool ranges = data[0] == encoding_Ranges;
+    char* values = const_cast<char*>(get_run_values(data));
+    size_t run_ndx = 0;
+    size_t run_begin = 0;
+    for (size_t i = 1; i <= m_size; ++i) {
+        if (i < m_size && (ranges ? uint64_t(get(i)) - uint64_t(get(i - 1)) == 1 : get(i) == get(i - 1)))
+            continue;
+        if (wide_ends) {
+            set_direct<32>(ends, run_ndx, int64_t(i));
+        }
+        else {
+            set_direct<16>(ends, run_ndx, int64_t(i));
+        }
+        set_direct<width>(values, run_ndx, get(run_begin));
+        run_begin = i;
+        ++run_ndx;
+    }
+    REALM_ASSERT_DEBUG(run_ndx == get_num_runs(data));
+}
+
+ref_type Array::do_write_rle(_impl::ArrayWriterBase& out, Encoding encoding, size_t num_runs, size_t width) const
+{
+    REALM_ASSERT_DEBUG(encoding == encoding_RunLength || encoding == encoding_Ranges);
+    size_t byte_size = calc_rle_byte_size(num_runs, m_size, width);
+    std::unique_ptr<char[]> buffer(new char[byte_size]()); // Throws
+    char* header = buffer.get();
+    init_header(header, false, false, m_context_flag, wtype_Encoded, int(width), m_size, byte_size);
+    char* data = get_data_from_header(header);
+    data[0] = encoding;
+    data[1] = char(run_end_width(m_size));
+    uint32_t num_runs_2 = uint32_t(num_runs);
+    std::memcpy(data + 4, &num_runs_2, sizeof num_runs_2);
+    REALM_TEMPEX(encode_runs, width, (data));
+
+    uint32_t dummy_checksum = 0x41414141UL;                                 // "AAAA" in ASCII
+    ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);                                     // 8-byte alignment
+    return new_ref;
+}
+
+// Null bitmap encoding
+
+bool Array::is_flagged(const char* data, size_t ndx) noexcept
+{
+    const unsigned char* bitmap = reinterpret_cast<const unsigned char*>(data + nb_prefix_size);
+    return (bitmap[ndx >> 3] >> (ndx & 7)) & 1;
+}
+
+int64_t Array::get_flagged_value(const char* data) noexcept
+{
+    int64_t flagged;
+    std::memcpy(&flagged, data + 16, sizeof flagged);
+    return flagged;
+}
+
+size_t Array::count_flagged(const char* data, size_t start, size_t end) noexcept
+{
+    size_t count = 0;
+    for (; start < end && (start & 7) != 0; ++start)
+        count += is_flagged(data, start);
+    const unsigned char* bitmap = reinterpret_cast<const unsigned char*>(data + nb_prefix_size);
+    for (; start + 8 <= end; start += 8)
+        count += fast_popcount32(bitmap[start >> 3]);
+    for (; start < end; ++start)
+        count += is_flagged(data, start);
+    return count;
+}
+
+size_t Array::calc_nb_byte_size(size_t size, size_t width) noexcept
+{
+    size_t bitmap_bytes = ((size + 7) / 8 + 7) & ~size_t(7);           // 64bit blocks
+    size_t offsets_bytes = ((size * width + 7) / 8 + 7) & ~size_t(7); // 64bit blocks
+    return header_size + nb_prefix_size + bitmap_bytes + offsets_bytes;
+}
+
+template <size_t w>
+int64_t Array::get_nb(size_t ndx) const noexcept
+{
+    if (is_flagged(m_data, ndx))
+        return get_flagged_value(m_data);
+    return m_base + get_universal<w>(get_offsets_data(m_data, m_size), ndx);
+}
+
+template <size_t w>
+void Array::get_chunk_nb(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+
+    size_t i = 0;
+    for (; i + ndx < m_size && i < 8; i++)
+        res[i] = get_nb<w>(ndx + i);
+
+    for (; i < 8; i++)
+        res[i] = 0;
+}
+
+template <size_t width>
+void Array::encode_flagged(char* data, int64_t base) const noexcept
+{
+    int64_t flagged = get_flagged_value(data);
+    unsigned char* bitmap = reinterpret_cast<unsigned char*>(data + nb_prefix_size);
+    char* offsets = const_cast<char*>(get_offsets_data(data, m_size));
+    for (size_t i = 0; i < m_size; ++i) {
+        int64_t v = get(i);
+        if (v == flagged) {
+            bitmap[i >> 3] |= 1 << (i & 7);
+        }
+        else {
+            set_direct<width>(offsets, i, v - base);
+        }
+    }
+}
+
+ref_type Array::do_write_nb(_impl::ArrayWriterBase& out, size_t width, int64_t base) const
+{
+    size_t byte_size = calc_nb_byte_size(m_size, width);
+    std::unique_ptr<char[]> buffer(new char[byte_size]()); // Throws
+    char* header = buffer.get();
+    init_header(header, false, false, m_context_flag, wtype_Encoded, int(width), m_size, byte_size);
+    char* data = get_data_from_header(header);
+    data[0] = encoding_NullBitmap;
+    std::memcpy(data + 8, &base, sizeof base);
+    int64_t flagged = get(0);
+    std::memcpy(data + 16, &flagged, sizeof flagged);
+    REALM_TEMPEX(encode_flagged, width, (data, base));
+
+    uint32_t dummy_checksum = 0x41414141UL;                                 // "AAAA" in ASCII
+    ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);                                     // 8-byte alignment
+    return new_ref;
+}
+
+namespace {
+
+// Writes arrays to new memory from an allocator, for Array::encode()
+class AllocArrayWriter : public _impl::ArrayWriterBase {
+public:
+    AllocArrayWriter(Allocator& alloc)
+        : m_alloc(alloc)
+    {
+    }
+
+    ref_type write_array(const char* data, size_t size, uint32_t) override
+    {
+        MemRef mem = m_alloc.alloc(size); // Throws
+        realm::safe_copy_n(data, size, mem.get_addr());
+        return mem.get_ref();
+    }
+
+private:
+    Allocator& m_alloc;
+};
+
+} // anonymous namespace
+
+void Array::encode()
+{
+    if (is_read_only())
+        return;
+
+    AllocArrayWriter out(m_alloc);
+    ref_type new_ref = do_write_encoded(out); // Throws
+    if (!new_ref)
+        return;
+
+    ref_type old_ref = m_ref;
+    const char* old_begin = get_header_from_data(m_data);
+    init_from_ref(new_ref);
+    update_parent();
+    m_alloc.free_(old_ref, old_begin);
+}
+
+template <size_t width>
+static void decode_into(const Array& array, char* data) noexcept
+{
+    size_t n = array.size();
+    for (size_t i = 0; i < n; ++i)
+        set_direct<width>(data, i, array.get(i));
+}
+
+// Replaces an encoded array by a plain copy, like do_copy_on_write() does for
+// plain arrays. The width is chosen such that the bounds established by
+// set_encoded_width() hold.
+void Array::do_decode(size_t minimum_size)
+{
+    size_t width = get_decoded_width();
+    size_t array_size = calc_aligned_byte_size(m_size, int(width)); // Throws
+    size_t new_size = std::max(array_size, minimum_size);
+    new_size = (new_size + 0x7) & ~size_t(0x7); // 64bit blocks
+    // Plus a bit of matchcount room for expansion
+    new_size += 64;
+
+    MemRef mref = m_alloc.alloc(new_size); // Throws
+    char* new_begin = mref.get_addr();
+    init_header(new_begin, m_is_inner_bptree_node, m_has_refs, m_context_flag, wtype_Bits, int(width), m_size,
+                new_size);
+    REALM_TEMPEX(decode_into, width, (*this, get_data_from_header(new_begin)));
+
+    ref_type old_ref = m_ref;
+    const char* old_begin = get_header_from_data(m_data);
+
+    // Update internal data
+    m_encoding = encoding_None;
+    m_base = 0;
+    m_ref = mref.get_ref();
+    m_data = get_data_from_header(new_begin);
+    set_width(width);
+    m_capacity = calc_item_count(new_size, m_width);
+    REALM_ASSERT_DEBUG(m_capacity > 0);
+
+    update_parent();
+
+    // Mark original as deleted, so that the space can be reclaimed in
+    // future commits, when no versions are using it anymore
+    m_alloc.free_(old_ref, old_begin);
+}
+
+
 // FIXME: Not exception safe (leaks are possible).
 ref_type Array::bptree_leaf_insert(size_t ndx, int64_t value, TreeInsertBase& state)
 {
@@ -2368,11 +3348,81 @@ void Array::to_dot_parent_edge(std::ostream& out) const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_encoding == encoding_NullBitmap)) {
+        size_t low = 0, high = m_size;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (get(mid) < value) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_RunLength)) {
+        size_t result = m_size;
+        for_each_run(0, m_size, [&](int64_t v, size_t run_begin, size_t) {
+            if (v < value)
+                return true;
+            result = run_begin;
+            return false;
+        });
+        return result;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_Ranges)) {
+        size_t result = find_gte(value, 0, m_size);
+        return result == not_found ? m_size : result;
+    }
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        return offsets.lower_bound_int(to_offset(value));
+    }
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_encoding == encoding_NullBitmap)) {
+        size_t low = 0, high = m_size;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (get(mid) <= value) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_RunLength)) {
+        size_t result = m_size;
+        for_each_run(0, m_size, [&](int64_t v, size_t run_begin, size_t) {
+            if (v <= value)
+                return true;
+            result = run_begin;
+            return false;
+        });
+        return result;
+    }
+    if (REALM_UNLIKELY(m_encoding == encoding_Ranges)) {
+        size_t result = m_size;
+        for_each_run(0, m_size, [&](int64_t v, size_t run_begin, size_t run_end) {
+            if (v + int64_t(run_end - run_begin - 1) <= value)
+                return true;
+            result = v > value ? run_begin : run_begin + size_t(value - v) + 1;
+            return false;
+        });
+        return result;
+    }
+    if (REALM_UNLIKELY(m_encoding != encoding_None)) {
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        return offsets.upper_bound_int(to_offset(value));
+    }
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
@@ -2388,6 +3438,7 @@ void Array::find_all(IntegerColumn* result, int64_t value, size_t col_offset, si
     QueryState<int64_t> state;
     state.init(act_FindAll, result, static_cast<size_t>(-1));
     REALM_TEMPEX3(find, Equal, act_FindAll, m_width, (value, begin, end, col_offset, &state, CallbackDummy()));
+    state.flush_matches(); // Throws
 
     return;
 }
@@ -2428,12 +3479,28 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Encoded)) {
+        if (data[0] == encoding_RunLength)
+            return get_direct(get_run_values(data), width, find_run(data, ndx));
+        if (data[0] == encoding_Ranges) {
+            size_t run_ndx = find_run(data, ndx);
+            size_t run_begin = run_ndx == 0 ? 0 : get_run_end(data, run_ndx - 1);
+            return get_direct(get_run_values(data), width, run_ndx) + int64_t(ndx - run_begin);
+        }
+        if (data[0] == encoding_NullBitmap && is_flagged(data, ndx))
+            return get_flagged_value(data);
+        size_t size = get_size_from_header(header);
+        int64_t base = *reinterpret_cast<const int64_t*>(data + 8);
+        return base + get_direct(get_offsets_data(data, size), width, ndx);
+    }
     return get_direct(data, width, ndx);
 }
 
 
 std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Encoded))
+        return std::make_pair(get(header, ndx), get(header, ndx + 1));
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
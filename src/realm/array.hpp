@@ -70,6 +70,9 @@ Searching: The main finding function is:
 #include <emmintrin.h>             // SSE2
 #include <realm/realm_nmmintrin.h> // SSE42
 #endif
+#ifdef REALM_COMPILER_AVX2
+#include <immintrin.h> // AVX2 and AVX-512, only used inside REALM_TARGET_AVX2 / REALM_TARGET_AVX512 functions
+#endif
 
 namespace realm {
 
@@ -345,6 +348,7 @@ public:
 
 
     static void add_to_column(IntegerColumn* column, int64_t value);
+    static void add_to_column(IntegerColumn* column, const int64_t* values, size_t num_values);
 
     void insert(size_t ndx, int_fast64_t value);
     void add(int_fast64_t value);
@@ -624,11 +628,18 @@ public:
     ///
     /// \param only_if_modified Set to `false` to always write, or to `true` to
     /// only write the array if it has been modified.
-    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const;
+    ///
+    /// \param compress If true, and this is a plain integer array without
+    /// refs, it is written in an encoded form if that takes up less space and
+    /// \a out allows it (_impl::ArrayWriterBase::compress_leaves). Only arrays
+    /// that are always accessed through an Array accessor (B+-tree leaves of
+    /// integer columns) may be written this way.
+    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress = false) const;
 
     /// Same as non-static write() with `deep` set to true. This is for the
     /// cases where you do not already have an array accessor available.
-    static ref_type write(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified);
+    static ref_type write(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified,
+                          bool compress = false);
 
     // Main finding function - used for find_first, find_all, sum, max, min, etc.
     bool find(int cond, Action action, int64_t value, size_t start, size_t end, size_t baseindex,
@@ -761,6 +772,28 @@ public:
 
 #endif
 
+// AVX2 / AVX-512 find for the four functions Equal/NotEqual/Less/Greater. Only called if sseavx<2>() respectively
+// sseavx<512>() returns true.
+#ifdef REALM_COMPILER_AVX2
+    template <class cond, Action action, size_t width, class Callback, size_t vector_size>
+    bool find_avx(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                  Callback callback) const;
+
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX2 bool find_avx2(int64_t value, const char* data, size_t items, QueryState<int64_t>* state,
+                                     size_t baseindex, Callback callback) const;
+
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX512 bool find_avx512(int64_t value, const char* data, size_t items,
+                                         QueryState<int64_t>* state, size_t baseindex, Callback callback) const;
+#endif
+
+    // Performs the aggregate action for each element of a SIMD chunk whose bit is set in 'mask' (bit i represents
+    // element i of the chunk, which starts at 'chunk_data' and has row index 'index')
+    template <Action action, size_t width, class Callback>
+    REALM_FORCEINLINE bool find_action_mask(uint64_t mask, const char* chunk_data, size_t index,
+                                            QueryState<int64_t>* state, Callback callback) const;
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -807,12 +840,34 @@ public:
     static void get_three(const char* data, size_t ndx, ref_type& v0, ref_type& v1, ref_type& v2) noexcept;
 
     /// The meaning of 'width' depends on the context in which this
-    /// array is used.
+    /// array is used. For an encoded array it is the width of the packed
+    /// offsets.
     size_t get_width() const noexcept
     {
         return m_width;
     }
 
+    /// Returns true if this array is stored in an encoded form (see "Encoded
+    /// arrays" in array.cpp). Encoded arrays are turned into plain arrays when
+    /// they are modified.
+    bool is_encoded() const noexcept
+    {
+        return m_encoding != encoding_None;
+    }
+
+    /// If this array is encoded, get bounds of its elements without looking
+    /// at every element. The lower bound is the smallest element. For the
+    /// encodings with a base value, the upper bound is the largest value that
+    /// the offset width allows, and for the others it is the largest
+    /// element. Returns false if this array is not encoded.
+    bool get_encoded_bounds(int64_t& min, int64_t& max) const noexcept;
+
+    /// Replace this array by an encoded copy in the same allocator, if that
+    /// takes up less space, like when it is written with `compress` (see
+    /// write()). The same restrictions apply. Has no effect on read-only
+    /// arrays.
+    void encode();
+
     static char* get_data_from_header(char*) noexcept;
     static char* get_header_from_data(char*) noexcept;
     static const char* get_data_from_header(const char*) noexcept;
@@ -821,6 +876,7 @@ public:
         wtype_Bits = 0,
         wtype_Multiply = 1,
         wtype_Ignore = 2,
+        wtype_Encoded = 3, // Encoded integer array, see "Encoded arrays" in array.cpp
     };
 
     static bool get_is_inner_bptree_node_from_header(const char*) noexcept;
@@ -944,8 +1000,14 @@ protected:
     void alloc(size_t init_size, size_t width);
     void copy_on_write();
 
+    /// Turn an encoded array into a plain one (through copy-on-write). This
+    /// must be called by modifying functions that depend on the width or the
+    /// bounds of the array before they call copy_on_write().
+    void decode();
+
 private:
     void do_copy_on_write(size_t minimum_size = 0);
+    void do_decode(size_t minimum_size);
     void do_ensure_minimum_width(int_fast64_t);
 
     template <size_t w>
@@ -960,6 +1022,66 @@ private:
     template <size_t w>
     size_t adjust_ge(size_t start, size_t end, int_fast64_t limit, int_fast64_t diff);
 
+    // Encoded arrays
+    void init_encoded() noexcept;
+    template <size_t width>
+    void set_encoded_width() noexcept;
+    size_t get_decoded_width() const noexcept;
+    template <class cond, Action action, size_t bitwidth, class Callback>
+    bool find_encoded(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                      Callback callback, bool nullable_array, bool find_null) const;
+    ref_type do_write_encoded(_impl::ArrayWriterBase&) const;
+    static size_t calc_encoded_byte_size(const char* header) noexcept;
+    static bool choose_offset_width(int64_t min_value, int64_t max_value, size_t& width, int64_t& base) noexcept;
+
+    // Frame-of-reference encoding (also used for the non-flagged elements of
+    // the null bitmap encoding)
+    void init_offsets_view(Array& view) const noexcept;
+    int64_t to_offset(int64_t value) const noexcept;
+    static const char* get_offsets_data(const char* data, size_t size) noexcept;
+    template <size_t w>
+    int64_t get_for(size_t ndx) const noexcept;
+    template <size_t w>
+    void get_chunk_for(size_t ndx, int64_t res[8]) const noexcept;
+    ref_type do_write_for(_impl::ArrayWriterBase&, size_t width, int64_t base) const;
+    template <size_t width>
+    void encode_offsets(char* data, int64_t base) const noexcept;
+    static size_t calc_for_byte_size(size_t size, size_t width) noexcept;
+
+    // Null bitmap encoding
+    template <size_t w>
+    int64_t get_nb(size_t ndx) const noexcept;
+    template <size_t w>
+    void get_chunk_nb(size_t ndx, int64_t res[8]) const noexcept;
+    static bool is_flagged(const char* data, size_t ndx) noexcept;
+    static int64_t get_flagged_value(const char* data) noexcept;
+    static size_t count_flagged(const char* data, size_t start, size_t end) noexcept;
+    ref_type do_write_nb(_impl::ArrayWriterBase&, size_t width, int64_t base) const;
+    template <size_t width>
+    void encode_flagged(char* data, int64_t base) const noexcept;
+    static size_t calc_nb_byte_size(size_t size, size_t width) noexcept;
+
+    // Run-length encoding (also used for ranges, which share its layout)
+    template <size_t w>
+    int64_t get_rle(size_t ndx) const noexcept;
+    template <size_t w>
+    void get_chunk_rle(size_t ndx, int64_t res[8]) const noexcept;
+    template <size_t w>
+    int64_t get_ranges(size_t ndx) const noexcept;
+    template <size_t w>
+    void get_chunk_ranges(size_t ndx, int64_t res[8]) const noexcept;
+    template <class F>
+    bool for_each_run(size_t start, size_t end, F) const;
+    static size_t get_num_runs(const char* data) noexcept;
+    static size_t get_run_end(const char* data, size_t run_ndx) noexcept;
+    static const char* get_run_values(const char* data) noexcept;
+    static size_t find_run(const char* data, size_t ndx) noexcept;
+    enum Encoding : uint_least8_t;
+    ref_type do_write_rle(_impl::ArrayWriterBase&, Encoding, size_t num_runs, size_t width) const;
+    template <size_t width>
+    void encode_runs(char* data) const noexcept;
+    static size_t calc_rle_byte_size(size_t num_runs, size_t size, size_t width) noexcept;
+
 protected:
     /// The total size in bytes (including the header) of a new empty
     /// array. Must be a multiple of 8 (i.e., 64-bit aligned).
@@ -1008,6 +1130,14 @@ protected:
     };
     template <size_t w>
     struct VTableForWidth;
+    template <size_t w>
+    struct VTableForFrameOfReference;
+    template <size_t w>
+    struct VTableForRunLength;
+    template <size_t w>
+    struct VTableForRanges;
+    template <size_t w>
+    struct VTableForNullBitmap;
 
 protected:
     /// Takes a 64-bit value and returns the minimum number of bits needed
@@ -1053,7 +1183,30 @@ protected:
     bool m_context_flag;         // Meaning depends on context.
 
 private:
-    ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
+    enum Encoding : uint_least8_t {
+        encoding_None = 0,
+        encoding_FrameOfReference = 1,
+        encoding_RunLength = 2,
+        encoding_NullBitmap = 3,
+        encoding_Ranges = 4,
+    };
+
+    // Number of bytes between the header and the packed offsets of a
+    // frame-of-reference encoded array (encoding descriptor and base value).
+    static const size_t for_prefix_size = 16;
+
+    // Number of bytes between the header and the run ends of a run-length
+    // encoded array (encoding descriptor).
+    static const size_t rle_prefix_size = 8;
+
+    // Number of bytes between the header and the bitmap of a null bitmap
+    // encoded array (encoding descriptor, base value and flagged value).
+    static const size_t nb_prefix_size = 24;
+
+    Encoding m_encoding = encoding_None;
+    int64_t m_base = 0; // Frame of reference, added to every packed offset
+
+    ref_type do_write_shallow(_impl::ArrayWriterBase&, bool compress = false) const;
     ref_type do_write_deep(_impl::ArrayWriterBase&, bool only_if_modified) const;
     static size_t calc_byte_size(WidthType wtype, size_t size, uint_least8_t width) noexcept;
 
@@ -1079,6 +1232,9 @@ public:
     size_t m_limit;
     size_t m_minmax_index; // used only for min/max, to save index of current min/max value
 
+    // Matches of act_FindAll that have not yet been added to the column
+    std::vector<int64_t> m_matches;
+
     template <Action action>
     bool uses_val()
     {
@@ -1093,6 +1249,7 @@ public:
         m_match_count = 0;
         m_limit = limit;
         m_minmax_index = not_found;
+        m_matches.clear();
 
         if (action == act_Max)
             m_state = -0x7fffffffffffffffLL - 1LL;
@@ -1113,6 +1270,23 @@ public:
         }
     }
 
+    /// The matches of act_FindAll are added to the column a leaf at a time,
+    /// which is much faster than one at a time when there are many. This adds
+    /// the remaining matches, and must be called when the search is done.
+    void flush_matches()
+    {
+        Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), m_matches.data(),
+                             m_matches.size()); // Throws
+        m_matches.clear();
+    }
+
+    void add_match(size_t index)
+    {
+        m_matches.push_back(int64_t(index)); // Throws
+        if (m_matches.size() == REALM_MAX_BPNODE_SIZE)
+            flush_matches(); // Throws
+    }
+
     template <Action action, bool pattern>
     inline bool match(size_t index, uint64_t indexpattern, int64_t value)
     {
@@ -1153,7 +1327,7 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
+            add_match(index);
         }
         else if (action == act_ReturnFirst) {
             m_state = index;
@@ -1180,7 +1354,7 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            Array::add_to_column(reinterpret_cast<IntegerColumn*>(m_state), index);
+            add_match(index);
         }
         else if (action == act_ReturnFirst) {
             m_match_count++;
@@ -1478,7 +1652,7 @@ inline void Array::destroy_deep() noexcept
     m_data = nullptr;
 }
 
-inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const
+inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress) const
 {
     REALM_ASSERT(is_attached());
 
@@ -1486,12 +1660,13 @@ inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_i
         return m_ref;
 
     if (!deep || !m_has_refs)
-        return do_write_shallow(out); // Throws
+        return do_write_shallow(out, compress); // Throws
 
     return do_write_deep(out, only_if_modified); // Throws
 }
 
-inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified)
+inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified,
+                             bool compress)
 {
     if (only_if_modified && alloc.is_read_only(ref))
         return ref;
@@ -1500,7 +1675,7 @@ inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterB
     array.init_from_ref(ref);
 
     if (!array.m_has_refs)
-        return array.do_write_shallow(out); // Throws
+        return array.do_write_shallow(out, compress); // Throws
 
     return array.do_write_deep(out, only_if_modified); // Throws
 }
@@ -1814,6 +1989,10 @@ inline size_t Array::calc_byte_size(WidthType wtype, size_t size, uint_least8_t
         case wtype_Ignore:
             num_bytes = size;
             break;
+        case wtype_Encoded:
+            // Depends on the encoding, see calc_encoded_byte_size()
+            REALM_ASSERT_DEBUG(false);
+            break;
     }
 
     // Ensure 8-byte alignment
@@ -1828,6 +2007,8 @@ inline size_t Array::get_byte_size() const noexcept
 {
     const char* header = get_header_from_data(m_data);
     WidthType wtype = get_wtype_from_header(header);
+    if (REALM_UNLIKELY(wtype == wtype_Encoded))
+        return calc_encoded_byte_size(header);
     size_t num_bytes = calc_byte_size(wtype, m_size, m_width);
 
     REALM_ASSERT_7(m_alloc.is_read_only(m_ref), ==, true, ||, num_bytes, <=, get_capacity_from_header(header));
@@ -1841,6 +2022,8 @@ inline size_t Array::get_byte_size_from_header(const char* header) noexcept
     size_t size = get_size_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     WidthType wtype = get_wtype_from_header(header);
+    if (REALM_UNLIKELY(wtype == wtype_Encoded))
+        return calc_encoded_byte_size(header);
     size_t num_bytes = calc_byte_size(wtype, size, width);
 
     return num_bytes;
@@ -1982,12 +2165,18 @@ inline void Array::copy_on_write()
     // member)
     if (!m_no_relocation) {
 #else
-    if (is_read_only()) {
+    if (is_read_only() || REALM_UNLIKELY(m_encoding != encoding_None)) {
 #endif
         do_copy_on_write();
     }
 }
 
+inline void Array::decode()
+{
+    if (REALM_UNLIKELY(m_encoding != encoding_None))
+        do_copy_on_write(); // Throws
+}
+
 inline void Array::ensure_minimum_width(int_fast64_t value)
 {
     if (value >= m_lbound && value <= m_ubound)
@@ -2315,6 +2504,19 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX2)
+    // AVX2 and AVX-512 have compare instructions for all four conditions at every width from 8 bits and up (64-bit
+    // Less included), so prefer them whenever the payload spans at least two vectors.
+    if ((std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value ||
+         std::is_same<cond, Greater>::value || std::is_same<cond, Less>::value) &&
+        m_width >= 8) {
+        if ((end - start2) * bitwidth >= 2 * 512 && sseavx<512>())
+            return find_avx<cond, action, bitwidth, Callback, 64>(value, start2, end, baseindex, state, callback);
+        if ((end - start2) * bitwidth >= 2 * 256 && sseavx<2>())
+            return find_avx<cond, action, bitwidth, Callback, 32>(value, start2, end, baseindex, state, callback);
+    }
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -2687,7 +2889,7 @@ inline bool Array::compare_equality(int64_t value, size_t start, size_t end, siz
                 if (a >= 64 / no0(width))
                     break;
 
-                if (!find_action<action, Callback>(a + start + baseindex, get<width>(start + t), state, callback))
+                if (!find_action<action, Callback>(a + start + baseindex, get<width>(start + a), state, callback))
                     return false;
                 v2 >>= (t + 1) * width;
                 a += 1;
@@ -2736,10 +2938,165 @@ template <class cond, Action action, size_t bitwidth, class Callback>
 bool Array::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                  Callback callback, bool nullable_array, bool find_null) const
 {
+    if (REALM_UNLIKELY(m_encoding != encoding_None))
+        return find_encoded<cond, action, bitwidth, Callback>(value, start, end, baseindex, state, callback,
+                                                              nullable_array, find_null);
     return find_optimized<cond, action, bitwidth, Callback>(value, start, end, baseindex, state, callback,
                                                             nullable_array, find_null);
 }
 
+// Run-length encoded arrays are searched one run at a time, and counting reports a matching run in one step.
+//
+// Null bitmap encoded arrays are searched like frame-of-reference encoded arrays, with the flagged elements (the
+// nulls of a nullable array) masked out of the matches, unless the flagged value itself can match.
+//
+// Frame-of-reference encoded arrays are searched by applying the condition to the packed offsets, which only gives
+// the right matches as long as the values themselves are not needed. Aggregates, and searches in nullable arrays
+// (which compare against the null value), visit the decoded values instead.
+template <class cond, Action action, size_t bitwidth, class Callback>
+bool Array::find_encoded(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                         Callback callback, bool nullable_array, bool find_null) const
+{
+    cond c;
+    if (end == npos)
+        end = nullable_array ? m_size - 1 : m_size;
+
+    if (m_encoding == encoding_RunLength) {
+        // Element 0 of a nullable array is the null value
+        size_t first = nullable_array ? 1 : 0;
+        int64_t null_value = nullable_array ? get(0) : 0;
+        auto visit_run = [&](int64_t v, size_t run_begin, size_t run_end) {
+            bool is_null = nullable_array && v == null_value;
+            if (nullable_array ? !c(v, value, is_null, find_null) : !c(v, value))
+                return true;
+            if (action == act_Count) {
+                REALM_ASSERT_DEBUG(state->m_match_count < state->m_limit);
+                size_t process = std::min(run_end - run_begin, state->m_limit - state->m_match_count);
+                state->m_state += process;
+                state->m_match_count = size_t(state->m_state);
+                return state->m_limit > state->m_match_count;
+            }
+            util::Optional<int64_t> v2(is_null ? util::none : util::make_optional(v));
+            for (size_t i = run_begin; i < run_end; ++i) {
+                bool cont = nullable_array ? find_action<action, Callback>(i - first + baseindex, v2, state, callback)
+                                           : find_action<action, Callback>(i + baseindex, v, state, callback);
+                if (!cont)
+                    return false; // tell caller to stop aggregating/search
+            }
+            return true;
+        };
+        return for_each_run(start + first, end + first, visit_run);
+    }
+
+    if (m_encoding == encoding_Ranges && !nullable_array) {
+        auto visit_run = [&](int64_t v, size_t run_begin, size_t run_end) {
+            for (size_t i = run_begin; i < run_end; ++i, ++v) {
+                if (c(v, value) && !find_action<action, Callback>(i + baseindex, v, state, callback))
+                    return false; // tell caller to stop aggregating/search
+            }
+            return true;
+        };
+        return for_each_run(start, end, visit_run);
+    }
+
+    if (m_encoding == encoding_NullBitmap) {
+        // Element 0 of a nullable array is the null value, which is always the flagged value
+        size_t first = nullable_array ? 1 : 0;
+        int64_t flagged = get_flagged_value(m_data);
+        bool flagged_match = nullable_array ? c(flagged, value, true, find_null) : c(flagged, value);
+        if (!find_null && !flagged_match) {
+            Array offsets(m_alloc);
+            init_offsets_view(offsets);
+            auto match = [&](size_t i) {
+                if (is_flagged(m_data, i))
+                    return true;
+                int64_t v = m_base + offsets.get<bitwidth>(i);
+                if (nullable_array)
+                    return find_action<action, Callback>(i - first + baseindex, util::make_optional(v), state,
+                                                         callback);
+                return find_action<action, Callback>(i + baseindex, v, state, callback);
+            };
+            QueryState<int64_t> offsets_state;
+            offsets_state.init(act_CallbackIdx, nullptr, size_t(-1));
+            return offsets.find_optimized<cond, act_CallbackIdx, bitwidth>(to_offset(value), start + first,
+                                                                           end + first, 0, &offsets_state, match);
+        }
+        if (find_null && !c(0, 0, false, true)) {
+            // Only nulls can match
+            for (size_t i = start + first; i < end + first; ++i) {
+                if (is_flagged(m_data, i)) {
+                    if (!find_action<action, Callback>(i - first + baseindex, util::none, state, callback))
+                        return false; // tell caller to stop aggregating/search
+                }
+            }
+            return true;
+        }
+    }
+
+    bool index_only = action == act_ReturnFirst || action == act_Count || action == act_FindAll ||
+                      action == act_CallbackIdx;
+    if (m_encoding == encoding_FrameOfReference && index_only && !nullable_array) {
+        Array offsets(m_alloc);
+        init_offsets_view(offsets);
+        return offsets.find_optimized<cond, action, bitwidth, Callback>(to_offset(value), start, end, baseindex,
+                                                                        state, callback);
+    }
+
+    if (nullable_array) {
+        int64_t null_value = get(0);
+        for (; start < end; ++start) {
+            int64_t v = get(start + 1);
+            if (c(v, value, v == null_value, find_null)) {
+                util::Optional<int64_t> v2(v == null_value ? util::none : util::make_optional(v));
+                if (!find_action<action, Callback>(start + baseindex, v2, state, callback))
+                    return false; // tell caller to stop aggregating/search
+            }
+        }
+        return true;
+    }
+
+    for (; start < end; ++start) {
+        int64_t v = get(start);
+        if (c(v, value)) {
+            if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                return false; // tell caller to stop aggregating/search
+        }
+    }
+    return true;
+}
+
+// Calls fn(value, begin, end) for each run of a run-length encoded array that
+// overlaps [start, end), with begin and end clamped to that range. Stops, and
+// returns false, as soon as fn() returns false. For an array encoded as
+// ranges, `value` is that of the element at `begin`, and the next elements of
+// the run follow it by one.
+template <class F>
+bool Array::for_each_run(size_t start, size_t end, F fn) const
+{
+    REALM_ASSERT_DEBUG(m_encoding == encoding_RunLength || m_encoding == encoding_Ranges);
+    REALM_ASSERT_DEBUG(end <= m_size);
+    if (start >= end)
+        return true;
+
+    bool ranges = m_encoding == encoding_Ranges;
+    const char* values = get_run_values(m_data);
+    size_t run_ndx = find_run(m_data, start);
+    size_t run_begin = ranges && run_ndx != 0 ? get_run_end(m_data, run_ndx - 1) : 0;
+    while (start < end) {
+        size_t run_end = get_run_end(m_data, run_ndx);
+        int64_t value = get_direct(values, m_width, run_ndx);
+        if (ranges)
+            value += int64_t(start - run_begin);
+        size_t stop = std::min(run_end, end);
+        if (!fn(value, start, stop))
+            return false;
+        run_begin = run_end;
+        start = stop;
+        ++run_ndx;
+    }
+    return true;
+}
+
 #ifdef REALM_COMPILER_SSE
 // 'items' is the number of 16-byte SSE chunks. Returns index of packed element relative to first integer of first
 // chunk
@@ -2843,6 +3200,181 @@ REALM_FORCEINLINE bool Array::find_sse_intern(__m128i* action_data, __m128i* dat
 }
 #endif // REALM_COMPILER_SSE
 
+template <Action action, size_t width, class Callback>
+REALM_FORCEINLINE bool Array::find_action_mask(uint64_t mask, const char* chunk_data, size_t index,
+                                               QueryState<int64_t>* state, Callback callback) const
+{
+    if (mask == 0)
+        return true;
+
+    // The pattern has one bit set per match, which is all act_Count needs to consume the whole chunk at once
+    if (find_action_pattern<action, Callback>(index, mask, state, callback))
+        return true;
+
+    while (mask != 0) {
+        size_t i = first_set_bit64(mask);
+        if (!find_action<action, Callback>(index + i, get_universal<width>(chunk_data, i), state, callback))
+            return false;
+        mask &= mask - 1;
+    }
+    return true;
+}
+
+#ifdef REALM_COMPILER_AVX2
+// Searches elements [start, end) using 'vector_size' byte chunks. The kernels need the chunks to be aligned, so the
+// elements before the first and after the last aligned chunk are searched using compare().
+template <class cond, Action action, size_t width, class Callback, size_t vector_size>
+bool Array::find_avx(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                     Callback callback) const
+{
+    char* const a = static_cast<char*>(round_up(m_data + start * width / 8, vector_size));
+    char* const b = static_cast<char*>(round_down(m_data + end * width / 8, vector_size));
+    size_t a_ndx = (a - m_data) * 8 / no0(width);
+    size_t b_ndx = (b - m_data) * 8 / no0(width);
+
+    if (b <= a)
+        return compare<cond, action, width, Callback>(value, start, end, baseindex, state, callback);
+
+    if (!compare<cond, action, width, Callback>(value, start, a_ndx, baseindex, state, callback))
+        return false;
+
+    size_t items = (b - a) / vector_size;
+    if (vector_size == 64) {
+        if (!find_avx512<cond, action, width, Callback>(value, a, items, state, baseindex + a_ndx, callback))
+            return false;
+    }
+    else {
+        if (!find_avx2<cond, action, width, Callback>(value, a, items, state, baseindex + a_ndx, callback))
+            return false;
+    }
+
+    return compare<cond, action, width, Callback>(value, b_ndx, end, baseindex, state, callback);
+}
+
+// 'items' is the number of 32-byte chunks starting at the 32-byte aligned 'data'. 'baseindex' is the row index of
+// the first element of the first chunk.
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX2 bool Array::find_avx2(int64_t value, const char* data, size_t items, QueryState<int64_t>* state,
+                                        size_t baseindex, Callback callback) const
+{
+    const size_t elements = 256 / no0(width);
+    const uint64_t all = elements == 64 ? ~0ULL : (1ULL << elements) - 1;
+
+    __m256i search;
+    if (width == 8)
+        search = _mm256_set1_epi8(static_cast<char>(value));
+    else if (width == 16)
+        search = _mm256_set1_epi16(static_cast<short int>(value));
+    else if (width == 32)
+        search = _mm256_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm256_set1_epi64x(value);
+
+    for (size_t i = 0; i < items; ++i) {
+        const char* chunk = data + i * sizeof(__m256i);
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(chunk));
+        __m256i lhs = v;
+        __m256i rhs = search;
+        // Less is Greater with swapped operands
+        if (std::is_same<cond, Less>::value) {
+            lhs = search;
+            rhs = v;
+        }
+
+        __m256i compare_result;
+        if (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value) {
+            if (width == 8)
+                compare_result = _mm256_cmpeq_epi8(lhs, rhs);
+            else if (width == 16)
+                compare_result = _mm256_cmpeq_epi16(lhs, rhs);
+            else if (width == 32)
+                compare_result = _mm256_cmpeq_epi32(lhs, rhs);
+            else
+                compare_result = _mm256_cmpeq_epi64(lhs, rhs);
+        }
+        else {
+            if (width == 8)
+                compare_result = _mm256_cmpgt_epi8(lhs, rhs);
+            else if (width == 16)
+                compare_result = _mm256_cmpgt_epi16(lhs, rhs);
+            else if (width == 32)
+                compare_result = _mm256_cmpgt_epi32(lhs, rhs);
+            else
+                compare_result = _mm256_cmpgt_epi64(lhs, rhs);
+        }
+
+        // Reduce the compare result to one bit per element
+        uint64_t mask;
+        if (width == 8) {
+            mask = uint32_t(_mm256_movemask_epi8(compare_result));
+        }
+        else if (width == 16) {
+            // Both bits of a matching element are set in the byte mask; keep every other bit and squeeze them
+            uint64_t m = uint32_t(_mm256_movemask_epi8(compare_result)) & 0x55555555ULL;
+            m = (m | (m >> 1)) & 0x33333333ULL;
+            m = (m | (m >> 2)) & 0x0f0f0f0fULL;
+            m = (m | (m >> 4)) & 0x00ff00ffULL;
+            mask = (m | (m >> 8)) & 0x0000ffffULL;
+        }
+        else if (width == 32) {
+            mask = uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(compare_result)));
+        }
+        else {
+            mask = uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(compare_result)));
+        }
+
+        if (std::is_same<cond, NotEqual>::value)
+            mask = ~mask & all;
+
+        if (!find_action_mask<action, width, Callback>(mask, chunk, baseindex + i * elements, state, callback))
+            return false;
+    }
+
+    return true;
+}
+
+// Like find_avx2(), but with 64-byte chunks. AVX-512 compares produce one mask bit per element directly.
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX512 bool Array::find_avx512(int64_t value, const char* data, size_t items,
+                                            QueryState<int64_t>* state, size_t baseindex, Callback callback) const
+{
+    const size_t elements = 512 / no0(width);
+    const int predicate = std::is_same<cond, Equal>::value ? _MM_CMPINT_EQ
+                        : std::is_same<cond, NotEqual>::value ? _MM_CMPINT_NE
+                        : std::is_same<cond, Less>::value ? _MM_CMPINT_LT : _MM_CMPINT_NLE;
+
+    __m512i search;
+    if (width == 8)
+        search = _mm512_set1_epi8(static_cast<char>(value));
+    else if (width == 16)
+        search = _mm512_set1_epi16(static_cast<short int>(value));
+    else if (width == 32)
+        search = _mm512_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm512_set1_epi64(value);
+
+    for (size_t i = 0; i < items; ++i) {
+        const char* chunk = data + i * sizeof(__m512i);
+        __m512i v = _mm512_load_si512(chunk);
+
+        uint64_t mask;
+        if (width == 8)
+            mask = _mm512_cmp_epi8_mask(v, search, predicate);
+        else if (width == 16)
+            mask = _mm512_cmp_epi16_mask(v, search, predicate);
+        else if (width == 32)
+            mask = _mm512_cmp_epi32_mask(v, search, predicate);
+        else
+            mask = _mm512_cmp_epi64_mask(v, search, predicate);
+
+        if (!find_action_mask<action, width, Callback>(mask, chunk, baseindex + i * elements, state, callback))
+            return false;
+    }
+
+    return true;
+}
+#endif // REALM_COMPILER_AVX2
+
 template <class cond, Action action, class Callback>
 bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t baseindex,
                           QueryState<int64_t>* state, Callback callback) const
@@ -2886,6 +3418,17 @@ bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t
         return true;
     }
 
+    if (REALM_UNLIKELY(m_encoding != encoding_None || foreign->m_encoding != encoding_None)) {
+        // The width specific versions below read the packed values directly
+        for (; start < end; ++start) {
+            v = get(start);
+            if (c(v, foreign->get(start)))
+                if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                    return false;
+        }
+        return true;
+    }
+
     bool r;
     REALM_TEMPEX4(r = compare_leafs, cond, action, m_width, Callback,
                   (foreign, start, end, baseindex, state, callback))
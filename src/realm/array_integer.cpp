@@ -16,6 +16,7 @@
  *
  **************************************************************************/
 
+#include <limits>
 #include <vector>
 
 #include <realm/array_integer.hpp>
@@ -192,6 +193,21 @@ void ArrayIntNull::replace_nulls_with(int64_t new_null)
 
 void ArrayIntNull::avoid_null_collision(int64_t value)
 {
+    decode(); // Throws
+
+    if (m_width < 64 && null_value() != m_ubound) {
+        // The array was decoded (see Array::do_decode()) to a greater width
+        // than the one it was encoded from, so the upper bound no longer
+        // represents null. Restore that, or switch to a random null if the
+        // upper bound is taken.
+        if (can_use_as_null(m_ubound)) {
+            replace_nulls_with(m_ubound); // Throws
+        }
+        else {
+            Array::ensure_minimum_width(std::numeric_limits<int64_t>::max()); // Throws
+        }
+    }
+
     if (m_width == 64) {
         if (value == null_value()) {
             int_fast64_t new_null = choose_random_null(value);
@@ -75,6 +75,10 @@ private:
     bool minmax(size_t from, size_t to, uint64_t maxdiff, int64_t* min, int64_t* max) const;
 };
 
+// Element 0 holds the value that represents null. Committed leaves may be
+// stored in null bitmap encoded form (see "Encoded arrays" in array.cpp), where
+// the nulls are kept in a bitmap and the other elements only take up the width
+// they need themselves.
 class ArrayIntNull : public Array {
 public:
     using value_type = util::Optional<int64_t>;
@@ -480,7 +484,7 @@ inline bool ArrayIntNull::minmax_helper(int64_t& result, size_t start, size_t en
         return false;
     }
 
-    if (m_width == 0) {
+    if (m_width == 0 && !is_encoded()) {
         if (return_ndx)
             *return_ndx = best_index - 1;
         result = 0;
@@ -285,6 +285,7 @@ public:
     void set(size_t, T value);
     void set_null(size_t);
     void insert(size_t ndx, T value, size_t num_rows = 1);
+    void add(const T* values, size_t num_values);
     void erase(size_t ndx, bool is_last = false);
     void move_last_over(size_t ndx, size_t last_row_ndx);
     void clear();
@@ -313,6 +314,8 @@ public:
     void adjust(T diff);
     void adjust_ge(T limit, T diff);
 
+    void encode_leaves();
+
     ref_type write(size_t slice_offset, size_t slice_size, size_t table_size, _impl::OutputStream& out) const;
 
 #if defined(REALM_DEBUG)
@@ -335,6 +338,7 @@ private:
     struct SliceHandler;
     struct AdjustHandler;
     struct AdjustGEHandler;
+    struct EncodeHandler;
 
     struct LeafValueInserter;
     struct LeafNullInserter;
@@ -893,6 +897,62 @@ void BpTree<T>::insert(size_t row_ndx, T value, size_t num_rows)
     bptree_insert(row_ndx, inserter, num_rows);                            // Throws
 }
 
+// Appends to the last leaf as many values as it has room for at a time, so
+// that the path to it is only followed once per leaf rather than once per
+// value.
+template <class T>
+void BpTree<T>::add(const T* values, size_t num_values)
+{
+    while (num_values > 0) {
+        size_t n;
+        if (root_is_leaf()) {
+            LeafType& leaf = root_as_leaf();
+            n = std::min(num_values, REALM_MAX_BPNODE_SIZE - leaf.size());
+            for (size_t i = 0; i < n; ++i)
+                leaf.add(values[i]); // Throws
+        }
+        else {
+            // The inner nodes on the path are kept, as the number of elements
+            // of each must be updated afterwards
+            Allocator& alloc = get_alloc();
+            std::vector<std::unique_ptr<BpTreeNode>> path;
+            BpTreeNode* node = &root_as_node();
+            for (;;) {
+                size_t child_ref_ndx = node->size() - 2;
+                ref_type child_ref = node->get_as_ref(child_ref_ndx);
+                char* child_header = alloc.translate(child_ref);
+                if (!Array::get_is_inner_bptree_node_from_header(child_header))
+                    break;
+                path.emplace_back(new BpTreeNode(alloc)); // Throws
+                path.back()->init_from_mem(MemRef(child_header, child_ref, alloc));
+                path.back()->set_parent(node, child_ref_ndx);
+                node = path.back().get();
+            }
+            LeafType leaf(alloc);
+            size_t leaf_ref_ndx = node->size() - 2;
+            leaf.init_from_ref(node->get_as_ref(leaf_ref_ndx));
+            leaf.set_parent(node, leaf_ref_ndx);
+            n = std::min(num_values, REALM_MAX_BPNODE_SIZE - leaf.size());
+            for (size_t i = 0; i < n; ++i)
+                leaf.add(values[i]); // Throws
+
+            // +2 per element because stored value is 1 + 2*total_elems_in_subtree
+            BpTreeNode& root = root_as_node();
+            root.adjust(root.size() - 1, int_fast64_t(2 * n)); // Throws
+            for (auto& inner_node : path)
+                inner_node->adjust(inner_node->size() - 1, int_fast64_t(2 * n)); // Throws
+        }
+
+        if (n == 0) {
+            // The last leaf is full, so a new one is needed
+            insert(npos, values[0]); // Throws
+            n = 1;
+        }
+        values += n;
+        num_values -= n;
+    }
+}
+
 template <class T>
 struct BpTree<T>::UpdateHandler : BpTreeNode::UpdateHandler {
     LeafType m_leaf;
@@ -1103,6 +1163,34 @@ struct BpTree<T>::AdjustGEHandler : BpTreeNode::UpdateHandler {
     }
 };
 
+template <class T>
+struct BpTree<T>::EncodeHandler : BpTreeNode::UpdateHandler {
+    LeafType m_leaf;
+
+    EncodeHandler(BpTreeBase& tree)
+        : m_leaf(tree.get_alloc())
+    {
+    }
+
+    void update(MemRef mem, ArrayParent* parent, size_t ndx_in_parent, size_t) final
+    {
+        m_leaf.init_from_mem(mem);
+        m_leaf.set_parent(parent, ndx_in_parent);
+        m_leaf.encode(); // Throws
+    }
+};
+
+// Like when a tree is written to the file, only leaves that are children of
+// an inner node are encoded
+template <class T>
+void BpTree<T>::encode_leaves()
+{
+    if (root_is_leaf())
+        return;
+    EncodeHandler handler(*this);
+    root_as_node().update_bptree_leaves(handler); // Throws
+}
+
 template <class T>
 void BpTree<T>::adjust_ge(T limit, T diff)
 {
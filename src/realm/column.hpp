@@ -23,6 +23,7 @@
 #include <cstdlib> // size_t
 #include <vector>
 #include <memory>
+#include <atomic>
 
 #include <realm/array_integer.hpp>
 #include <realm/column_type.hpp>
@@ -540,7 +541,7 @@ public:
     REALM_DEPRECATED("Initialize with ref instead") explicit Column(std::unique_ptr<Array> root) noexcept;
     Column(Allocator&, ref_type, size_t column_ndx = npos);
     Column(unattached_root_tag, Allocator&);
-    Column(Column&&) noexcept = default;
+    Column(Column&&) noexcept;
     ~Column() noexcept override;
 
     void init_from_parent();
@@ -590,6 +591,25 @@ public:
     /// and never directly through the specfied fallback accessor.
     void get_leaf(size_t ndx, size_t& ndx_in_leaf, LeafInfo& inout_leaf) const noexcept;
 
+    /// Get the smallest and the largest value stored in a leaf obtained
+    /// through get_leaf(). This allows searches to skip leaves that cannot
+    /// contain a match.
+    ///
+    /// Leaves that are stored in an encoded form (file format 11) record
+    /// their bounds (see Array::get_encoded_bounds()). For other leaves,
+    /// bounds are only tracked if they are part of a committed snapshot,
+    /// since those cannot change until this accessor is refreshed. As
+    /// computing them costs a pass over the leaf, they are computed the
+    /// second time a leaf is asked for, so that one-off scans do not pay for
+    /// them. Returns false if no bounds are available.
+    ///
+    /// The inner nodes of the B+-tree hold no summary of the bounds of
+    /// their children, so a search still visits every leaf, and only saves
+    /// the scan of the leaves it can rule out.
+    ///
+    /// Only available for integer columns without nulls.
+    bool get_leaf_bounds(const LeafType& leaf, int64_t& min, int64_t& max) const;
+
     // Getting and setting values
     T get(size_t ndx) const noexcept;
     bool is_null(size_t ndx) const noexcept override;
@@ -597,6 +617,8 @@ public:
     void set(size_t, T value);
     void set_null(size_t) override;
     void add(T value = T{});
+    /// Same as calling add() for each of the values, but faster.
+    void add(const T* values, size_t num_values);
     void insert(size_t ndx, T value = T{}, size_t num_rows = 1);
     void erase(size_t row_ndx);
     void erase(size_t row_ndx, bool is_last);
@@ -621,6 +643,12 @@ public:
     template <class U>
     void adjust_ge(T limit, U diff);
 
+    /// Store the leaves in encoded form where that takes up less space (see
+    /// Array::encode()). This is for columns that are not part of a table,
+    /// like the row indexes of a view, as the leaves of table columns are
+    /// encoded when they are written to the file.
+    void encode_leaves();
+
     size_t count(T target) const;
 
     typename ColumnTypeTraits<T>::sum_type sum(size_t start = 0, size_t end = npos, size_t limit = npos,
@@ -762,6 +790,33 @@ private:
 
     BpTree<T> m_tree;
 
+    // A direct-mapped cache of leaf bounds, keyed by leaf ref, which the threads of a query (see
+    // Query::set_threads()) share without locking. Each slot has a sequence number which is odd while the slot is
+    // being written. A reader that sees the number change, and a writer that finds the slot busy, go without bounds.
+    class LeafBoundsCache {
+    public:
+        explicit LeafBoundsCache(size_t num_leaves);
+        bool get(const LeafType& leaf, int64_t& min, int64_t& max) noexcept;
+
+    private:
+        struct Slot {
+            std::atomic<uint_fast64_t> seq;
+            std::atomic<ref_type> ref;
+            std::atomic<int64_t> min;
+            std::atomic<int64_t> max; // Less than `min` until the bounds are computed
+        };
+        size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+
+        static void store(Slot&, uint_fast64_t seq, ref_type, int64_t min, int64_t max) noexcept;
+    };
+
+    // Created by the first search that asks for bounds. Must be cleared whenever the accessor is refreshed, as refs
+    // of freed leaves may be reused.
+    mutable std::atomic<LeafBoundsCache*> m_leaf_bounds{nullptr};
+
+    void clear_leaf_bounds() noexcept;
+
     void do_erase(size_t row_ndx, size_t num_rows_to_erase, bool is_last);
 };
 
@@ -951,6 +1006,12 @@ void Column<T>::adjust_ge(T limit, U diff)
     m_tree.adjust_ge(limit, diff);
 }
 
+template <class T>
+void Column<T>::encode_leaves()
+{
+    m_tree.encode_leaves();
+}
+
 template <class T>
 size_t Column<T>::count(T target) const
 {
@@ -1007,6 +1068,89 @@ void Column<T>::get_leaf(size_t ndx, size_t& ndx_in_leaf, LeafInfo& inout_leaf_i
     m_tree.get_leaf(ndx, ndx_in_leaf, inout_leaf_info);
 }
 
+template <class T>
+bool Column<T>::get_leaf_bounds(const LeafType& leaf, int64_t& min, int64_t& max) const
+{
+    static_assert(std::is_same<T, int64_t>::value, "Leaf bounds are only tracked for integer columns without nulls");
+
+    // Encoded leaves record their bounds, and are never modified in place
+    if (leaf.get_encoded_bounds(min, max))
+        return true;
+
+    ref_type ref = leaf.get_ref();
+    if (!get_alloc().is_read_only(ref) || leaf.is_empty())
+        return false;
+
+    LeafBoundsCache* cache = m_leaf_bounds.load(std::memory_order_acquire);
+    if (!cache) {
+        std::unique_ptr<LeafBoundsCache> new_cache(new LeafBoundsCache(size() / REALM_MAX_BPNODE_SIZE + 1)); // Throws
+        if (m_leaf_bounds.compare_exchange_strong(cache, new_cache.get(), std::memory_order_acq_rel))
+            cache = new_cache.release();
+    }
+    return cache->get(leaf, min, max);
+}
+
+template <class T>
+Column<T>::LeafBoundsCache::LeafBoundsCache(size_t num_leaves)
+{
+    // Twice as many slots as leaves keeps collisions rare
+    size_t num_slots = 64;
+    while (num_slots < 2 * num_leaves && num_slots < 65536)
+        num_slots *= 2;
+    m_mask = num_slots - 1;
+    m_slots.reset(new Slot[num_slots]()); // Throws
+}
+
+template <class T>
+bool Column<T>::LeafBoundsCache::get(const LeafType& leaf, int64_t& min, int64_t& max) noexcept
+{
+    ref_type ref = leaf.get_ref();
+    Slot& slot = m_slots[(ref / 8) & m_mask];
+    uint_fast64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq % 2 != 0)
+        return false;
+    ref_type slot_ref = slot.ref.load(std::memory_order_relaxed);
+    int64_t slot_min = slot.min.load(std::memory_order_relaxed);
+    int64_t slot_max = slot.max.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq)
+        return false;
+
+    if (slot_ref != ref) {
+        // First visit, or the slot was taken by another leaf
+        store(slot, seq, ref, 1, 0);
+        return false;
+    }
+    if (slot_min > slot_max) {
+        // Second visit
+        leaf.minimum(slot_min);
+        leaf.maximum(slot_max);
+        store(slot, seq, ref, slot_min, slot_max);
+    }
+    min = slot_min;
+    max = slot_max;
+    return true;
+}
+
+template <class T>
+void Column<T>::LeafBoundsCache::store(Slot& slot, uint_fast64_t seq, ref_type ref, int64_t min,
+                                       int64_t max) noexcept
+{
+    if (!slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+        return; // Another thread got there first
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ref.store(ref, std::memory_order_relaxed);
+    slot.min.store(min, std::memory_order_relaxed);
+    slot.max.store(max, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+template <class T>
+void Column<T>::clear_leaf_bounds() noexcept
+{
+    delete m_leaf_bounds.exchange(nullptr, std::memory_order_relaxed);
+}
+
 template <class T>
 StringData Column<T>::get_index_data(size_t ndx, StringIndex::StringConversionBuffer& buffer) const noexcept
 {
@@ -1146,26 +1290,38 @@ Column<T>::Column(std::unique_ptr<Array> root) noexcept
 {
 }
 
+template <class T>
+Column<T>::Column(Column<T>&& col) noexcept
+    : ColumnBaseWithIndex(std::move(col))
+    , m_tree(std::move(col.m_tree))
+    , m_leaf_bounds(col.m_leaf_bounds.exchange(nullptr, std::memory_order_relaxed))
+{
+}
+
 template <class T>
 Column<T>::~Column() noexcept
 {
+    clear_leaf_bounds();
 }
 
 template <class T>
 void Column<T>::init_from_parent()
 {
+    clear_leaf_bounds();
     m_tree.init_from_parent();
 }
 
 template <class T>
 void Column<T>::init_from_ref(Allocator& alloc, ref_type ref)
 {
+    clear_leaf_bounds();
     m_tree.init_from_ref(alloc, ref);
 }
 
 template <class T>
 void Column<T>::init_from_mem(Allocator& alloc, MemRef mem)
 {
+    clear_leaf_bounds();
     m_tree.init_from_mem(alloc, mem);
 }
 
@@ -1181,6 +1337,8 @@ void Column<T>::move_assign(Column<T>& col)
 {
     ColumnBaseWithIndex::move_assign(col);
     m_tree = std::move(col.m_tree);
+    clear_leaf_bounds();
+    m_leaf_bounds.store(col.m_leaf_bounds.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 template <class T>
@@ -1237,6 +1395,7 @@ void Column<T>::update_from_parent(size_t old_baseline) noexcept
 {
     ColumnBaseWithIndex::update_from_parent(old_baseline);
     m_tree.update_from_parent(old_baseline);
+    clear_leaf_bounds();
 }
 
 template <class T>
@@ -1294,6 +1453,17 @@ void Column<T>::add(T value)
     insert(npos, std::move(value));
 }
 
+template <class T>
+void Column<T>::add(const T* values, size_t num_values)
+{
+    if (has_search_index()) {
+        for (size_t i = 0; i < num_values; ++i)
+            add(values[i]); // Throws
+        return;
+    }
+    m_tree.add(values, num_values); // Throws
+}
+
 template <class T>
 void Column<T>::insert_without_updating_index(size_t row_ndx, T value, size_t num_rows)
 {
@@ -1597,6 +1767,7 @@ ref_type Column<T>::write(size_t slice_offset, size_t slice_size, size_t table_s
 template <class T>
 void Column<T>::refresh_accessor_tree(size_t new_col_ndx, const Spec& spec)
 {
+    clear_leaf_bounds();
     m_tree.init_from_parent();
     ColumnBaseWithIndex::refresh_accessor_tree(new_col_ndx, spec);
 }
@@ -0,0 +1,206 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/column_statistics.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <realm/column.hpp>
+#include <realm/impl/destroy_guard.hpp>
+
+using namespace realm;
+
+namespace {
+
+// Layout of the array written by ColumnStatistics::write(). The histogram boundaries follow the fixed fields.
+enum {
+    s_row_count_ndx = 0,
+    s_null_count_ndx = 1,
+    s_distinct_count_ndx = 2,
+    s_modified_count_ndx = 3,
+    s_histogram_ndx = 4,
+};
+
+uint64_t mix(uint64_t v) noexcept
+{
+    // The finalizer of SplitMix64
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebULL;
+    return v ^ (v >> 31);
+}
+
+template <class ColType>
+ColumnStatistics compute_statistics(const ColType& column)
+{
+    ColumnStatistics stats;
+    size_t row_count = column.size();
+    stats.row_count = row_count;
+    if (row_count == 0)
+        return stats;
+
+    // Take one row from each of `sample_size` equally sized strata, at a pseudo-random position within it, so that
+    // periodic data does not skew the sample. All rows are taken when there are few enough.
+    size_t sample_size = std::min(row_count, ColumnStatistics::max_sample_size);
+    std::vector<int64_t> values;
+    values.reserve(sample_size); // Throws
+    size_t num_nulls = 0;
+    for (size_t i = 0; i < sample_size; ++i) {
+        size_t begin = size_t(uint64_t(i) * row_count / sample_size);
+        size_t end = size_t(uint64_t(i + 1) * row_count / sample_size);
+        size_t row_ndx = begin + size_t(mix(i) % (end - begin));
+        util::Optional<int64_t> value = column.get(row_ndx);
+        if (value)
+            values.push_back(*value);
+        else
+            ++num_nulls;
+    }
+    stats.null_count = size_t(double(num_nulls) * row_count / sample_size + 0.5);
+    if (values.empty())
+        return stats;
+
+    std::sort(values.begin(), values.end());
+
+    // The number of distinct values is estimated with the GEE estimator (Charikar et al., "Towards estimation error
+    // guarantees for distinct values"), which scales up the number of values that occur only once in the sample.
+    size_t num_distinct = 0;
+    size_t num_singletons = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i + 1;
+        while (j < values.size() && values[j] == values[i])
+            ++j;
+        ++num_distinct;
+        if (j - i == 1)
+            ++num_singletons;
+        i = j;
+    }
+    double scale = std::sqrt(double(row_count) / double(sample_size));
+    double estimate = scale * double(num_singletons) + double(num_distinct - num_singletons);
+    size_t max_distinct = std::max(row_count - std::min(stats.null_count, row_count), num_distinct);
+    stats.distinct_count = std::max(num_distinct, std::min(size_t(estimate + 0.5), max_distinct));
+
+    size_t num_buckets = std::min(ColumnStatistics::max_buckets, values.size());
+    stats.histogram.reserve(num_buckets + 1); // Throws
+    for (size_t i = 0; i <= num_buckets; ++i)
+        stats.histogram.push_back(values[i * (values.size() - 1) / num_buckets]);
+
+    return stats;
+}
+
+size_t count_modified_rows(Allocator& alloc, ref_type ref) noexcept
+{
+    // Everything below a node in read-only memory is unmodified
+    if (alloc.is_read_only(ref))
+        return 0;
+
+    const char* header = alloc.translate(ref);
+    if (!Array::get_is_inner_bptree_node_from_header(header))
+        return Array::get_size_from_header(header);
+
+    // The first element is the offsets, and the last one is the total number of elements (see "Inner node of
+    // B+-tree" in array.cpp)
+    Array node(alloc);
+    node.init_from_mem(MemRef(const_cast<char*>(header), ref, alloc));
+    size_t num_rows = 0;
+    size_t end = node.size() - 1;
+    for (size_t i = 1; i < end; ++i)
+        num_rows += count_modified_rows(alloc, node.get_as_ref(i));
+    return num_rows;
+}
+
+} // anonymous namespace
+
+
+const size_t ColumnStatistics::max_sample_size;
+const size_t ColumnStatistics::max_buckets;
+const size_t ColumnStatistics::resample_ratio;
+
+ColumnStatistics ColumnStatistics::compute(const IntegerColumn& column)
+{
+    return compute_statistics(column); // Throws
+}
+
+ColumnStatistics ColumnStatistics::compute(const IntNullColumn& column)
+{
+    return compute_statistics(column); // Throws
+}
+
+size_t ColumnStatistics::count_modified_rows(const ColumnBase& column) noexcept
+{
+    return ::count_modified_rows(column.get_alloc(), column.get_ref());
+}
+
+ref_type ColumnStatistics::write(Allocator& alloc) const
+{
+    Array array(alloc);
+    array.create(Array::type_Normal); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&array);
+    array.add(int64_t(row_count));      // Throws
+    array.add(int64_t(null_count));     // Throws
+    array.add(int64_t(distinct_count)); // Throws
+    array.add(int64_t(modified_count)); // Throws
+    for (int64_t boundary : histogram)
+        array.add(boundary); // Throws
+    dg.release();
+    return array.get_ref();
+}
+
+void ColumnStatistics::read(Allocator& alloc, ref_type ref)
+{
+    Array array(alloc);
+    array.init_from_ref(ref);
+    REALM_ASSERT(array.size() >= s_histogram_ndx);
+    row_count = size_t(array.get(s_row_count_ndx));
+    null_count = size_t(array.get(s_null_count_ndx));
+    distinct_count = size_t(array.get(s_distinct_count_ndx));
+    modified_count = size_t(array.get(s_modified_count_ndx));
+    size_t n = array.size();
+    histogram.clear();
+    histogram.reserve(n - s_histogram_ndx); // Throws
+    for (size_t i = s_histogram_ndx; i < n; ++i)
+        histogram.push_back(array.get(i));
+}
+
+double ColumnStatistics::fraction_equal(int64_t value) const noexcept
+{
+    if (histogram.empty() || value < histogram.front() || value > histogram.back())
+        return 0;
+
+    // A value that is a boundary of several buckets fills the buckets between them
+    auto range = std::equal_range(histogram.begin(), histogram.end(), value);
+    size_t num_repeats = size_t(range.second - range.first);
+    if (num_repeats > 1)
+        return double(num_repeats - 1) / double(histogram.size() - 1);
+
+    return 1 / double(std::max(distinct_count, size_t(1)));
+}
+
+double ColumnStatistics::fraction_at_most(int64_t value) const noexcept
+{
+    if (histogram.empty() || value < histogram.front())
+        return 0;
+    if (value >= histogram.back())
+        return 1;
+
+    // Find the bucket that `value` falls in, and assume that the values are evenly spread within it
+    size_t i = size_t(std::upper_bound(histogram.begin(), histogram.end(), value) - histogram.begin()) - 1;
+    double low = double(histogram[i]);
+    double high = double(histogram[i + 1]);
+    double within = (double(value) - low) / (high - low);
+    return (double(i) + within) / double(histogram.size() - 1);
+}
@@ -0,0 +1,180 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <realm/array.hpp>
+#include <realm/column_fwd.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/util/optional.hpp>
+
+namespace realm {
+
+/// Estimates of how the values of an integer column are distributed.
+///
+/// They are computed from a sample of the rows, and are stored with the table
+/// (see Table::get_column_statistics()). When a transaction that modified the
+/// column is committed, the modified rows are added up (see
+/// count_modified_rows()), and the statistics are only computed anew once
+/// they make up a large enough part of the column (see is_stale()). The query
+/// engine uses them to order the conditions of a query before it has measured
+/// anything itself. They never affect the results of a query.
+class ColumnStatistics {
+public:
+    /// Number of rows when the statistics were computed.
+    size_t row_count = 0;
+
+    /// Estimated number of nulls.
+    size_t null_count = 0;
+
+    /// Estimated number of distinct non-null values.
+    size_t distinct_count = 0;
+
+    /// Boundaries of an equi-depth histogram of the non-null values. Each of
+    /// the `histogram.size() - 1` buckets holds about the same number of
+    /// rows, so a value that is repeated as a boundary is a frequent one. The
+    /// first and the last boundary are the smallest and the largest sampled
+    /// value. Empty if no non-null values were sampled.
+    std::vector<int64_t> histogram;
+
+    /// Estimated number of rows that have been modified since the statistics
+    /// were computed.
+    size_t modified_count = 0;
+
+    /// The number of rows that are sampled, at most.
+    static const size_t max_sample_size = 1024;
+
+    /// The number of buckets in the histogram, at most.
+    static const size_t max_buckets = 16;
+
+    /// The statistics are computed anew once more than one in this many rows
+    /// have been modified.
+    static const size_t resample_ratio = 10;
+
+    bool has_values() const noexcept;
+    bool is_stale() const noexcept;
+    int64_t min() const noexcept;
+    int64_t max() const noexcept;
+
+    /// Estimated fraction of the rows that satisfy the condition for
+    /// `value`. None stands for null.
+    double estimate(Equal, util::Optional<int64_t> value) const noexcept;
+    double estimate(NotEqual, util::Optional<int64_t> value) const noexcept;
+    double estimate(Greater, util::Optional<int64_t> value) const noexcept;
+    double estimate(GreaterEqual, util::Optional<int64_t> value) const noexcept;
+    double estimate(Less, util::Optional<int64_t> value) const noexcept;
+    double estimate(LessEqual, util::Optional<int64_t> value) const noexcept;
+
+    static ColumnStatistics compute(const IntegerColumn&);
+    static ColumnStatistics compute(const IntNullColumn&);
+
+    /// Count the rows in the leaves of the specified column that are not in
+    /// read-only memory, that is, the leaves that were modified by the
+    /// current transaction. Only the modified inner nodes are visited.
+    static size_t count_modified_rows(const ColumnBase&) noexcept;
+
+    /// Store the statistics in a new array, and return its ref.
+    ref_type write(Allocator&) const;
+
+    /// Load statistics that were stored by write().
+    void read(Allocator&, ref_type);
+
+private:
+    double null_fraction() const noexcept;
+
+    // Fractions of the non-null values
+    double fraction_equal(int64_t value) const noexcept;
+    double fraction_at_most(int64_t value) const noexcept;
+    double fraction_less(int64_t value) const noexcept;
+};
+
+
+// Implementation:
+
+inline bool ColumnStatistics::has_values() const noexcept
+{
+    return !histogram.empty();
+}
+
+inline bool ColumnStatistics::is_stale() const noexcept
+{
+    return modified_count > row_count / resample_ratio;
+}
+
+inline int64_t ColumnStatistics::min() const noexcept
+{
+    REALM_ASSERT_DEBUG(has_values());
+    return histogram.front();
+}
+
+inline int64_t ColumnStatistics::max() const noexcept
+{
+    REALM_ASSERT_DEBUG(has_values());
+    return histogram.back();
+}
+
+inline double ColumnStatistics::null_fraction() const noexcept
+{
+    return row_count == 0 ? 0 : double(null_count) / double(row_count);
+}
+
+inline double ColumnStatistics::estimate(Equal, util::Optional<int64_t> value) const noexcept
+{
+    if (!value)
+        return null_fraction();
+    return (1 - null_fraction()) * fraction_equal(*value);
+}
+
+inline double ColumnStatistics::estimate(NotEqual, util::Optional<int64_t> value) const noexcept
+{
+    return 1 - estimate(Equal(), value);
+}
+
+inline double ColumnStatistics::estimate(Greater, util::Optional<int64_t> value) const noexcept
+{
+    return value ? (1 - null_fraction()) * (1 - fraction_at_most(*value)) : 0;
+}
+
+inline double ColumnStatistics::estimate(GreaterEqual, util::Optional<int64_t> value) const noexcept
+{
+    return value ? (1 - null_fraction()) * (1 - fraction_less(*value)) : 0;
+}
+
+inline double ColumnStatistics::estimate(Less, util::Optional<int64_t> value) const noexcept
+{
+    return value ? (1 - null_fraction()) * fraction_less(*value) : 0;
+}
+
+inline double ColumnStatistics::estimate(LessEqual, util::Optional<int64_t> value) const noexcept
+{
+    return value ? (1 - null_fraction()) * fraction_at_most(*value) : 0;
+}
+
+inline double ColumnStatistics::fraction_less(int64_t value) const noexcept
+{
+    return value == std::numeric_limits<int64_t>::min() ? 0 : fraction_at_most(value - 1);
+}
+
+} // namespace realm
+
+#endif // REALM_COLUMN_STATISTICS_HPP
@@ -61,7 +61,11 @@ enum ColumnAttr {
     col_attr_StrongLinks = 8,
 
     /// Specifies that elements in the column can be null.
-    col_attr_Nullable = 16
+    col_attr_Nullable = 16,
+
+    /// Specifies that a range index is kept for this column (see
+    /// Table::add_range_index()).
+    col_attr_RangeIndexed = 32
 };
 
 
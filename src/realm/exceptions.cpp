@@ -91,6 +91,8 @@ const char* LogicError::message() const noexcept
             return "Column does not exist";
         case subtable_of_subtable_index:
             return "Search index on a subtable of a subtable is not yet supported";
+        case file_format_too_old:
+            return "Not supported by the file format version of the file";
     }
     return "Unknown error";
 }
@@ -234,7 +234,11 @@ public:
         column_does_not_exist,
 
         /// You can not add index on a subtable of a subtable
-        subtable_of_subtable_index
+        subtable_of_subtable_index,
+
+        /// The operation needs a newer file format than the one that the file
+        /// is kept in, e.g. because it was opened without a history.
+        file_format_too_old
     };
 
     LogicError(ErrorKind message);
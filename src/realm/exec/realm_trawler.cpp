@@ -129,8 +129,14 @@ public:
     {
         return unsigned(m_size);
     }
+    bool is_encoded() const
+    {
+        return ((unsigned(m_header[4]) & 0x18) >> 3) == 3;
+    }
     unsigned length() const
     {
+        if (is_encoded())
+            return calc_encoded_byte_size(realm::Array::get_data_from_header(m_header), m_size, width());
         unsigned width_type = (unsigned(m_header[4]) & 0x18) >> 3;
         return calc_byte_size(width_type, m_size, width());
     }
@@ -170,6 +176,24 @@ protected:
         // Ensure 8-byte alignment
         return (num_bytes + 7) & ~size_t(7);
     }
+
+    // See "Encoded arrays" in array.cpp. The first byte of the data is the encoding.
+    static unsigned calc_encoded_byte_size(const char* data, unsigned size, unsigned width)
+    {
+        switch (data[0]) {
+            case 1: // Frame of reference
+                return 16 + calc_byte_size(0, size, width);
+            case 2:   // Run length
+            case 4: { // Ranges
+                unsigned num_runs;
+                memcpy(&num_runs, data + 4, 4);
+                return 8 + calc_byte_size(0, num_runs, unsigned(data[1])) + calc_byte_size(0, num_runs, width);
+            }
+            case 3: // Null bitmap
+                return 24 + calc_byte_size(0, size, 1) + calc_byte_size(0, size, width);
+        }
+        return 0;
+    }
 };
 
 class Array : public Node {
@@ -188,6 +212,10 @@ public:
     }
     int64_t get_val(size_t ndx) const
     {
+        // Encoded arrays never contain refs
+        if (is_encoded())
+            return realm::Array::get(m_header, ndx);
+
         int64_t val = realm::get_direct(m_data, width(), ndx);
 
         if (m_has_refs) {
@@ -484,6 +512,14 @@ void Node::init(realm::Allocator& alloc, uint64_t ref)
         unsigned char* u = reinterpret_cast<unsigned char*>(m_header);
         m_size = (u[5] << 16) + (u[6] << 8) + u[7];
         m_valid = true;
+        if (is_encoded()) {
+            int encoding = realm::Array::get_data_from_header(m_header)[0];
+            if (encoding < 1 || encoding > 4) {
+                std::cerr << "*** Unknown array encoding " << encoding << ": 0x" << std::hex << ref << std::dec
+                          << std::endl;
+                m_valid = false;
+            }
+        }
     }
 }
 
@@ -115,7 +115,16 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
     if (requested_history_type == Replication::hist_None && current_file_format_version == 8)
         return 8;
 
-    return 9;
+    if (requested_history_type == Replication::hist_None && current_file_format_version == 9)
+        return 9;
+
+    // A file that is opened without a history is not upgraded past version 9,
+    // so that older versions of the library can still open it.
+    if (requested_history_type == Replication::hist_None && current_file_format_version != 0 &&
+        current_file_format_version < 9)
+        return 9;
+
+    return 11;
 }
 
 
@@ -126,7 +135,8 @@ void Group::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 9, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 9 || target_file_format_version == 11,
+                    target_file_format_version);
 
     int current_file_format_version = get_file_format_version();
     REALM_ASSERT(current_file_format_version < target_file_format_version);
@@ -134,7 +144,7 @@ void Group::upgrade_file_format(int target_file_format_version)
     // SharedGroup::do_open() must ensure this. Be sure to revisit the
     // following upgrade logic when SharedGroup::do_open() is changed (or
     // vice versa).
-    REALM_ASSERT_EX(current_file_format_version >= 2 && current_file_format_version <= 8,
+    REALM_ASSERT_EX(current_file_format_version >= 2 && current_file_format_version <= 9,
                     current_file_format_version);
 
     // Upgrade from version prior to 5 (datetime -> timestamp)
@@ -167,6 +177,10 @@ void Group::upgrade_file_format(int target_file_format_version)
 
     // Upgrading to version 9 doesn't require changing anything.
 
+    // Upgrading to version 11 doesn't require changing anything either. The
+    // encoded leaves, column statistics and range indexes that it allows for
+    // are only added as tables are modified.
+
     // NOTE: Additional future upgrade steps go here.
 
     set_file_format_version(target_file_format_version);
@@ -182,7 +196,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
     bool file_format_ok = false;
     // In non-shared mode (Realm file opened via a Group instance) this version
     // of the core library is only able to open Realms using file format version
-    // 6, 7, 8 or 9. These versions can be read without an upgrade.
+    // 6, 7, 8, 9 or 11. These versions can be read without an upgrade.
     // Since a Realm file cannot be upgraded when opened in this mode
     // (we may be unable to write to the file), no earlier versions can be opened.
     // Please see Group::get_file_format_version() for information about the
@@ -195,6 +209,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
         case 7:
         case 8:
         case 9:
+        case 11:
             file_format_ok = true;
             break;
     }
@@ -380,6 +395,24 @@ void Group::update_num_objects()
 }
 
 
+void Group::update_derived_table_data()
+{
+    // Tables whose top array is in read-only memory have not been modified by the transaction
+    typedef _impl::TableFriend tf;
+    size_t num_tables = m_tables.size();
+    for (size_t i = 0; i < num_tables; ++i) {
+        if (m_alloc.is_read_only(m_tables.get_as_ref(i)))
+            continue;
+        TableRef table = get_table(i); // Throws
+        // The column statistics were introduced in file format 11. In files
+        // that are kept in an older format, the top array of a table must
+        // stay as older versions of the library expect it.
+        if (m_file_format_version >= 11)
+            tf::update_column_statistics(*table); // Throws
+    }
+}
+
+
 void Group::attach_shared(ref_type new_top_ref, size_t new_file_size, bool writable)
 {
     REALM_ASSERT_3(new_top_ref, <, new_file_size);
@@ -840,6 +873,7 @@ void Group::write(std::ostream& out, int file_format_version, TableWriter& table
         file_format_version = get_target_file_format_version_for_session(0, Replication::hist_None);
     }
     SlabAlloc::init_streaming_header(&streaming_header, file_format_version);
+    out_2.compress_leaves = file_format_version >= 11;
     out_2.write(reinterpret_cast<const char*>(&streaming_header), sizeof streaming_header);
 
     ref_type top_ref = 0;
@@ -954,6 +988,8 @@ void Group::commit()
     if (m_is_shared)
         throw LogicError(LogicError::wrong_group_state);
 
+    update_derived_table_data(); // Throws
+
     GroupWriter out(*this); // Throws
 
     // Recursively write all changed arrays to the database file. We
@@ -1307,6 +1343,9 @@ public:
         if (group_level_ndx < m_group.m_table_accessors.size()) {
             TableRef table(m_group.m_table_accessors[group_level_ndx]);
             if (table) {
+                // Changes to subtables are not recorded as changes to the rows of the table they are in
+                if (levels > 0)
+                    _impl::TableFriend::adj_views_discard_changes(*table);
                 const size_t* path_begin = path;
                 const size_t* path_end = path_begin + 2 * levels;
                 for (;;) {
@@ -1343,6 +1382,7 @@ public:
             else {
                 tf::adj_acc_insert_rows(*m_table, row_ndx, num_rows_to_insert);
             }
+            tf::adj_views_changed_rows(*m_table, row_ndx, num_rows_to_insert);
         }
         return true;
     }
@@ -1401,8 +1441,10 @@ public:
     bool merge_rows(size_t row_ndx, size_t new_row_ndx) noexcept
     {
         typedef _impl::TableFriend tf;
-        if (m_table)
+        if (m_table) {
             tf::adj_acc_merge_rows(*m_table, row_ndx, new_row_ndx);
+            tf::adj_views_discard_changes(*m_table);
+        }
         return true;
     }
 
@@ -1414,49 +1456,58 @@ public:
         return true;
     }
 
-    bool set_int(size_t, size_t, int_fast64_t, _impl::Instruction, size_t) noexcept
+    bool set_int(size_t, size_t row_ndx, int_fast64_t, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool add_int(size_t, size_t, int_fast64_t) noexcept
+    bool add_int(size_t, size_t row_ndx, int_fast64_t) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_bool(size_t, size_t, bool, _impl::Instruction) noexcept
+    bool set_bool(size_t, size_t row_ndx, bool, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_float(size_t, size_t, float, _impl::Instruction) noexcept
+    bool set_float(size_t, size_t row_ndx, float, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_double(size_t, size_t, double, _impl::Instruction) noexcept
+    bool set_double(size_t, size_t row_ndx, double, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_string(size_t, size_t, StringData, _impl::Instruction, size_t) noexcept
+    bool set_string(size_t, size_t row_ndx, StringData, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_binary(size_t, size_t, BinaryData, _impl::Instruction) noexcept
+    bool set_binary(size_t, size_t row_ndx, BinaryData, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_olddatetime(size_t, size_t, OldDateTime, _impl::Instruction) noexcept
+    bool set_olddatetime(size_t, size_t row_ndx, OldDateTime, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool set_timestamp(size_t, size_t, Timestamp, _impl::Instruction) noexcept
+    bool set_timestamp(size_t, size_t row_ndx, Timestamp, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
     bool set_table(size_t col_ndx, size_t row_ndx, _impl::Instruction) noexcept
@@ -1469,6 +1520,7 @@ public:
                 tf::adj_acc_clear_nonroot_table(*subtab);
             }
         }
+        changed_row(row_ndx);
         return true;
     }
 
@@ -1477,12 +1529,14 @@ public:
         typedef _impl::TableFriend tf;
         if (m_table)
             tf::discard_subtable_accessor(*m_table, col_ndx, row_ndx);
+        changed_row(row_ndx);
         return true;
     }
 
-    bool set_null(size_t, size_t, _impl::Instruction, size_t) noexcept
+    bool set_null(size_t, size_t row_ndx, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
     bool set_link(size_t col_ndx, size_t, size_t, size_t, _impl::Instruction) noexcept
@@ -1512,14 +1566,16 @@ public:
         return true;
     }
 
-    bool insert_substring(size_t, size_t, size_t, StringData)
+    bool insert_substring(size_t, size_t row_ndx, size_t, StringData)
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
-    bool erase_substring(size_t, size_t, size_t, size_t)
+    bool erase_substring(size_t, size_t row_ndx, size_t, size_t)
     {
-        return true; // No-op
+        changed_row(row_ndx);
+        return true;
     }
 
     bool optimize_table() noexcept
@@ -1549,6 +1605,8 @@ public:
             m_desc_path_end = path + levels;
             MarkDirtyUpdater updater;
             tf::update_accessors(*m_table, m_desc_path_begin, m_desc_path_end, updater);
+            // The schema is about to change, which the queries of the views are not prepared for
+            tf::adj_views_discard_changes(*m_table);
         }
         return true;
     }
@@ -1666,6 +1724,16 @@ public:
         return true; // No-op
     }
 
+    bool add_range_index(size_t) noexcept
+    {
+        return true; // No-op
+    }
+
+    bool remove_range_index(size_t) noexcept
+    {
+        return true; // No-op
+    }
+
     bool add_primary_key(size_t) noexcept
     {
         return true; // No-op
@@ -1739,6 +1807,13 @@ private:
     const size_t* m_desc_path_begin;
     const size_t* m_desc_path_end;
     bool& m_schema_changed;
+
+    // Record that a row of the selected table was modified, for the views which are synchronized incrementally
+    void changed_row(size_t row_ndx) noexcept
+    {
+        if (m_table)
+            _impl::TableFriend::adj_views_changed_rows(*m_table, row_ndx, 1);
+    }
 };
 
 void Group::refresh_dirty_accessors()
@@ -1753,8 +1828,10 @@ void Group::refresh_dirty_accessors()
             tf::set_ndx_in_parent(*table, table_ndx);
             if (tf::is_marked(*table)) {
                 tf::refresh_accessor_tree(*table); // Throws
+                uint_fast64_t prior_version = tf::get_version(*table);
                 bool bump_global = false;
                 tf::bump_version(*table, bump_global);
+                tf::adj_views_changes_recorded(*table, prior_version);
             }
         }
     }
@@ -703,6 +703,7 @@ private:
     std::shared_ptr<metrics::Metrics> get_metrics() const noexcept;
     void set_metrics(std::shared_ptr<metrics::Metrics> other) noexcept;
     void update_num_objects();
+    void update_derived_table_data();
     class TransactAdvancer;
     void advance_transact(ref_type new_top_ref, size_t new_file_size, _impl::NoCopyInputStream&);
     void refresh_dirty_accessors();
@@ -768,6 +769,15 @@ private:
     ///
     ///   9 Replication instruction values shuffled, instr_MoveRow added.
     ///
+    ///  10 Not used. Files of another layout use this version (see
+    ///     Upgrade_Database_9_10), and this version of the library cannot
+    ///     open them.
+    ///
+    ///  11 Leaves of integer B+-trees may be stored in an encoded form (frame
+    ///     of reference, run length or null bitmap, see "Encoded arrays" in
+    ///     array.cpp). The top array of a table may have column statistics and
+    ///     range indexes.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and SharedGroup::do_open, the file
     /// format selection logic in
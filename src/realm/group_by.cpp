@@ -0,0 +1,479 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/group_by.hpp>
+
+#include <realm/column_link.hpp>
+#include <realm/column_string.hpp>
+#include <realm/column_timestamp.hpp>
+#include <realm/impl/parallel.hpp>
+#include <realm/query.hpp>
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <typeinfo>
+#include <unordered_set>
+
+using namespace realm;
+
+namespace {
+
+using HashFunc = size_t (*)(const ColumnBase&, size_t row);
+
+size_t hash_timestamp(const ColumnBase& column, size_t row)
+{
+    return std::hash<Timestamp>()(static_cast<const TimestampColumn&>(column).get(row));
+}
+
+size_t hash_nullable_int(const ColumnBase& column, size_t row)
+{
+    util::Optional<int64_t> value = static_cast<const IntNullColumn&>(column).get(row);
+    return value ? std::hash<int64_t>()(*value) : 0;
+}
+
+// Int, bool and link columns, and enumerated string columns, where the strings are stored as indexes into the list
+// of distinct strings
+size_t hash_int(const ColumnBase& column, size_t row)
+{
+    return std::hash<int64_t>()(static_cast<const IntegerColumn&>(column).get(row));
+}
+
+HashFunc get_hash_func(const ColumnBase& column)
+{
+    const std::type_info& type = typeid(column);
+    if (type == typeid(StringColumn))
+        return &_impl::hash_string;
+    if (type == typeid(FloatColumn))
+        return &_impl::hash_floating_point<float>;
+    if (type == typeid(DoubleColumn))
+        return &_impl::hash_floating_point<double>;
+    if (type == typeid(TimestampColumn))
+        return &hash_timestamp;
+    if (type == typeid(IntNullColumn))
+        return &hash_nullable_int;
+    return &hash_int;
+}
+
+// Hashes and compares the keys of the aggregated rows, which are referred to by their position in `rows`
+class RowKeys {
+public:
+    RowKeys(const std::vector<std::vector<const ColumnBase*>>& keys, const std::vector<size_t>& rows)
+        : m_keys(keys)
+        , m_rows(rows)
+    {
+        for (auto& chain : keys)
+            m_hash_funcs.push_back(get_hash_func(*chain.back()));
+    }
+
+    size_t hash(size_t pos) const
+    {
+        size_t hash = 0;
+        for (size_t k = 0; k < m_keys.size(); ++k) {
+            size_t row = translate(k, m_rows[pos]);
+            hash = _impl::combine_hash(hash, row == npos ? size_t(-1) : m_hash_funcs[k](*m_keys[k].back(), row));
+        }
+        return hash;
+    }
+
+    bool equal(size_t pos_1, size_t pos_2) const
+    {
+        for (size_t k = 0; k < m_keys.size(); ++k) {
+            size_t row_1 = translate(k, m_rows[pos_1]);
+            size_t row_2 = translate(k, m_rows[pos_2]);
+            if (row_1 == npos || row_2 == npos) {
+                if (row_1 != row_2)
+                    return false;
+                continue;
+            }
+            if (m_keys[k].back()->compare_values(row_1, row_2) != 0)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    const std::vector<std::vector<const ColumnBase*>>& m_keys;
+    const std::vector<size_t>& m_rows;
+    std::vector<HashFunc> m_hash_funcs;
+
+    // The row in the last column of key `k` that `row` leads to, or npos if there is a null link on the way
+    size_t translate(size_t k, size_t row) const
+    {
+        const std::vector<const ColumnBase*>& chain = m_keys[k];
+        for (size_t i = 0; i + 1 < chain.size(); ++i) {
+            auto& link_col = static_cast<const LinkColumn&>(*chain[i]);
+            if (link_col.is_null(row))
+                return npos;
+            row = link_col.get_link(row);
+        }
+        return row;
+    }
+};
+
+} // anonymous namespace
+
+
+// The values accumulated so far of an aggregate over the rows of a group
+struct GroupBy::Accumulator {
+    // The number of non-null values
+    size_t count = 0;
+    // Sums of int columns, and minimum and maximum of int columns
+    int64_t int_value = 0;
+    // Sums, minimum and maximum of float and double columns
+    double double_value = 0;
+    // Minimum and maximum of timestamp columns
+    Timestamp timestamp_value;
+};
+
+// Groups found among some of the rows, with the accumulators of each group stored one after the other
+class GroupBy::Groups {
+public:
+    struct Entry {
+        // The position of the first row of the group among the aggregated rows
+        size_t first;
+        size_t hash;
+        size_t count;
+    };
+    std::vector<Entry> entries;
+    std::vector<Accumulator> accumulators;
+
+    Groups(const RowKeys& keys, size_t num_aggregates)
+        : m_num_aggregates(num_aggregates)
+        , m_index(0, Hash{this}, Equal{this, &keys})
+    {
+    }
+
+    // Return the index of the group of the row at `pos`, after adding the group if it is not there
+    size_t find_or_add(size_t pos, size_t hash)
+    {
+        entries.push_back({pos, hash, 0}); // Throws
+        auto result = m_index.insert(entries.size() - 1); // Throws
+        if (!result.second) {
+            entries.pop_back();
+            return *result.first;
+        }
+        accumulators.resize(accumulators.size() + m_num_aggregates); // Throws
+        return entries.size() - 1;
+    }
+
+    Accumulator* get_accumulators(size_t group_ndx)
+    {
+        return accumulators.data() + group_ndx * m_num_aggregates;
+    }
+
+private:
+    struct Hash {
+        const Groups* groups;
+        size_t operator()(size_t group_ndx) const
+        {
+            return groups->entries[group_ndx].hash;
+        }
+    };
+    struct Equal {
+        const Groups* groups;
+        const RowKeys* keys;
+        bool operator()(size_t group_ndx_1, size_t group_ndx_2) const
+        {
+            const Entry& entry_1 = groups->entries[group_ndx_1];
+            const Entry& entry_2 = groups->entries[group_ndx_2];
+            return entry_1.hash == entry_2.hash && keys->equal(entry_1.first, entry_2.first);
+        }
+    };
+
+    size_t m_num_aggregates;
+    std::unordered_set<size_t, Hash, Equal> m_index;
+};
+
+GroupBy::GroupBy(const Table& table, std::vector<std::vector<size_t>> key_columns)
+    : m_table(table)
+{
+    for (auto& chain : key_columns) {
+        if (chain.empty())
+            throw LogicError(LogicError::column_index_out_of_range);
+        std::vector<const ColumnBase*> columns;
+        const Table* cur_table = &table;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            size_t col_ndx = chain[i];
+            if (col_ndx >= cur_table->get_column_count())
+                throw LogicError(LogicError::column_index_out_of_range);
+            DataType type = cur_table->get_column_type(col_ndx);
+            bool is_last = i + 1 == chain.size();
+            bool is_supported = type == type_Link ||
+                                (is_last && (type == type_Int || type == type_Bool || type == type_Float ||
+                                             type == type_Double || type == type_String || type == type_Timestamp ||
+                                             type == type_OldDateTime));
+            if (!is_supported)
+                throw LogicError(LogicError::type_mismatch);
+
+            // A degenerate table has no column accessors, but also no rows to aggregate
+            if (cur_table->is_degenerate())
+                break;
+            const ColumnBase& column = _impl::TableFriend::get_column(*cur_table, col_ndx);
+            columns.push_back(&column);
+            if (!is_last)
+                cur_table = &static_cast<const LinkColumn&>(column).get_target_table();
+        }
+        m_keys.push_back(std::move(columns));
+    }
+}
+
+size_t GroupBy::add_aggregate(Op op, size_t column_ndx)
+{
+    Aggregate aggregate{op, column_ndx, type_Int, false, nullptr};
+    if (op != Op::count) {
+        if (column_ndx >= m_table.get_column_count())
+            throw LogicError(LogicError::column_index_out_of_range);
+        DataType type = m_table.get_column_type(column_ndx);
+        bool is_supported = type == type_Int || type == type_Float || type == type_Double ||
+                            (type == type_Timestamp && (op == Op::minimum || op == Op::maximum));
+        if (!is_supported)
+            throw LogicError(LogicError::type_mismatch);
+        aggregate.type = type;
+        aggregate.nullable = m_table.is_nullable(column_ndx);
+        if (!m_table.is_degenerate())
+            aggregate.column = &_impl::TableFriend::get_column(m_table, column_ndx);
+    }
+    m_aggregates.push_back(aggregate); // Throws
+    return m_aggregates.size() - 1;
+}
+
+GroupByResult GroupBy::aggregate() const
+{
+    std::vector<size_t> rows(m_table.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+        rows[i] = i;
+    return aggregate(rows); // Throws
+}
+
+GroupByResult GroupBy::aggregate(Query& query) const
+{
+    REALM_ASSERT(query.get_table().get() == &m_table);
+    TableView view = query.find_all(); // Throws
+    return aggregate(view);            // Throws
+}
+
+GroupByResult GroupBy::aggregate(const TableViewBase& view) const
+{
+    REALM_ASSERT(view.m_table.get() == &m_table);
+    std::vector<size_t> rows;
+    rows.reserve(view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+        if (view.is_row_attached(i))
+            rows.push_back(view.get_source_ndx(i));
+    }
+    return aggregate(rows); // Throws
+}
+
+GroupByResult GroupBy::aggregate(const std::vector<size_t>& rows) const
+{
+    const size_t num_rows = rows.size();
+    const size_t num_aggregates = m_aggregates.size();
+    GroupByResult result;
+    result.m_num_aggregates = num_aggregates;
+    // A degenerate table has no rows, and no column accessors either
+    if (num_rows == 0)
+        return result;
+    RowKeys keys(m_keys, rows);
+
+    // Every thread first finds the groups among its share of the rows
+    size_t max_num_parts = num_rows / _impl::parallel_min_rows_per_thread;
+    size_t num_parts = std::max(std::min(size_t(m_threadcount), max_num_parts), size_t(1));
+    std::vector<std::unique_ptr<Groups>> parts;
+    for (size_t part = 0; part < num_parts; ++part)
+        parts.emplace_back(new Groups(keys, num_aggregates)); // Throws
+    _impl::run_in_parallel(num_parts, [&](size_t part) {
+        Groups& groups = *parts[part];
+        for (size_t pos = num_rows * part / num_parts; pos < num_rows * (part + 1) / num_parts; ++pos) {
+            size_t group_ndx = groups.find_or_add(pos, keys.hash(pos)); // Throws
+            ++groups.entries[group_ndx].count;
+            Accumulator* accumulators = groups.get_accumulators(group_ndx);
+            for (size_t a = 0; a < num_aggregates; ++a)
+                accumulate(m_aggregates[a], accumulators[a], rows[pos]);
+        }
+    }); // Throws
+
+    // Then every thread merges the groups whose hash falls in its share. The parts are merged in order, so the first
+    // row of a merged group is that of the part where it was found first.
+    std::vector<std::unique_ptr<Groups>> merged_parts;
+    if (num_parts == 1) {
+        merged_parts = std::move(parts);
+    }
+    else {
+        for (size_t share = 0; share < num_parts; ++share)
+            merged_parts.emplace_back(new Groups(keys, num_aggregates)); // Throws
+        _impl::run_in_parallel(num_parts, [&](size_t share) {
+            Groups& merged = *merged_parts[share];
+            for (auto& part : parts) {
+                for (size_t g = 0; g < part->entries.size(); ++g) {
+                    const Groups::Entry& entry = part->entries[g];
+                    if (entry.hash % num_parts != share)
+                        continue;
+                    size_t group_ndx = merged.find_or_add(entry.first, entry.hash); // Throws
+                    merged.entries[group_ndx].count += entry.count;
+                    Accumulator* accumulators = merged.get_accumulators(group_ndx);
+                    const Accumulator* part_accumulators = part->get_accumulators(g);
+                    for (size_t a = 0; a < num_aggregates; ++a)
+                        merge(m_aggregates[a], accumulators[a], part_accumulators[a]);
+                }
+            }
+        }); // Throws
+    }
+
+    // The groups are returned in the order of their first rows
+    std::vector<std::pair<Groups*, size_t>> order;
+    for (auto& groups : merged_parts) {
+        for (size_t g = 0; g < groups->entries.size(); ++g)
+            order.emplace_back(groups.get(), g); // Throws
+    }
+    std::sort(order.begin(), order.end(), [](auto& a, auto& b) {
+        return a.first->entries[a.second].first < b.first->entries[b.second].first;
+    });
+
+    result.m_rows.reserve(order.size());
+    result.m_counts.reserve(order.size());
+    result.m_values.reserve(order.size() * num_aggregates);
+    for (auto& group : order) {
+        const Groups::Entry& entry = group.first->entries[group.second];
+        const Accumulator* accumulators = group.first->get_accumulators(group.second);
+        result.m_rows.push_back(rows[entry.first]);
+        result.m_counts.push_back(entry.count);
+        for (size_t a = 0; a < num_aggregates; ++a)
+            result.m_values.push_back(get_value(m_aggregates[a], accumulators[a], entry.count));
+    }
+    return result;
+}
+
+void GroupBy::accumulate(const Aggregate& aggregate, Accumulator& accumulator, size_t row)
+{
+    if (aggregate.op == Op::count)
+        return;
+    if (aggregate.nullable && aggregate.column->is_null(row))
+        return;
+
+    Accumulator value;
+    value.count = 1;
+    switch (aggregate.type) {
+        case type_Int:
+            if (aggregate.nullable) {
+                value.int_value = *static_cast<const IntNullColumn*>(aggregate.column)->get(row);
+            }
+            else {
+                value.int_value = static_cast<const IntegerColumn*>(aggregate.column)->get(row);
+            }
+            break;
+        case type_Float:
+            value.double_value = static_cast<const FloatColumn*>(aggregate.column)->get(row);
+            break;
+        case type_Double:
+            value.double_value = static_cast<const DoubleColumn*>(aggregate.column)->get(row);
+            break;
+        case type_Timestamp:
+            value.timestamp_value = static_cast<const TimestampColumn*>(aggregate.column)->get(row);
+            break;
+        default:
+            REALM_UNREACHABLE();
+    }
+    merge(aggregate, accumulator, value);
+}
+
+void GroupBy::merge(const Aggregate& aggregate, Accumulator& accumulator, const Accumulator& other)
+{
+    if (other.count == 0)
+        return;
+    if (accumulator.count == 0) {
+        accumulator = other;
+        return;
+    }
+
+    accumulator.count += other.count;
+    switch (aggregate.op) {
+        case Op::count:
+            break;
+        case Op::sum:
+        case Op::average:
+            // Int sums wrap around on overflow, like Table::sum_int()
+            accumulator.int_value = int64_t(uint64_t(accumulator.int_value) + uint64_t(other.int_value));
+            accumulator.double_value += other.double_value;
+            break;
+        case Op::minimum:
+        case Op::maximum: {
+            bool is_min = aggregate.op == Op::minimum;
+            switch (aggregate.type) {
+                case type_Int:
+                    if ((other.int_value < accumulator.int_value) == is_min && other.int_value != accumulator.int_value)
+                        accumulator.int_value = other.int_value;
+                    break;
+                case type_Float:
+                case type_Double:
+                    if ((other.double_value < accumulator.double_value) == is_min &&
+                        other.double_value != accumulator.double_value)
+                        accumulator.double_value = other.double_value;
+                    break;
+                case type_Timestamp:
+                    // Timestamps are only ordered when neither is null, which is the case here as nulls are skipped
+                    if ((other.timestamp_value < accumulator.timestamp_value) == is_min &&
+                        other.timestamp_value != accumulator.timestamp_value)
+                        accumulator.timestamp_value = other.timestamp_value;
+                    break;
+                default:
+                    REALM_UNREACHABLE();
+            }
+            break;
+        }
+    }
+}
+
+util::Optional<Mixed> GroupBy::get_value(const Aggregate& aggregate, const Accumulator& accumulator,
+                                         size_t num_rows)
+{
+    switch (aggregate.op) {
+        case Op::count:
+            return Mixed(int64_t(num_rows));
+        case Op::sum:
+            if (aggregate.type == type_Int)
+                return Mixed(accumulator.int_value);
+            return Mixed(accumulator.double_value);
+        case Op::average:
+            if (accumulator.count == 0)
+                return util::none;
+            if (aggregate.type == type_Int)
+                return Mixed(double(accumulator.int_value) / accumulator.count);
+            return Mixed(accumulator.double_value / accumulator.count);
+        case Op::minimum:
+        case Op::maximum:
+            if (accumulator.count == 0)
+                return util::none;
+            switch (aggregate.type) {
+                case type_Int:
+                    return Mixed(accumulator.int_value);
+                case type_Float:
+                    return Mixed(float(accumulator.double_value));
+                case type_Double:
+                    return Mixed(accumulator.double_value);
+                case type_Timestamp:
+                    return Mixed(accumulator.timestamp_value);
+                default:
+                    break;
+            }
+            break;
+    }
+    REALM_UNREACHABLE();
+}
@@ -0,0 +1,195 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_GROUP_BY_HPP
+#define REALM_GROUP_BY_HPP
+
+#include <vector>
+
+#include <realm/data_type.hpp>
+#include <realm/mixed.hpp>
+#include <realm/util/optional.hpp>
+
+namespace realm {
+
+class ColumnBase;
+class GroupByResult;
+class Query;
+class Table;
+class TableViewBase;
+
+/// GroupBy splits rows of a table into groups of rows that have the same
+/// values in one or more key columns, and computes aggregates of other
+/// columns over each group:
+///
+///     GroupBy group_by(table, {{city_col}, {employer_col, name_col}});
+///     size_t num_employees = group_by.count();
+///     size_t total_salary = group_by.sum(salary_col);
+///     GroupByResult result = group_by.aggregate(query);
+///     for (size_t i = 0; i < result.size(); ++i)
+///         std::cout << table.get_string(city_col, result.get_row(i)) << ": "
+///                   << result.get(i, total_salary)->get_int() << "\n";
+///
+/// Each key is a chain of column indices, where all but the last are link
+/// columns, like the columns of a SortDescriptor. Rows with a null link along
+/// a chain form groups of their own. The last column of a chain may be of
+/// type int, bool, float, double, string, timestamp or link, where rows are
+/// grouped by the row they link to. Null is a key value like any other.
+///
+/// Rows are grouped by hashing their keys. With several threads, each thread
+/// aggregates a part of the rows into groups of its own, and the groups of
+/// all threads are then merged, also in parallel.
+class GroupBy {
+public:
+    GroupBy(const Table&, std::vector<std::vector<size_t>> key_columns);
+
+    /// Add an aggregate to be computed for every group, and return its index
+    /// in the result. count() counts the rows of the group. sum() and
+    /// average() require an int, float or double column, and minimum() and
+    /// maximum() an int, float, double or timestamp column. Nulls are left
+    /// out of all but count().
+    size_t count();
+    size_t sum(size_t column_ndx);
+    size_t minimum(size_t column_ndx);
+    size_t maximum(size_t column_ndx);
+    size_t average(size_t column_ndx);
+
+    /// Aggregate with up to `threadcount` threads. The result does not depend
+    /// on the number of threads. The default of 1 aggregates on the calling
+    /// thread only.
+    void set_threads(unsigned int threadcount) noexcept;
+
+    /// Aggregate all rows of the table, the rows that match `query`, or the
+    /// rows of `view`. The query and the view must be of the same table.
+    GroupByResult aggregate() const;
+    GroupByResult aggregate(Query& query) const;
+    GroupByResult aggregate(const TableViewBase& view) const;
+
+private:
+    enum class Op { count, sum, minimum, maximum, average };
+    struct Aggregate {
+        Op op;
+        size_t column_ndx;
+        DataType type;
+        bool nullable;
+        const ColumnBase* column;
+    };
+    struct Accumulator;
+    class Groups;
+
+    const Table& m_table;
+    // The columns of each key, from the table to the column of the value
+    std::vector<std::vector<const ColumnBase*>> m_keys;
+    std::vector<Aggregate> m_aggregates;
+    unsigned int m_threadcount = 1;
+
+    size_t add_aggregate(Op op, size_t column_ndx);
+    GroupByResult aggregate(const std::vector<size_t>& rows) const;
+
+    static void accumulate(const Aggregate&, Accumulator&, size_t row);
+    static void merge(const Aggregate&, Accumulator&, const Accumulator& other);
+    static util::Optional<Mixed> get_value(const Aggregate&, const Accumulator&, size_t num_rows);
+};
+
+/// The groups found by GroupBy::aggregate(), in the order of the first row of
+/// each group among the rows that were aggregated.
+class GroupByResult {
+public:
+    /// The number of groups
+    size_t size() const noexcept;
+
+    /// The index in the table of the first row of a group. The values of its
+    /// key columns are the key of the group.
+    size_t get_row(size_t group_ndx) const noexcept;
+
+    /// The number of rows of a group
+    size_t get_count(size_t group_ndx) const noexcept;
+
+    /// The value of an aggregate for a group. Counts are ints. Sums have the
+    /// type of the column, except that the sum of a float column is a double.
+    /// Averages are doubles. Minimum and maximum have the type of the column.
+    /// Minimum, maximum and average are none if all values of the group are
+    /// null.
+    util::Optional<Mixed> get(size_t group_ndx, size_t aggregate_ndx) const noexcept;
+
+private:
+    size_t m_num_aggregates = 0;
+    std::vector<size_t> m_rows;
+    std::vector<size_t> m_counts;
+    // The value of aggregate `a` for group `g` is at m_values[g * m_num_aggregates + a]
+    std::vector<util::Optional<Mixed>> m_values;
+
+    friend class GroupBy;
+};
+
+
+// Implementation:
+
+inline size_t GroupBy::count()
+{
+    return add_aggregate(Op::count, size_t(-1));
+}
+
+inline size_t GroupBy::sum(size_t column_ndx)
+{
+    return add_aggregate(Op::sum, column_ndx);
+}
+
+inline size_t GroupBy::minimum(size_t column_ndx)
+{
+    return add_aggregate(Op::minimum, column_ndx);
+}
+
+inline size_t GroupBy::maximum(size_t column_ndx)
+{
+    return add_aggregate(Op::maximum, column_ndx);
+}
+
+inline size_t GroupBy::average(size_t column_ndx)
+{
+    return add_aggregate(Op::average, column_ndx);
+}
+
+inline void GroupBy::set_threads(unsigned int threadcount) noexcept
+{
+    m_threadcount = threadcount == 0 ? 1 : threadcount;
+}
+
+inline size_t GroupByResult::size() const noexcept
+{
+    return m_rows.size();
+}
+
+inline size_t GroupByResult::get_row(size_t group_ndx) const noexcept
+{
+    return m_rows[group_ndx];
+}
+
+inline size_t GroupByResult::get_count(size_t group_ndx) const noexcept
+{
+    return m_counts[group_ndx];
+}
+
+inline util::Optional<Mixed> GroupByResult::get(size_t group_ndx, size_t aggregate_ndx) const noexcept
+{
+    return m_values[group_ndx * m_num_aggregates + aggregate_ndx];
+}
+
+} // namespace realm
+
+#endif // REALM_GROUP_BY_HPP
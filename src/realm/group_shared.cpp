@@ -19,10 +19,14 @@
 #include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <fcntl.h>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <random>
 
@@ -76,61 +80,71 @@ const uint16_t relaxed_sync_threshold = 50;
 //  9      Fair write transactions requires an additional condition variable,
 //         `write_fairness`
 // 10      Introducing SharedInfo::history_schema_version.
-const uint_fast16_t g_shared_info_version = 10;
+// 11      Introducing SharedInfo::durable_version, SharedInfo::latest_top_ref,
+//         SharedInfo::log_replayed, and `shared_syncmutex` for group commits,
+//         deferred durability and the changeset log.
+// 12      Splitting the reader count of each Ringbuffer entry into per-thread
+//         shards, each on a cache line of its own.
+// 13      Recording the process and time of the first reader of each shard.
+// 14      Introducing SharedInfo::log_size.
+const uint_fast16_t g_shared_info_version = 14;
 
 // The following functions are carefully designed for minimal overhead
 // in case of contention among read transactions. In case of contention,
 // they consume roughly 90% of the cycles used to start and end a read transaction.
 //
-// Each live version carries a "count" field, which combines a reference count
-// of the readers bound to that version, and a single-bit "free" flag, which
-// indicates that the entry does not hold valid data.
+// Each live version carries a set of "count" fields, which are reference
+// counts of the readers bound to that version, and a "free" flag, which
+// indicates that the entry does not hold valid data. Each reader thread
+// uses one of the count fields (its shard), and each count field is on a
+// cache line of its own, so that readers of the same version on different
+// threads do not contend for the same cache line. The free flag is only
+// changed by write transactions, so its cache line is shared by the readers.
 //
 // The usage patterns are as follows:
 //
 // Read transactions guard their access to the version information by
-// increasing the count field for the duration of the transaction.
-// A non-zero count field also indicates that the free space associated
-// with the version must remain intact. A zero count field indicates that
-// no one refers to that version, so it's free lists can be merged into
-// older free space and recycled.
+// increasing the count field of their shard for the duration of the
+// transaction. A non-zero count field also indicates that the free space
+// associated with the version must remain intact. When all the count fields
+// are zero, no one refers to that version, so it's free lists can be merged
+// into older free space and recycled.
 //
 // Only write transactions allocate and write new version entries. Also,
 // Only write transactions scan the ringbuffer for older versions which
-// are not used (count is zero) and free them. As write transactions are
+// are not used (all counts are zero) and free them. As write transactions are
 // atomic (ensured by mutex), there is no race between freeing entries
 // in the ringbuffer and allocating and writing them.
 //
 // There are no race conditions between read transactions. Read transactions
-// never change the versioning information, only increment or decrement the
+// never change the versioning information, only increment or decrement a
 // count (and do so solely through the use of atomic operations).
 //
-// There is a race between read transactions incrementing the count field and
-// a write transaction setting the free field. These are mutually exclusive:
-// if a read sees the free field set, it cannot use the entry. As it has already
-// incremented the count field (optimistically, anticipating that the free bit
+// There is a race between read transactions incrementing a count field and
+// a write transaction setting the free flag. These are mutually exclusive:
+// if a read sees the free flag set, it cannot use the entry. As it has already
+// incremented the count field (optimistically, anticipating that the free flag
 // was clear), it must immediately decrement it again. Likewise, it is possible
-// for one thread to set the free bit (anticipating a count of zero) while another
-// thread increments the count (anticipating a clear free bit). In such cases,
+// for one thread to set the free flag (anticipating counts of zero) while another
+// thread increments a count (anticipating a clear free flag). In such cases,
 // both threads undo their changes and back off.
 //
-// For all changes to the free field and the count field: It is important that changes
-// to the free field takes the count field into account and vice versa, because they
-// are changed optimistically but atomically. This is implemented by modifying the
-// count field only by atomic add/sub of '2', and modifying the free field only by
-// atomic add/sub of '1'.
+// For this to work, a reader must increment its count field before it reads the
+// free flag, and the writer must set the free flag before it reads the count
+// fields, and all four accesses must be sequentially consistent. Otherwise both
+// could miss the change made by the other.
 //
 // The following *memory* ordering is required for correctness:
 //
 // 1 Accesses within a transaction assumes the version info is valid *before*
-//   reading it. This is achieved by synchronizing on the count field. Reading
-//   the count field is an *acquire*, while clearing the free field is a *release*.
+//   reading it. This is achieved by synchronizing on the free flag. Reading
+//   the free flag is an *acquire*, while clearing it is a *release*.
 //
 // 2 Accesses within a transaction assumes the version *remains* valid, so
 //   all memory accesses with a read transaction must happen before
 //   the changes to memory (by a write transaction). This is achieved
 //   by use of *release* when the count field is decremented, and use of
-//   *acquire* when the free field is set (by the write transaction).
+//   *acquire* when the count fields are read (by the write transaction).
 //
 // 3 Reads of the counter is synchronized by accesses to the put_pos variable
 //   in the ringbuffer. Reading put_pos is an acquire and writing put_pos is
@@ -161,79 +175,160 @@ const uint_fast16_t g_shared_info_version = 10;
 //
 
 template <typename T>
-bool atomic_double_inc_if_even(std::atomic<T>& counter)
+void atomic_dec(std::atomic<T>& counter)
 {
-    T oldval = counter.fetch_add(2, std::memory_order_acquire);
-    if (oldval & 1) {
-        // oooops! was odd, adjust
-        counter.fetch_sub(2, std::memory_order_relaxed);
-        return false;
-    }
-    return true;
+    counter.fetch_sub(1, std::memory_order_release);
 }
 
-template <typename T>
-inline void atomic_double_dec(std::atomic<T>& counter)
+// The number of count fields of each version entry. Reader threads are
+// assigned a shard each in a round robin fashion.
+const uint_fast32_t num_reader_shards = 16;
+
+// The size of a cache line, or a multiple of it
+const size_t reader_shard_size = 64;
+
+// The shard that is used by read transactions of the calling thread
+uint_fast32_t get_reader_shard() noexcept
 {
-    counter.fetch_sub(2, std::memory_order_release);
+    static std::atomic<uint_fast32_t> next_shard(0);
+    // Zero means that the thread has not been assigned a shard yet
+    static REALM_THREAD_LOCAL uint_fast32_t shard_plus_one = 0;
+    if (REALM_UNLIKELY(shard_plus_one == 0))
+        shard_plus_one = next_shard.fetch_add(1, std::memory_order_relaxed) % num_reader_shards + 1;
+    return shard_plus_one - 1;
 }
 
-template <typename T>
-bool atomic_one_if_zero(std::atomic<T>& counter)
+// Used to tell the owners of pinned versions apart. SharedGroups must not be
+// used across fork(), so the process ID cannot change under them.
+uint64_t get_reader_pid() noexcept
 {
-    T old_val = counter.fetch_add(1, std::memory_order_acquire);
-    if (old_val != 0) {
-        counter.fetch_sub(1, std::memory_order_relaxed);
-        return false;
-    }
-    return true;
+    static uint64_t pid = uint64_t(getpid());
+    return pid;
 }
 
-template <typename T>
-void atomic_dec(std::atomic<T>& counter)
+// Milliseconds of a clock that is shared by the processes of the machine, and
+// which never goes backwards
+uint64_t get_reader_clock() noexcept
 {
-    counter.fetch_sub(1, std::memory_order_release);
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
 }
 
 // nonblocking ringbuffer
 class Ringbuffer {
 public:
     // the ringbuffer is a circular list of ReadCount structures.
-    // Entries from old_pos to put_pos are considered live and may
-    // have an even value in 'count'. The count indicates the
-    // number of referring transactions times 2.
+    // Entries from old_pos to put_pos are considered live and have
+    // a 'free' flag of zero. The sum of the counts of the shards is the
+    // number of referring transactions.
     // Entries from after put_pos up till (not including) old_pos
-    // are free entries and must have a count of ONE.
-    // Cleanup is performed by starting at old_pos and incrementing
-    // (atomically) from 0 to 1 and moving the put_pos. It stops
-    // if count is non-zero. This approach requires that only a single thread
+    // are free entries and must have a 'free' flag of ONE.
+    // Cleanup is performed by starting at old_pos and setting the flag
+    // from 0 to 1 and moving the put_pos. It stops if any of the counts
+    // is non-zero. This approach requires that only a single thread
     // at a time tries to perform cleanup. This is ensured by doing the cleanup
     // as part of write transactions, where mutual exclusion is assured by the
     // write mutex.
+    struct alignas(reader_shard_size) ReaderShard {
+        mutable std::atomic<uint32_t> count;
+        // The process of the reader that made the count non-zero, and when,
+        // according to get_reader_clock(). For diagnostics only.
+        mutable std::atomic<uint64_t> owner_pid;
+        mutable std::atomic<uint64_t> bound_at;
+    };
+
     struct ReadCount {
         uint64_t version;
         uint64_t filesize;
         uint64_t current_top;
-        // The count field acts as synchronization point for accesses to the above
-        // fields. A succesfull inc implies acquire with regard to memory consistency.
-        // Release is triggered by explicitly storing into count whenever a
-        // new entry has been initialized.
-        mutable std::atomic<uint32_t> count;
+        // The free flag acts as synchronization point for accesses to the above
+        // fields. Reading it as zero after a count has been incremented implies
+        // acquire with regard to memory consistency. Release is triggered by
+        // explicitly storing into the flag whenever a new entry has been
+        // initialized.
+        mutable std::atomic<uint32_t> free;
         uint32_t next;
+        ReaderShard shards[num_reader_shards];
+
+        // Register a reader of this entry in the specified shard. Fails if the
+        // entry is free, or is being probed by the cleanup.
+        bool try_lock(uint_fast32_t shard) const noexcept
+        {
+            std::atomic<uint32_t>& count = shards[shard].count;
+            uint32_t old_count = count.fetch_add(1, std::memory_order_seq_cst);
+            if (free.load(std::memory_order_seq_cst) != 0) {
+                count.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (old_count == 0) {
+                shards[shard].owner_pid.store(get_reader_pid(), std::memory_order_relaxed);
+                shards[shard].bound_at.store(get_reader_clock(), std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        void unlock(uint_fast32_t shard) const noexcept
+        {
+            atomic_dec(shards[shard].count);
+        }
+
+        // Mark this entry as free, unless it has readers. Must only be called
+        // by the cleanup.
+        bool try_free() const noexcept
+        {
+            free.store(1, std::memory_order_seq_cst);
+            for (const ReaderShard& shard : shards) {
+                if (shard.count.load(std::memory_order_seq_cst) != 0) {
+                    free.store(0, std::memory_order_release);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void init_free() noexcept
+        {
+            version = 1;
+            free.store(1, std::memory_order_relaxed);
+            current_top = 0;
+            filesize = 0;
+            for (ReaderShard& shard : shards) {
+                shard.count.store(0, std::memory_order_relaxed);
+                shard.owner_pid.store(0, std::memory_order_relaxed);
+                shard.bound_at.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Get the number of readers of this entry, and the process of the one
+        // that has been a reader the longest, as far as the shards can tell,
+        // along with the time it became one.
+        uint_fast64_t get_readers(uint64_t& owner_pid, uint64_t& bound_at) const noexcept
+        {
+            uint_fast64_t num_readers = 0;
+            for (const ReaderShard& shard : shards) {
+                uint32_t count = shard.count.load(std::memory_order_relaxed);
+                if (count == 0)
+                    continue;
+                uint64_t time = shard.bound_at.load(std::memory_order_relaxed);
+                if (num_readers == 0 || time < bound_at) {
+                    owner_pid = shard.owner_pid.load(std::memory_order_relaxed);
+                    bound_at = time;
+                }
+                num_readers += count;
+            }
+            return num_readers;
+        }
     };
 
     Ringbuffer() noexcept
     {
         entries = init_readers_size;
         for (int i = 0; i < init_readers_size; i++) {
-            data[i].version = 1;
-            data[i].count.store(1, std::memory_order_relaxed);
-            data[i].current_top = 0;
-            data[i].filesize = 0;
+            data[i].init_free();
             data[i].next = i + 1;
         }
         old_pos = 0;
-        data[0].count.store(0, std::memory_order_relaxed);
+        data[0].free.store(0, std::memory_order_relaxed);
         data[init_readers_size - 1].next = 0;
         put_pos.store(0, std::memory_order_release);
     }
@@ -243,13 +338,13 @@ public:
         uint_fast32_t i = old_pos;
         std::cout << "--- " << std::endl;
         while (i != put_pos.load()) {
-            std::cout << "  used " << i << " : " << data[i].count.load() << " | " << data[i].version << std::endl;
+            std::cout << "  used " << i << " : " << data[i].free.load() << " | " << data[i].version << std::endl;
             i = data[i].next;
         }
-        std::cout << "  LAST " << i << " : " << data[i].count.load() << " | " << data[i].version << std::endl;
+        std::cout << "  LAST " << i << " : " << data[i].free.load() << " | " << data[i].version << std::endl;
         i = data[i].next;
         while (i != old_pos) {
-            std::cout << "  free " << i << " : " << data[i].count.load() << " | " << data[i].version << std::endl;
+            std::cout << "  free " << i << " : " << data[i].free.load() << " | " << data[i].version << std::endl;
             i = data[i].next;
         }
         std::cout << "--- Done" << std::endl;
@@ -260,10 +355,7 @@ public:
         // std::cout << "expanding to " << new_entries << std::endl;
         // dump();
         for (uint32_t i = entries; i < new_entries; i++) {
-            data[i].version = 1;
-            data[i].count.store(1, std::memory_order_relaxed);
-            data[i].current_top = 0;
-            data[i].filesize = 0;
+            data[i].init_free();
             data[i].next = i + 1;
         }
         data[new_entries - 1].next = old_pos;
@@ -310,12 +402,12 @@ public:
     ReadCount& reinit_last() noexcept
     {
         ReadCount& r = data[last()];
-        // r.count is an atomic<> due to other usage constraints. Right here, we're
+        // r.free is an atomic<> due to other usage constraints. Right here, we're
         // operating under mutex protection, so the use of an atomic store is immaterial
-        // and just forced on us by the type of r.count.
-        // You'll find the full discussion of how r.count is operated and why it must be
+        // and just forced on us by the type of r.free.
+        // You'll find the full discussion of how r.free is operated and why it must be
         // an atomic earlier in this file.
-        r.count.store(0, std::memory_order_relaxed);
+        r.free.store(0, std::memory_order_relaxed);
         return r;
     }
 
@@ -324,6 +416,20 @@ public:
         return get(old_pos.load(std::memory_order_relaxed));
     }
 
+    // Call the function for each of the live entries, oldest first. The caller
+    // must prevent concurrent write transactions.
+    template <class F>
+    void for_each_live(F fn) const
+    {
+        uint_fast32_t i = old_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            fn(data[i]);
+            if (i == put_pos.load(std::memory_order_relaxed))
+                break;
+            i = data[i].next;
+        }
+    }
+
     bool is_full() const noexcept
     {
         uint_fast32_t idx = get(last()).next;
@@ -345,7 +451,7 @@ public:
 
     void use_next() noexcept
     {
-        atomic_dec(get_next().count); // .store_release(0);
+        atomic_dec(get_next().free); // .store_release(0);
         put_pos.store(uint32_t(next()), std::memory_order_release);
     }
 
@@ -356,7 +462,7 @@ public:
         // dump();
         while (old_pos.load(std::memory_order_relaxed) != put_pos.load(std::memory_order_relaxed)) {
             const ReadCount& r = get(old_pos.load(std::memory_order_relaxed));
-            if (!atomic_one_if_zero(r.count))
+            if (!r.try_free())
                 break;
             auto next_ndx = get(old_pos.load(std::memory_order_relaxed)).next;
             old_pos.store(next_ndx, std::memory_order_relaxed);
@@ -402,11 +508,12 @@ private:
 /// on the file. All other members (except for the Ringbuffer) may be accessed
 /// only while holding a lock on `controlmutex`.
 ///
-/// SharedInfo must be 8-byte aligned. On 32-bit Apple platforms, mutexes store their
-/// alignment as part of the mutex state. We're copying the SharedInfo (including
-/// embedded but alway unlocked mutexes) and it must retain the same alignment
-/// throughout.
-struct alignas(8) SharedGroup::SharedInfo {
+/// SharedInfo must be at least 8-byte aligned. On 32-bit Apple platforms, mutexes
+/// store their alignment as part of the mutex state. We're copying the SharedInfo
+/// (including embedded but alway unlocked mutexes) and it must retain the same
+/// alignment throughout. It is aligned like the reader shards of the Ringbuffer,
+/// so that each of them occupies a cache line of its own.
+struct alignas(reader_shard_size) SharedGroup::SharedInfo {
     /// Indicates that initialization of the lock file was completed
     /// sucessfully.
     ///
@@ -510,6 +617,10 @@ struct alignas(8) SharedGroup::SharedInfo {
     InterprocessMutex::SharedPart shared_balancemutex;
 #endif
     InterprocessMutex::SharedPart shared_controlmutex;
+
+    /// Held while the header of the Realm file is updated and flushed in
+    /// Durability::Full mode.
+    InterprocessMutex::SharedPart shared_syncmutex;
     // FIXME: windows pthread support for condvar not ready
     InterprocessCondVar::SharedPart room_to_write;
     InterprocessCondVar::SharedPart work_to_do;
@@ -519,6 +630,28 @@ struct alignas(8) SharedGroup::SharedInfo {
     std::atomic<uint32_t> next_ticket;
     uint32_t next_served = 0;
 
+    /// The version of the snapshot that is selected by the header of the Realm
+    /// file, and which is flushed to stable storage along with everything it
+    /// refers to. Only maintained in Durability::Full, Durability::Deferred
+    /// and Durability::Logged mode. May only be modified while holding a lock
+    /// on `syncmutex`.
+    std::atomic<uint64_t> durable_version = { 0 };
+
+    /// The top ref of the snapshot of version `latest_version_number`. Guarded
+    /// by the controlmutex.
+    uint64_t latest_top_ref = 0;
+
+    /// Set when the changes in the changeset log that were missing from the
+    /// Realm file have been applied again, which happens once per session in
+    /// Durability::Logged mode. Guarded by the write mutex.
+    uint8_t log_replayed = 0;
+
+    /// The size of the changeset log up to the end of its last complete
+    /// record. Anything after it was left by a writer that did not finish
+    /// appending a record, e.g. because its process was killed, and is removed
+    /// before the next record is appended. Guarded by the write mutex.
+    uint64_t log_size = 0;
+
     // IMPORTANT: The ringbuffer MUST be the last field in SharedInfo - see above.
     Ringbuffer readers;
 
@@ -551,6 +684,7 @@ SharedGroup::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht
     , shared_balancemutex() // Throws
 #endif
     , shared_controlmutex() // Throws
+    , shared_syncmutex() // Throws
 {
     durability = static_cast<uint16_t>(dura); // durability level is fixed from creation
     REALM_ASSERT(!util::int_cast_has_overflow<decltype(history_type)>(ht + 0));
@@ -632,6 +766,72 @@ SharedGroup::SharedInfo::SharedInfo(Durability dura, Replication::HistoryType ht
 }
 
 
+// Flushes the snapshots committed with Durability::Deferred to stable storage
+// in the background. There is one per Realm file in each process, shared by
+// the SharedGroups of the process that have the file open. It has its own file
+// handles, memory mapping and mutex objects, so that it does not depend on any
+// one of those SharedGroups, but it relies on them to keep the session alive.
+class SharedGroup::BackgroundFlusher {
+public:
+    BackgroundFlusher(const std::string& db_path, const std::string& lockfile_path,
+                      const std::string& lockfile_prefix, std::chrono::milliseconds max_delay,
+                      bool changeset_log);
+    ~BackgroundFlusher() noexcept;
+
+    /// Get the flusher of the specified Realm file, which is created if the
+    /// process does not already have one.
+    static std::shared_ptr<BackgroundFlusher> get(const std::string& db_path, const std::string& lockfile_path,
+                                                  const std::string& lockfile_prefix,
+                                                  std::chrono::milliseconds max_delay, bool changeset_log);
+
+private:
+    // When the changeset log grows beyond this size, the flusher makes room by
+    // flushing the snapshots while blocking writers, if that is what it takes
+    static const File::SizeType max_log_size = 16 * 1024 * 1024;
+
+    util::File m_db_file;
+    util::File m_lock_file;
+    util::File m_log_file;
+    util::File::Map<SharedInfo> m_info_map;
+    InterprocessMutex m_writemutex;
+    InterprocessMutex m_controlmutex;
+    InterprocessMutex m_syncmutex;
+    std::chrono::milliseconds m_max_delay;
+    std::mutex m_mutex;
+    std::condition_variable m_stop_requested;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run() noexcept;
+
+    // Make all the snapshots that were committed so far durable, and then
+    // empty the changeset log if there is one
+    void flush();
+    void flush_snapshots();
+    void truncate_log();
+};
+
+
+namespace {
+
+// Each record of the changeset log consists of this header, followed by the
+// changeset, followed by padding up to a multiple of 8 bytes. The checksum is
+// calculated over the header, with the checksum set to zero, and the
+// changeset.
+struct ChangesetLogHeader {
+    uint64_t version;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+uint64_t changeset_log_checksum(const char* record, size_t size) noexcept
+{
+    return cityhash_64(reinterpret_cast<const unsigned char*>(record), size);
+}
+
+} // anonymous namespace
+
+
 namespace {
 
 #ifdef REALM_ASYNC_DAEMON
@@ -766,13 +966,32 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
     if (options.durability == Durability::Async)
         throw std::runtime_error("Async mode not yet supported on Windows, iOS and watchOS");
 #endif
+#ifdef _WIN32
+    if (options.durability == Durability::Deferred || options.durability == Durability::Logged)
+        throw std::runtime_error("Deferred durability not yet supported on Windows");
+#endif
+    if ((options.durability == Durability::Deferred || options.durability == Durability::Logged) &&
+        options.encryption_key)
+        throw std::runtime_error("Deferred durability not supported for encrypted Realm files");
+    // The changes of a write transaction are logged in the form of a changeset
+    if (options.durability == Durability::Logged && !m_group.get_replication())
+        throw LogicError(LogicError::no_history);
 
     m_db_path = path;
     m_coordination_dir = path + ".management";
     m_lockfile_path = path + ".lock";
     try_make_dir(m_coordination_dir);
     m_key = options.encryption_key;
+#ifdef _WIN32
+    // Windows does not flush the memory mappings of a file when the file itself is flushed
+    m_group_commits = false;
+#else
+    m_group_commits = options.group_commits && options.durability == Durability::Full && !options.encryption_key;
+#endif
     m_lockfile_prefix = m_coordination_dir + "/access_control";
+    m_max_retained_versions = options.max_retained_versions;
+    m_max_retained_bytes = options.max_retained_bytes;
+    m_retention_callback = options.retention_callback;
     SlabAlloc& alloc = m_group.m_alloc;
 
 #if REALM_METRICS
@@ -981,6 +1200,7 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
             m_balancemutex.set_shared_part(info->shared_balancemutex, m_lockfile_prefix, "balance");
 #endif
         m_controlmutex.set_shared_part(info->shared_controlmutex, m_lockfile_prefix, "control");
+        m_syncmutex.set_shared_part(info->shared_syncmutex, m_lockfile_prefix, "sync");
 
         // even though fields match wrt alignment and size, there may still be incompatibilities
         // between implementations, so lets ask one of the mutexes if it thinks it'll work.
@@ -1064,7 +1284,7 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
             bool file_format_ok = false;
             // In shared mode (Realm file opened via a SharedGroup instance) this
             // version of the core library is able to open Realms using file format
-            // versions from 2 to 9. Please see Group::get_file_format_version() for
+            // versions 2 to 9 and 11. Please see Group::get_file_format_version() for
             // information about the individual file format versions.
             switch (current_file_format_version) {
                 case 0:
@@ -1078,6 +1298,7 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
                 case 7:
                 case 8:
                 case 9:
+                case 11:
                     file_format_ok = true;
                     break;
             }
@@ -1163,6 +1384,8 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
                 info->number_of_versions = 1;
 
                 info->latest_version_number = version;
+                info->latest_top_ref = top_ref;
+                info->durable_version = version;
 
                 SharedInfo* r_info = m_reader_map.get_addr();
                 size_t file_size = alloc.get_baseline();
@@ -1321,9 +1544,28 @@ void SharedGroup::do_open(const std::string& path, bool no_create_file, bool is_
         }
         else {
             gf::set_file_format_version(m_group, current_file_format_version);
+        }
+
+        // The changes that were committed in a previous session, but which
+        // did not make it into the Realm file, must be applied again before
+        // anything else is committed
+        if (options.durability == Durability::Logged) {
+            m_log_file.open(m_db_path + ".wal", File::access_ReadWrite, File::create_Auto, 0); // Throws
+            replay_changeset_log(); // Throws
+        }
+
+        if (current_file_format_version != 0) {
             upgrade_file_format(options.allow_file_format_upgrade, target_file_format_version,
                                 stored_hist_schema_version, openers_hist_schema_version); // Throws
         }
+
+        // With deferred durability, committed snapshots are flushed by a
+        // thread that is shared by the process
+        if (options.durability == Durability::Deferred || options.durability == Durability::Logged) {
+            bool changeset_log = (options.durability == Durability::Logged);
+            m_flusher = BackgroundFlusher::get(m_db_path, m_lockfile_path, m_lockfile_prefix,
+                                               options.max_flush_delay, changeset_log); // Throws
+        }
     }
     catch (...) {
         close();
@@ -1419,6 +1661,44 @@ uint_fast64_t SharedGroup::get_number_of_versions()
     return info->number_of_versions;
 }
 
+std::vector<SharedGroup::PinnedVersion> SharedGroup::get_pinned_versions()
+{
+    REALM_ASSERT(is_attached());
+
+    // The live entries of the ringbuffer only change in write transactions
+    std::unique_lock<InterprocessMutex> lock(m_writemutex, std::defer_lock);
+    if (m_transact_stage != transact_Writing)
+        lock.lock(); // Throws
+
+    SharedInfo* r_info = m_reader_map.get_addr();
+    if (grow_reader_mapping(r_info->readers.get_num_entries())) // Throws
+        r_info = m_reader_map.get_addr();
+
+    std::vector<PinnedVersion> versions;
+    uint64_t now = get_reader_clock();
+    r_info->readers.for_each_live([&](const Ringbuffer::ReadCount& r) {
+        uint64_t owner_pid = 0;
+        uint64_t bound_at = 0;
+        uint_fast64_t num_readers = r.get_readers(owner_pid, bound_at);
+        if (num_readers == 0)
+            return;
+        // The time is recorded after the count is incremented
+        std::chrono::milliseconds age(bound_at != 0 && bound_at < now ? now - bound_at : 0);
+        versions.push_back(PinnedVersion{r.version, num_readers, owner_pid, age}); // Throws
+    });
+    return versions;
+}
+
+void SharedGroup::check_retention()
+{
+    bool exceeded = ((m_max_retained_versions != 0 && m_num_retained_versions > m_max_retained_versions) ||
+                     (m_max_retained_bytes != 0 && m_num_retained_bytes > m_max_retained_bytes));
+    if (!exceeded || !m_retention_callback || m_oldest_retained_version == m_reported_retained_version)
+        return;
+    m_reported_retained_version = m_oldest_retained_version;
+    m_retention_callback(m_oldest_retained_version, m_num_retained_versions, m_num_retained_bytes); // Throws
+}
+
 SharedGroup::~SharedGroup() noexcept
 {
     close();
@@ -1426,6 +1706,12 @@ SharedGroup::~SharedGroup() noexcept
 
 void SharedGroup::close() noexcept
 {
+    // When the last SharedGroup of the process lets go of the flusher, it
+    // flushes what is left before the session can end. It may need the write
+    // lock to empty the changeset log.
+    if (m_transact_stage == transact_Writing)
+        rollback();
+    m_flusher.reset();
     close_internal(std::unique_lock<InterprocessMutex>(m_controlmutex, std::defer_lock));
 }
 
@@ -1498,6 +1784,7 @@ void SharedGroup::close_internal(std::unique_lock<InterprocessMutex> lock) noexc
     m_file.unlock();
     // info->~SharedInfo(); // DO NOT Call destructor
     m_file.close();
+    m_log_file.close();
 }
 
 bool SharedGroup::has_changed()
@@ -1768,12 +2055,15 @@ void SharedGroup::release_read_lock(ReadLockInfo& read_lock) noexcept
     grow_reader_mapping(read_lock.m_reader_idx);
     SharedInfo* r_info = m_reader_map.get_addr();
     const Ringbuffer::ReadCount& r = r_info->readers.get(read_lock.m_reader_idx);
-    atomic_double_dec(r.count); // <-- most of the exec time spent here
+    r.unlock(read_lock.m_reader_shard); // <-- most of the exec time spent here
 }
 
 
-void SharedGroup::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
+void SharedGroup::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id, bool pinned)
 {
+    // A pinned version is released through nothing but its VersionID, so it
+    // must be registered in a shard that does not depend on the thread
+    read_lock.m_reader_shard = (pinned ? 0 : get_reader_shard());
     if (version_id.version == std::numeric_limits<version_type>::max()) {
         for (;;) {
             SharedInfo* r_info = m_reader_map.get_addr();
@@ -1786,7 +2076,7 @@ void SharedGroup::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
             const Ringbuffer::ReadCount& r = r_info->readers.get(read_lock.m_reader_idx);
             // if the entry is stale and has been cleared by the cleanup process,
             // we need to start all over again. This is extremely unlikely, but possible.
-            if (!atomic_double_inc_if_even(r.count)) // <-- most of the exec time spent here!
+            if (!r.try_lock(read_lock.m_reader_shard)) // <-- most of the exec time spent here!
                 continue;
             read_lock.m_version = r.version;
             read_lock.m_top_ref = to_size_t(r.current_top);
@@ -1807,7 +2097,7 @@ void SharedGroup::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
 
         // if the entry is stale and has been cleared by the cleanup process,
         // the requested version is no longer available
-        while (!atomic_double_inc_if_even(r.count)) { // <-- most of the exec time spent here!
+        while (!r.try_lock(read_lock.m_reader_shard)) { // <-- most of the exec time spent here!
             // we failed to lock the version. This could be because the version
             // is being cleaned up, but also because the cleanup is probing for access
             // to it. If it's being probed, the tail ptr of the ringbuffer will point
@@ -1819,7 +2109,7 @@ void SharedGroup::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
         // we managed to lock an entry in the ringbuffer, but it may be so old that
         // the version doesn't match the specific request. In that case we must release and fail
         if (r.version != version_id.version) {
-            atomic_double_dec(r.count); // <-- release
+            r.unlock(read_lock.m_reader_shard); // <-- release
             throw BadVersion();
         }
         read_lock.m_version = r.version;
@@ -1948,6 +2238,14 @@ SharedGroup::version_type SharedGroup::commit()
     do_end_read();
     m_read_lock = lock_after_commit;
     set_transact_stage(transact_Ready);
+
+    // With group commits, the new snapshot is flushed once the write mutex is
+    // released, so that the next writer can proceed in the meantime
+    if (m_group_commits)
+        make_durable(new_version); // Throws
+
+    check_retention(); // Throws
+
     return new_version;
 }
 
@@ -1981,7 +2279,8 @@ SharedGroup::VersionID SharedGroup::pin_version()
     VersionID version_id(m_read_lock.m_version, m_read_lock.m_reader_idx);
 
     ReadLockInfo read_lock;
-    grab_read_lock(read_lock, version_id); // Throws
+    bool pinned = true;
+    grab_read_lock(read_lock, version_id, pinned); // Throws
 
     return version_id;
 }
@@ -1990,6 +2289,7 @@ void SharedGroup::unpin_version(VersionID token)
 {
     ReadLockInfo read_lock;
     read_lock.m_reader_idx = token.index;
+    read_lock.m_reader_shard = 0;
 
     release_read_lock(read_lock);
 }
@@ -2151,6 +2451,9 @@ Replication::version_type SharedGroup::do_commit()
     version_type current_version = r_info->get_current_version_unchecked();
     version_type new_version = current_version + 1;
     if (Replication* repl = m_group.get_replication()) {
+        if (m_log_file.is_attached() && !m_replaying_log)
+            prepare_log_record(); // Throws
+
         // If Replication::prepare_commit() fails, then the entire transaction
         // fails. The application then has the option of terminating the
         // transaction with a call to SharedGroup::rollback(), which in turn
@@ -2199,6 +2502,11 @@ SharedGroup::version_type SharedGroup::commit_and_continue_as_read()
 
     set_transact_stage(transact_Reading);
 
+    if (m_group_commits)
+        make_durable(version); // Throws
+
+    check_retention(); // Throws
+
     return version;
 }
 
@@ -2240,16 +2548,17 @@ SharedGroup::version_type SharedGroup::get_version_of_latest_snapshot()
             index = r_info->readers.last();
         } while (grow_reader_mapping(index)); // throws
 
-        // now (double) increment the read count so that no-one cleans up the entry
+        // now increment the read count so that no-one cleans up the entry
         // while we read it.
         const Ringbuffer::ReadCount& r = r_info->readers.get(index);
-        if (!atomic_double_inc_if_even(r.count)) {
+        uint_fast32_t shard = get_reader_shard();
+        if (!r.try_lock(shard)) {
 
             continue;
         }
         version_type version = r.version;
         // release the entry again:
-        atomic_double_dec(r.count);
+        r.unlock(shard);
         return version;
     }
 }
@@ -2288,18 +2597,55 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
 #if REALM_METRICS
     m_group.update_num_objects();
 #endif // REALM_METRICS
+    m_group.update_derived_table_data(); // Throws
     // info->readers.dump();
+    // In Durability::Full, Deferred and Logged mode, the space that was in use by the snapshot
+    // selected by the header of the file, or by any later snapshot, must not be
+    // reused until a later snapshot is durable, as the selected snapshot must
+    // survive a crash. With group commits and deferred durability, the
+    // selected snapshot can be older than the oldest bound one.
+    uint_fast64_t oldest_retained_version = oldest_version;
+    Durability durability = Durability(info->durability);
+    if (durability == Durability::Full || durability == Durability::Deferred || durability == Durability::Logged)
+        oldest_retained_version = std::min<uint_fast64_t>(oldest_version, info->durable_version);
+
     GroupWriter out(m_group); // Throws
-    out.set_versions(new_version, oldest_version);
+    out.set_versions(new_version, oldest_retained_version);
     // Recursively write all changed arrays to end of file
     ref_type new_top_ref = out.write_group(); // Throws
     m_free_space = out.get_free_space_size();
     m_used_space = out.get_file_size() - m_free_space;
+    m_oldest_retained_version = oldest_retained_version;
+    m_num_retained_versions = new_version - oldest_retained_version + 1;
+    m_num_retained_bytes = out.get_locked_space_size();
     // std::cout << "Writing version " << new_version << ", Topptr " << new_top_ref
     //     << " Read lock at version " << oldest_version << std::endl;
     switch (Durability(info->durability)) {
         case Durability::Full:
-            out.commit(new_top_ref); // Throws
+            // With group commits, the new snapshot is made durable by
+            // make_durable() once the write mutex is released
+            if (!m_group_commits) {
+                std::lock_guard<InterprocessMutex> lock(m_syncmutex); // Throws
+                if (info->durable_version == m_read_lock.m_version) {
+                    out.commit(new_top_ref); // Throws
+                }
+                else {
+                    // Earlier snapshots by writers using group commits are not
+                    // yet flushed, and the new snapshot may refer to them
+                    GroupWriter::commit_all(m_group.m_alloc.get_file(), m_group.get_file_format_version(),
+                                            new_top_ref); // Throws
+                }
+                info->durable_version = new_version;
+            }
+            break;
+        case Durability::Deferred:
+            // Made durable by the background flusher, or by wait_for_durable()
+            break;
+        case Durability::Logged:
+            // The changes are durable once they are in the changeset log. The
+            // snapshot is flushed to the Realm file by the background flusher.
+            if (!m_replaying_log)
+                append_log_record(new_version); // Throws
             break;
         case Durability::MemOnly:
         case Durability::Async:
@@ -2342,11 +2688,324 @@ void SharedGroup::low_level_commit(uint_fast64_t new_version)
         std::lock_guard<InterprocessMutex> lock(m_controlmutex);
         info->number_of_versions = new_version - oldest_version + 1;
         info->latest_version_number = new_version;
+        info->latest_top_ref = new_top_ref;
 
         m_new_commit_available.notify_all();
     }
 }
 
+SharedGroup::BackgroundFlusher::BackgroundFlusher(const std::string& db_path, const std::string& lockfile_path,
+                                                  const std::string& lockfile_prefix,
+                                                  std::chrono::milliseconds max_delay, bool changeset_log)
+    : m_max_delay(max_delay)
+{
+    m_db_file.open(db_path, File::access_ReadWrite, File::create_Never, 0);           // Throws
+    m_lock_file.open(lockfile_path, File::access_ReadWrite, File::create_Never, 0);   // Throws
+    if (changeset_log)
+        m_log_file.open(db_path + ".wal", File::access_ReadWrite, File::create_Never, 0); // Throws
+    m_info_map.map(m_lock_file, File::access_ReadWrite, sizeof(SharedInfo), File::map_NoSync); // Throws
+    SharedInfo* info = m_info_map.get_addr();
+    m_writemutex.set_shared_part(info->shared_writemutex, lockfile_prefix, "write");
+    m_controlmutex.set_shared_part(info->shared_controlmutex, lockfile_prefix, "control");
+    m_syncmutex.set_shared_part(info->shared_syncmutex, lockfile_prefix, "sync");
+    m_thread = std::thread([this] { run(); }); // Throws
+}
+
+SharedGroup::BackgroundFlusher::~BackgroundFlusher() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_stop_requested.notify_one();
+    m_thread.join();
+
+    // Commits that were made during the last round must not be left behind
+    try {
+        flush(); // Throws
+    }
+    catch (...) {
+        // Nothing can be done about it at this point
+    }
+}
+
+std::shared_ptr<SharedGroup::BackgroundFlusher>
+SharedGroup::BackgroundFlusher::get(const std::string& db_path, const std::string& lockfile_path,
+                                    const std::string& lockfile_prefix, std::chrono::milliseconds max_delay,
+                                    bool changeset_log)
+{
+    static std::mutex flushers_mutex;
+    static std::map<std::string, std::weak_ptr<BackgroundFlusher>> flushers;
+
+    std::lock_guard<std::mutex> lock(flushers_mutex);
+    std::weak_ptr<BackgroundFlusher>& entry = flushers[db_path]; // Throws
+    std::shared_ptr<BackgroundFlusher> flusher = entry.lock();
+    if (!flusher) {
+        flusher = std::make_shared<BackgroundFlusher>(db_path, lockfile_path, lockfile_prefix, max_delay,
+                                                      changeset_log); // Throws
+        entry = flusher;
+    }
+    return flusher;
+}
+
+void SharedGroup::BackgroundFlusher::run() noexcept
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_stop_requested.wait_for(lock, m_max_delay, [this] { return m_stop; });
+        if (m_stop)
+            return;
+        lock.unlock();
+        try {
+            flush(); // Throws
+        }
+        catch (...) {
+            // Retried in the next round. If the failure persists, it is
+            // reported by wait_for_durable(), which flushes by itself.
+        }
+        lock.lock();
+    }
+}
+
+void SharedGroup::BackgroundFlusher::flush()
+{
+    flush_snapshots(); // Throws
+    if (m_log_file.is_attached())
+        truncate_log(); // Throws
+}
+
+void SharedGroup::BackgroundFlusher::flush_snapshots()
+{
+    SharedInfo* info = m_info_map.get_addr();
+    uint_fast64_t version;
+    ref_type top_ref;
+    {
+        std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
+        version = info->latest_version_number;
+        top_ref = ref_type(info->latest_top_ref);
+    }
+    if (info->durable_version >= version)
+        return;
+
+    // The space used by snapshots later than the durable one is not reused by
+    // writers, so the selected snapshot is intact, even if it is no longer the
+    // latest one by now. See low_level_commit().
+    std::lock_guard<InterprocessMutex> lock(m_syncmutex); // Throws
+    if (info->durable_version >= version)
+        return;
+    GroupWriter::commit_all(m_db_file, info->file_format_version, top_ref); // Throws
+    info->durable_version = version;
+}
+
+void SharedGroup::BackgroundFlusher::truncate_log()
+{
+    File::SizeType size = m_log_file.get_size(); // Throws
+    if (size == 0)
+        return;
+
+    // Records can only be removed while no writer can append one. Writers are
+    // only made to wait when the log has grown large.
+    bool log_is_large = (size >= max_log_size);
+    std::unique_lock<InterprocessMutex> lock(m_writemutex, std::defer_lock);
+    if (log_is_large) {
+        lock.lock(); // Throws
+    }
+    else if (!lock.try_lock()) {
+        return;
+    }
+
+    // The log is still needed for the snapshots that are not yet durable
+    SharedInfo* info = m_info_map.get_addr();
+    if (info->durable_version < info->latest_version_number) {
+        if (!log_is_large)
+            return;
+        flush_snapshots(); // Throws
+    }
+    m_log_file.resize(0); // Throws
+    info->log_size = 0;
+}
+
+void SharedGroup::wait_for_durable(version_type version)
+{
+    SharedInfo* info = m_file_map.get_addr();
+    Durability durability = Durability(info->durability);
+    if (durability == Durability::Full || durability == Durability::Deferred)
+        make_durable(version); // Throws
+}
+
+void SharedGroup::make_durable(version_type version)
+{
+    SharedInfo* info = m_file_map.get_addr();
+    if (info->durable_version >= version)
+        return;
+
+    std::lock_guard<InterprocessMutex> lock(m_syncmutex); // Throws
+
+    // While this thread waited for the lock, the version may have been made
+    // durable along with a later one
+    if (info->durable_version >= version)
+        return;
+
+    // Make all the snapshots that were committed so far durable with a single
+    // flush
+    ReadLockInfo read_lock;
+    grab_read_lock(read_lock, VersionID()); // Throws
+    ReadLockUnlockGuard g(*this, read_lock);
+    GroupWriter::commit_all(m_group.m_alloc.get_file(), m_group.get_file_format_version(),
+                            read_lock.m_top_ref); // Throws
+    info->durable_version = read_lock.m_version;
+}
+
+void SharedGroup::prepare_log_record()
+{
+    _impl::History* hist = get_history(); // Throws
+    if (!hist)
+        throw LogicError(LogicError::no_history);
+    BinaryData changes = hist->get_uncommitted_changes();
+
+    // The version and the checksum are filled in by append_log_record()
+    ChangesetLogHeader header{0, changes.size(), 0};
+    static const char padding[8] = {};
+    m_log_record.clear();
+    m_log_record.append(reinterpret_cast<const char*>(&header), sizeof header); // Throws
+    m_log_record.append(changes.data(), changes.size());                        // Throws
+    m_log_record.append(padding, (8 - changes.size() % 8) % 8);                 // Throws
+}
+
+void SharedGroup::append_log_record(version_type version)
+{
+    char* record = m_log_record.data();
+    ChangesetLogHeader header;
+    std::memcpy(&header, record, sizeof header);
+    header.version = version;
+    std::memcpy(record, &header, sizeof header);
+    header.checksum = changeset_log_checksum(record, sizeof header + size_t(header.size));
+    std::memcpy(record, &header, sizeof header);
+
+    // A record that failed to be appended must not be left behind, as the
+    // version is produced again by the next commit, and replay_changeset_log()
+    // stops at the first incomplete record. What is left of a record after the
+    // end of the last complete one, because the writer was killed or could not
+    // remove it, is therefore removed first.
+    SharedInfo* info = m_file_map.get_addr();
+    File::SizeType end = File::SizeType(info->log_size);
+    try {
+        if (m_log_file.get_size() != end)              // Throws
+            m_log_file.resize(end);                    // Throws
+        m_log_file.seek(end);                          // Throws
+        m_log_file.write(record, m_log_record.size()); // Throws
+        if (!get_disable_sync_to_disk())
+            m_log_file.sync(); // Throws
+    }
+    catch (...) {
+        try {
+            m_log_file.resize(end); // Throws
+        }
+        catch (...) {
+        }
+        throw;
+    }
+    info->log_size = uint64_t(end) + m_log_record.size();
+}
+
+void SharedGroup::replay_changeset_log()
+{
+    SharedInfo* info = m_file_map.get_addr();
+    if (info->log_replayed)
+        return;
+
+    // Every participant of the session tries to replay the log before it
+    // returns from open(), so that no changes can be committed, and no
+    // snapshots can be read, before it is done. Each of the changesets is
+    // applied in a write transaction of its own, so that the version of the
+    // new snapshot is the one that the changeset produced originally, and
+    // whichever participant gets the write lock applies the next one.
+    std::unique_ptr<char[]> log;
+    std::vector<ChangesetLogHeader> headers;
+    std::vector<const char*> changesets;
+    bool log_read = false;
+    for (;;) {
+        begin_write(); // Throws
+        try {
+            if (info->log_replayed) {
+                rollback();
+                return;
+            }
+
+            if (!log_read) {
+                // A record that was not completely written when the session
+                // ended, is the last one, and is ignored
+                size_t size = size_t(m_log_file.get_size()); // Throws
+                log.reset(new char[size]);                   // Throws
+                m_log_file.seek(0);                          // Throws
+                size = m_log_file.read(log.get(), size);     // Throws
+                size_t pos = 0;
+                ChangesetLogHeader header;
+                while (size - pos >= sizeof header) {
+                    char* record = log.get() + pos;
+                    std::memcpy(&header, record, sizeof header);
+                    if (header.size > size - pos - sizeof header)
+                        break;
+                    uint64_t checksum = header.checksum;
+                    header.checksum = 0;
+                    std::memcpy(record, &header, sizeof header);
+                    if (changeset_log_checksum(record, sizeof header + size_t(header.size)) != checksum)
+                        break;
+                    // A record of a commit that failed, and could not be removed,
+                    // is followed by one of the same version
+                    while (!headers.empty() && headers.back().version >= header.version) {
+                        headers.pop_back();
+                        changesets.pop_back();
+                    }
+                    headers.push_back(header);                     // Throws
+                    changesets.push_back(record + sizeof header); // Throws
+                    pos += sizeof header + size_t(header.size);
+                    pos += (8 - pos % 8) % 8;
+                }
+                log_read = true;
+            }
+
+            version_type version = m_read_lock.m_version;
+            size_t i = 0;
+            while (i < headers.size() && headers[i].version <= version)
+                ++i;
+
+            if (i == headers.size()) {
+                // All the changes are applied again. Once they are durable in
+                // the Realm file, the log is no longer needed.
+                {
+                    std::lock_guard<InterprocessMutex> lock(m_syncmutex); // Throws
+                    if (info->durable_version < version) {
+                        GroupWriter::commit_all(m_group.m_alloc.get_file(), m_group.get_file_format_version(),
+                                                m_read_lock.m_top_ref); // Throws
+                        info->durable_version = version;
+                    }
+                }
+                m_log_file.resize(0); // Throws
+                info->log_size = 0;
+                info->log_replayed = 1;
+                rollback();
+                return;
+            }
+
+            if (headers[i].version != version + 1)
+                throw std::runtime_error("Changeset log does not match the Realm file " + m_db_path);
+
+            _impl::SimpleNoCopyInputStream in(changesets[i], size_t(headers[i].size));
+            Replication::apply_changeset(in, m_group); // Throws
+            m_replaying_log = true;
+            commit(); // Throws
+            m_replaying_log = false;
+        }
+        catch (...) {
+            m_replaying_log = false;
+            if (m_transact_stage == transact_Writing)
+                rollback();
+            throw;
+        }
+    }
+}
+
 #ifdef REALM_DEBUG
 void SharedGroup::reserve(size_t size)
 {
@@ -2428,5 +3087,8 @@ std::vector<std::pair<std::string, bool>> SharedGroup::get_core_files(const std:
     std::vector<std::pair<std::string, bool>> files;
     files.emplace_back(std::make_pair(realm_path, false));
     files.emplace_back(std::make_pair(realm_path + ".management", true));
+    // The changeset log only exists if the file was opened with Durability::Logged
+    if (File::exists(realm_path + ".wal"))
+        files.emplace_back(std::make_pair(realm_path + ".wal", false));
     return files;
 }
@@ -22,6 +22,7 @@
 #include <functional>
 #include <limits>
 #include <realm/util/features.h>
+#include <realm/util/buffer.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/util/interprocess_condvar.hpp>
 #include <realm/util/interprocess_mutex.hpp>
@@ -363,6 +364,16 @@ public:
     // with the SharedGroup for further operations.
     bool try_begin_write(Group*& group);
     version_type commit();
+
+    /// Wait until the snapshot of the specified version, which must have been
+    /// committed, is flushed to stable storage along with all earlier ones, so
+    /// that it survives a crash. If the flush is still pending, as it can be
+    /// with Durability::Deferred, the calling thread performs it, and it covers
+    /// every snapshot committed so far. With Durability::Full, snapshots are
+    /// durable by the time commit() returns, and so are the changes of each
+    /// commit with Durability::Logged. Has no effect with Durability::MemOnly
+    /// and Durability::Async.
+    void wait_for_durable(version_type version);
     void rollback() noexcept;
     // report statistics of last commit done on THIS shared group.
     // The free space reported is what can be expected to be freed
@@ -391,6 +402,27 @@ public:
     /// a read transaction will not immediately release any versions.
     uint_fast64_t get_number_of_versions();
 
+    /// A version that is bound by at least one read transaction, or pinned by
+    /// pin_version(), as reported by get_pinned_versions().
+    struct PinnedVersion {
+        version_type version;
+        /// The number of read transactions and pins that are bound to it
+        uint_fast64_t num_readers;
+        /// The process ID of the reader that has been bound to it the longest,
+        /// and for how long. Readers on different threads are told apart, but
+        /// when more than 16 threads read, some of them share the record of the
+        /// first one among them.
+        uint_fast64_t owner_pid;
+        std::chrono::milliseconds age;
+    };
+
+    /// Get the versions of the Realm file that are bound by readers in any
+    /// process, oldest first. The space that is freed by commits after the
+    /// oldest of them cannot be reused until its readers let go of it. See
+    /// also SharedGroupOptions::max_retained_versions. Waits for write
+    /// transactions of other SharedGroups to finish.
+    std::vector<PinnedVersion> get_pinned_versions();
+
     /// Compact the database file.
     /// - The method will throw if called inside a transaction.
     /// - The method will throw if called in unattached state.
@@ -560,10 +592,12 @@ private:
     struct ReadLockInfo {
         uint_fast64_t m_version = std::numeric_limits<version_type>::max();
         uint_fast32_t m_reader_idx = 0;
+        uint_fast32_t m_reader_shard = 0;
         ref_type m_top_ref = 0;
         size_t m_file_size = 0;
     };
     class ReadLockUnlockGuard;
+    class BackgroundFlusher;
 
     // Member variables
     size_t m_free_space = 0;
@@ -586,6 +620,12 @@ private:
     util::InterprocessMutex m_balancemutex;
 #endif
     util::InterprocessMutex m_controlmutex;
+    util::InterprocessMutex m_syncmutex;
+    bool m_group_commits;
+    std::shared_ptr<BackgroundFlusher> m_flusher;
+    util::File m_log_file;
+    util::AppendBuffer<char> m_log_record;
+    bool m_replaying_log = false;
 #ifdef REALM_ASYNC_DAEMON
     util::InterprocessCondVar m_room_to_write;
     util::InterprocessCondVar m_work_to_do;
@@ -594,6 +634,15 @@ private:
     util::InterprocessCondVar m_new_commit_available;
     util::InterprocessCondVar m_pick_next_writer;
     std::function<void(int, int)> m_upgrade_callback;
+    uint_fast64_t m_max_retained_versions = 0;
+    uint_fast64_t m_max_retained_bytes = 0;
+    std::function<void(uint64_t, uint64_t, uint64_t)> m_retention_callback;
+    // What the latest commit through this SharedGroup left behind, and the
+    // oldest retained version that the retention callback was called for
+    uint_fast64_t m_oldest_retained_version = 0;
+    uint_fast64_t m_num_retained_versions = 0;
+    uint_fast64_t m_num_retained_bytes = 0;
+    uint_fast64_t m_reported_retained_version = 0;
 
 #if REALM_METRICS
     std::shared_ptr<metrics::Metrics> m_metrics;
@@ -622,11 +671,15 @@ private:
     /// As a side effect update memory mapping to ensure that the ringbuffer
     /// entries referenced in the readlock info is accessible.
     ///
+    /// The read lock is registered in the reader shard of the calling thread,
+    /// unless `pinned` is true, in which case it is registered in the first
+    /// shard, where unpin_version() expects it.
+    ///
     /// FIXME: It needs to be made more clear exactly under which conditions
     /// this function fails. Also, why is it useful to promise anything about
     /// detection of bad versions? Can we really promise enough to make such a
     /// promise useful to the caller?
-    void grab_read_lock(ReadLockInfo&, VersionID);
+    void grab_read_lock(ReadLockInfo&, VersionID, bool pinned = false);
 
     // Release a specific read lock. The read lock MUST have been obtained by a
     // call to grab_read_lock().
@@ -657,6 +710,27 @@ private:
     // mutex.
     void low_level_commit(uint_fast64_t new_version);
 
+    // Used with group commits, after the write mutex is released. Returns when
+    // the specified version, or a later one, is selected by the header of the
+    // Realm file and flushed to stable storage.
+    void make_durable(version_type version);
+
+    // Used with Durability::Logged. prepare_log_record() must be called before
+    // Replication::prepare_commit(), and append_log_record() by
+    // low_level_commit() before the new snapshot is made available.
+    void prepare_log_record();
+    void append_log_record(version_type version);
+
+    // Call the retention callback if the latest commit exceeded the limits of
+    // SharedGroupOptions::max_retained_versions or max_retained_bytes. Must be
+    // called after the write lock is released.
+    void check_retention();
+
+    // Apply the changes that are in the changeset log, but not in the latest
+    // snapshot, again. This happens when the previous session ended before
+    // the snapshots were flushed to the Realm file.
+    void replay_changeset_log();
+
     void do_async_commits();
 
     /// Upgrade file format and/or history schema
@@ -19,6 +19,7 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <chrono>
 #include <functional>
 #include <string>
 
@@ -31,7 +32,9 @@ struct SharedGroupOptions {
     enum class Durability : uint16_t {
         Full,
         MemOnly,
-        Async ///< Not yet supported on windows.
+        Async,    ///< Not yet supported on windows.
+        Deferred, ///< Not yet supported on windows. See max_flush_delay.
+        Logged    ///< Not yet supported on windows. See max_flush_delay.
     };
 
     explicit SharedGroupOptions(Durability level = Durability::Full, const char* key = nullptr,
@@ -45,7 +48,10 @@ struct SharedGroupOptions {
         , upgrade_callback(file_upgrade_callback)
         , temp_dir(temp_directory)
         , enable_metrics(track_metrics)
-
+        , group_commits(false)
+        , max_flush_delay(100)
+        , max_retained_versions(0)
+        , max_retained_bytes(0)
     {
     }
 
@@ -56,6 +62,10 @@ struct SharedGroupOptions {
         , upgrade_callback(std::function<void(int, int)>())
         , temp_dir(sys_tmp_dir)
         , enable_metrics(false)
+        , group_commits(false)
+        , max_flush_delay(100)
+        , max_retained_versions(0)
+        , max_retained_bytes(0)
     {
     }
 
@@ -95,6 +105,49 @@ struct SharedGroupOptions {
     /// A prerequisite is compiling with REALM_METRICS=ON.
     bool enable_metrics;
 
+    /// With Durability::Full, lets the commits of write transactions that
+    /// finish close together, in this and in other processes, be flushed to
+    /// stable storage together. The flush happens after the write lock is
+    /// released, so that the next writer can proceed in the meantime, but
+    /// commit() still does not return until the new snapshot is durable.
+    /// SharedGroups with and without group commits can be used together.
+    /// Ignored for encrypted Realm files and on Windows.
+    bool group_commits;
+
+    /// With Durability::Deferred, commit() returns as soon as the new snapshot
+    /// is available to readers, and a background thread flushes the snapshots
+    /// committed so far to stable storage together, about this long after they
+    /// are committed at the latest. The thread is shared by the SharedGroups of
+    /// the process that have the Realm file open, and uses the delay of the
+    /// first of them. See also SharedGroup::wait_for_durable(). Deferred
+    /// durability is not supported for encrypted Realm files.
+    ///
+    /// With Durability::Logged, the changes of each write transaction are
+    /// appended to a changeset log (the Realm file path with ".wal" appended),
+    /// and commit() returns once that is flushed to stable storage. The
+    /// snapshots are flushed to the Realm file in the background as with
+    /// Durability::Deferred, after which the log is emptied. When the session
+    /// is restarted after a crash, the changes that are only in the log are
+    /// applied again. This requires a history (see make_in_realm_history()),
+    /// and is not supported for encrypted Realm files.
+    std::chrono::milliseconds max_flush_delay;
+
+    /// A reader that stays bound to an old version prevents the space that is
+    /// freed by later commits from being reused, so the Realm file keeps
+    /// growing for as long as it is bound. When a commit through this
+    /// SharedGroup leaves more than `max_retained_versions` versions in the
+    /// file, or more than `max_retained_bytes` bytes of freed space that cannot
+    /// be reused yet, `retention_callback` is called after the write lock is
+    /// released. Its parameters are the oldest retained version, the number of
+    /// retained versions, and the number of bytes that cannot be reused.
+    /// Zero means no limit. The callback is called once for each oldest
+    /// retained version, and may use SharedGroup::get_pinned_versions() to
+    /// find the readers that hold on to it. If the callback throws, the
+    /// exception propagates out of the commit, which has succeeded anyway.
+    uint64_t max_retained_versions;
+    uint64_t max_retained_bytes;
+    std::function<void(uint64_t, uint64_t, uint64_t)> retention_callback;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating SharedGroupOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
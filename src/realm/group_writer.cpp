@@ -161,8 +161,10 @@ GroupWriter::GroupWriter(Group& group)
     , m_free_versions(m_alloc)
     , m_current_version(0)
     , m_free_space_size(0)
+    , m_locked_space_size(0)
 {
     m_map_windows.reserve(num_map_windows);
+    compress_leaves = m_group.get_file_format_version() >= 11;
 #if REALM_IOS
     m_window_alignment = 1 * 1024 * 1024;  // 1M
 #else
@@ -534,6 +536,7 @@ void GroupWriter::read_in_freelist()
                 // Entries that are freed in still alive versions are not candidates for merge or allocation
                 if (version >= limit_version) {
                     m_not_free_in_file.emplace_back(ref, size, version);
+                    m_locked_space_size += size;
                     continue;
                 }
             }
@@ -871,6 +874,50 @@ void GroupWriter::commit(ref_type new_top_ref)
 }
 
 
+void GroupWriter::commit_all(File& file, int file_format_version, ref_type new_top_ref)
+{
+    File::Map<SlabAlloc::Header> map(file, File::access_ReadWrite); // Throws
+    SlabAlloc::Header& file_header = *map.get_addr();
+
+    // See commit()
+    unsigned old_flags = file_header.m_flags;
+    unsigned new_flags = old_flags ^ SlabAlloc::flags_SelectBit;
+    int slot_selector = ((new_flags & SlabAlloc::flags_SelectBit) != 0 ? 1 : 0);
+
+    using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
+    REALM_ASSERT(!util::int_cast_has_overflow<type_1>(file_format_version));
+    file_header.m_top_ref[slot_selector] = new_top_ref;
+    file_header.m_file_format[slot_selector] = type_1(file_format_version);
+
+    // When running the test suite, device synchronization is disabled
+    bool disable_sync = get_disable_sync_to_disk();
+
+    // The snapshots may have been written through the memory mappings of other
+    // writers, also in other processes, so the whole file is flushed rather
+    // than a set of mappings. POSIX does not promise that fsync() writes back
+    // pages that were modified through a mapping, so the file is first
+    // flushed through mappings of its own, in chunks to limit the address
+    // space needed. Those share the pages of every other shared mapping of the
+    // file.
+    if (!disable_sync) {
+        const size_t chunk_size = 64 * 1024 * 1024; // 64M
+        size_t file_size = to_size_t(file.get_size()); // Throws
+        for (size_t offset = 0; offset < file_size; offset += chunk_size) {
+            size_t size = std::min(chunk_size, file_size - offset);
+            File::Map<char> chunk(file, offset, File::access_ReadWrite, size); // Throws
+            chunk.sync();                                                      // Throws
+        }
+        file.sync(); // Throws
+    }
+
+    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
+    file_header.m_flags = type_2(new_flags);
+
+    if (!disable_sync)
+        map.sync(); // Throws
+}
+
+
 #ifdef REALM_DEBUG
 
 void GroupWriter::dump()
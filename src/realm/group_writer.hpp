@@ -67,6 +67,14 @@ public:
     /// returned by write_group().
     void commit(ref_type new_top_ref);
 
+    /// Flush everything that was written to the file so far, by any
+    /// GroupWriter in any process, to physical medium, then write the new top
+    /// ref to the file header, then flush again. This makes several snapshots
+    /// durable at once, when they were written by write_group() without a
+    /// following call to commit(). It must not be used with encrypted files,
+    /// whose changes only reach the file when the writer flushes them.
+    static void commit_all(util::File&, int file_format_version, ref_type new_top_ref);
+
     size_t get_file_size() const noexcept;
 
     ref_type write_array(const char*, size_t, uint32_t) override;
@@ -80,6 +88,14 @@ public:
         return m_free_space_size;
     }
 
+    /// The size of the free space that cannot be reused yet, because it was
+    /// freed by a version that is newer than the oldest one still in use. Known
+    /// once write_group() has been called.
+    size_t get_locked_space_size()
+    {
+        return m_locked_space_size;
+    }
+
 private:
     class MapWindow;
     Group& m_group;
@@ -91,6 +107,7 @@ private:
     uint64_t m_readlock_version;
     size_t m_window_alignment;
     size_t m_free_space_size;
+    size_t m_locked_space_size;
 
     struct FreeSpaceEntry {
         FreeSpaceEntry(size_t r, size_t s, uint64_t v)
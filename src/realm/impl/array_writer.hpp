@@ -36,6 +36,10 @@ public:
     /// Returns the ref (position in the target stream) of the written copy of
     /// the specified array data.
     virtual ref_type write_array(const char* data, size_t size, uint32_t checksum) = 0;
+
+    /// Whether integer B+-tree leaves may be written in encoded form (see
+    /// Array::write()). This requires file format 11 or later.
+    bool compress_leaves = false;
 };
 
 } // namespace impl_
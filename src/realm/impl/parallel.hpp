@@ -0,0 +1,107 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_IMPL_PARALLEL_HPP
+#define REALM_IMPL_PARALLEL_HPP
+
+#include <exception>
+#include <functional>
+#include <system_error>
+#include <vector>
+
+#include <realm/column.hpp>
+#include <realm/column_string.hpp>
+#include <realm/util/thread.hpp>
+
+namespace realm {
+namespace _impl {
+
+/// Rows are only sorted, grouped or checked for duplicates on several threads
+/// when there are at least this many of them per thread, as starting a thread
+/// costs more than going through fewer rows.
+const size_t parallel_min_rows_per_thread = 10000;
+
+/// Calls `func(i)` for every `i` in [0, `n`), each on a thread of its own
+/// except for `i` = 0, which runs on the calling thread, and returns when all
+/// calls have returned. If a thread cannot be started, its call is made on
+/// the calling thread instead. If any of the calls throws, one of the
+/// exceptions is rethrown.
+template <class F>
+void run_in_parallel(size_t n, F func)
+{
+    std::exception_ptr error;
+    util::Mutex error_mutex;
+    auto run = [&](size_t i) noexcept {
+        try {
+            func(i); // Throws
+        }
+        catch (...) {
+            util::LockGuard lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    std::vector<util::Thread> threads(n - 1);
+    for (size_t i = 1; i < n; ++i) {
+        try {
+            threads[i - 1].start([&run, i] { run(i); }); // Throws
+        }
+        catch (std::system_error&) {
+            run(i);
+        }
+    }
+    run(0);
+    for (auto& thread : threads) {
+        if (thread.joinable())
+            thread.join();
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/// Combines the hash of a value with the hash of the values before it, for
+/// rows that are hashed by several columns.
+inline size_t combine_hash(size_t seed, size_t value) noexcept
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/// The hash of the value of a string column in the specified row.
+inline size_t hash_string(const ColumnBase& column, size_t row)
+{
+    return static_cast<const StringColumn&>(column).get(row).hash();
+}
+
+/// The hash of the value of a float or double column in the specified row.
+/// Null gets a hash of its own, 0, so that it does not collide with 0.
+template <class T>
+size_t hash_floating_point(const ColumnBase& column, size_t row)
+{
+    auto& col = static_cast<const Column<T>&>(column);
+    if (col.is_null(row))
+        return 0;
+    // 0 and -0 are equal, but have different representations
+    T value = col.get(row);
+    return value == 0 ? 1 : std::hash<T>()(value);
+}
+
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_IMPL_PARALLEL_HPP
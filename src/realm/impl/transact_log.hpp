@@ -81,6 +81,8 @@ enum Instruction {
     instr_LinkListClear = 38,   // Ramove all entries from a link list
     instr_LinkListSetAll = 39,  // Assign to link list entry
     instr_AddRowWithKey = 40,   // Insert a row with a given key
+    instr_AddRangeIndex = 41,    // Add a range index to a column
+    instr_RemoveRangeIndex = 42, // Remove a range index from a column
 };
 
 class TransactLogStream {
@@ -276,6 +278,14 @@ public:
     {
         return true;
     }
+    bool add_range_index(size_t)
+    {
+        return true;
+    }
+    bool remove_range_index(size_t)
+    {
+        return true;
+    }
     bool set_link_type(size_t, LinkType)
     {
         return true;
@@ -369,6 +379,8 @@ public:
     bool rename_column(size_t col_ndx, StringData new_name);
     bool add_search_index(size_t col_ndx);
     bool remove_search_index(size_t col_ndx);
+    bool add_range_index(size_t col_ndx);
+    bool remove_range_index(size_t col_ndx);
     bool set_link_type(size_t col_ndx, LinkType);
 
     // Must have linklist selected:
@@ -512,6 +524,8 @@ public:
     virtual void merge_rows(const Table*, size_t row_ndx, size_t new_row_ndx);
     virtual void add_search_index(const Descriptor&, size_t col_ndx);
     virtual void remove_search_index(const Descriptor&, size_t col_ndx);
+    virtual void add_range_index(const Table*, size_t col_ndx);
+    virtual void remove_range_index(const Table*, size_t col_ndx);
     virtual void set_link_type(const Table*, size_t col_ndx, LinkType);
     virtual void clear_table(const Table*, size_t prior_num_rows);
     virtual void optimize_table(const Table*);
@@ -1531,6 +1545,30 @@ inline void TransactLogConvenientEncoder::remove_search_index(const Descriptor&
     m_encoder.remove_search_index(col_ndx); // Throws
 }
 
+inline bool TransactLogEncoder::add_range_index(size_t col_ndx)
+{
+    append_simple_instr(instr_AddRangeIndex, col_ndx); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::add_range_index(const Table* t, size_t col_ndx)
+{
+    select_table(t);                    // Throws
+    m_encoder.add_range_index(col_ndx); // Throws
+}
+
+inline bool TransactLogEncoder::remove_range_index(size_t col_ndx)
+{
+    append_simple_instr(instr_RemoveRangeIndex, col_ndx); // Throws
+    return true;
+}
+
+inline void TransactLogConvenientEncoder::remove_range_index(const Table* t, size_t col_ndx)
+{
+    select_table(t);                       // Throws
+    m_encoder.remove_range_index(col_ndx); // Throws
+}
+
 inline bool TransactLogEncoder::set_link_type(size_t col_ndx, LinkType link_type)
 {
     append_simple_instr(instr_SetLinkType, col_ndx, int(link_type)); // Throws
@@ -2022,6 +2060,18 @@ void TransactLogParser::parse_one(InstructionHandler& handler)
                 parser_error();
             return;
         }
+        case instr_AddRangeIndex: {
+            size_t col_ndx = read_int<size_t>();   // Throws
+            if (!handler.add_range_index(col_ndx)) // Throws
+                parser_error();
+            return;
+        }
+        case instr_RemoveRangeIndex: {
+            size_t col_ndx = read_int<size_t>();      // Throws
+            if (!handler.remove_range_index(col_ndx)) // Throws
+                parser_error();
+            return;
+        }
         case instr_SetLinkType: {
             size_t col_ndx = read_int<size_t>(); // Throws
             int link_type = read_int<int>();     // Throws
@@ -2593,6 +2643,16 @@ public:
         return true; // No-op
     }
 
+    bool add_range_index(size_t)
+    {
+        return true; // No-op
+    }
+
+    bool remove_range_index(size_t)
+    {
+        return true; // No-op
+    }
+
     bool set_link_type(size_t, LinkType)
     {
         return true; // No-op
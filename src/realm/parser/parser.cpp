@@ -167,8 +167,14 @@ struct string_oper : seq< sor< contains, begins, ends, like>, star< blank >, opt
 // "=" is equality and since other operators can start with "=" we must check equal last
 struct symbolic_oper : sor< noteq, lteq, lt, gteq, gt, eq, in, between > {};
 
+// list of values eg: {1, 2, 3}
+struct begin_list : one< '{' > {};
+struct end_list : one< '}' > {};
+struct list_value : sor< dq_string, sq_string, timestamp, number, argument, true_value, false_value, null_value, base64 > {};
+struct value_list : seq< begin_list, pad< opt< list< list_value, one< ',' >, blank > >, blank >, end_list > {};
+
 // predicates
-struct comparison_pred : seq< expr, pad< sor< string_oper, symbolic_oper >, blank >, expr > {};
+struct comparison_pred : seq< expr, pad< sor< string_oper, symbolic_oper >, blank >, sor< value_list, expr > > {};
 
 // we need to alias the group tokens because these are also used in other expressions above and we have to match
 // the predicate group tokens without also matching () in other expressions.
@@ -236,6 +242,8 @@ struct ParserState
     bool negate_next = false;
     Predicate::Type next_type = Predicate::Type::And;
     Expression* last_expression = nullptr;
+    // The list that values are added to while parsing a list of values
+    Expression* list_expression = nullptr;
 
     void add_collection_aggregate_expression()
     {
@@ -253,6 +261,11 @@ struct ParserState
 
     void add_expression(Expression && exp)
     {
+        if (list_expression) {
+            list_expression->list->push_back(std::move(exp));
+            return;
+        }
+
         Predicate *current = last_predicate();
         if (current->type == Predicate::Type::Comparison && current->cmpr.expr[1].type == parser::Expression::Type::None) {
             current->cmpr.expr[1] = std::move(exp);
@@ -360,6 +373,29 @@ EXPRESSION_ACTION(null_value, Expression::Type::Null)
 EXPRESSION_ACTION(argument_index, Expression::Type::Argument)
 EXPRESSION_ACTION(base64, Expression::Type::Base64)
 
+template<> struct action< begin_list >
+{
+    template< typename Input >
+    static void apply(const Input&, ParserState& state)
+    {
+        DEBUG_PRINT_TOKEN("<begin_list>");
+        Expression exp(Expression::Type::List);
+        exp.list = std::make_shared<std::vector<Expression>>();
+        state.add_expression(std::move(exp));
+        state.list_expression = state.last_expression;
+    }
+};
+
+template<> struct action< end_list >
+{
+    template< typename Input >
+    static void apply(const Input&, ParserState& state)
+    {
+        DEBUG_PRINT_TOKEN("<end_list>");
+        state.list_expression = nullptr;
+    }
+};
+
 template<> struct action< timestamp >
 {
     template< typename Input >
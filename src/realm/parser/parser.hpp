@@ -32,13 +32,14 @@ struct Predicate;
 
 struct Expression
 {
-    enum class Type { None, Number, String, KeyPath, Argument, True, False, Null, Timestamp, Base64, SubQuery } type;
+    enum class Type { None, Number, String, KeyPath, Argument, True, False, Null, Timestamp, Base64, SubQuery, List } type;
     enum class KeyPathOp { None, Min, Max, Avg, Sum, Count, SizeString, SizeBinary, BacklinkCount } collection_op;
     std::string s;
     std::vector<std::string> time_inputs;
     std::string op_suffix;
     std::string subquery_path, subquery_var;
     std::shared_ptr<Predicate> subquery;
+    std::shared_ptr<std::vector<Expression>> list; // the values of a List, eg: {1, 2, 3}
     Expression(Type t = Type::None, std::string input = "") : type(t), collection_op(KeyPathOp::None), s(input) {}
     Expression(std::vector<std::string>&& timestamp) : type(Type::Timestamp), collection_op(KeyPathOp::None), time_inputs(timestamp) {}
     Expression(std::string prefix, KeyPathOp op, std::string suffix) : type(Type::KeyPath), collection_op(op), s(prefix), op_suffix(suffix) {}
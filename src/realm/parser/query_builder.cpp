@@ -681,11 +681,78 @@ bool is_property_operation(parser::Expression::Type type)
     return type == parser::Expression::Type::KeyPath || type == parser::Expression::Type::SubQuery;
 }
 
+void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &args, parser::KeyPathMapping& mapping);
+
+template <typename T>
+std::vector<T> get_list_values(Query& query, const std::vector<parser::Expression>& list, Arguments& args)
+{
+    std::vector<T> values;
+    for (const parser::Expression& value : list) {
+        values.push_back(ValueExpression(query, &args, &value).value_of_type_for_query<T>());
+    }
+    return values;
+}
+
+// "keypath IN {value, ...}" matches if the property is equal to any of the values in the list
+void add_list_comparison_to_query(Query &query, const Predicate &pred, Arguments &args, parser::KeyPathMapping& mapping)
+{
+    const Predicate::Comparison& cmpr = pred.cmpr;
+    realm_precondition(cmpr.op == Predicate::Operator::In, "A list of values can only follow the operator 'IN'");
+    realm_precondition(cmpr.expr[0].type == parser::Expression::Type::KeyPath,
+                       "The expression preceding a list of values must be a keypath");
+    const std::vector<parser::Expression>& values = *cmpr.expr[1].list;
+
+    ExpressionContainer lhs(query, cmpr.expr[0], args, mapping);
+    if (lhs.type == ExpressionContainer::ExpressionInternal::exp_Property
+        && lhs.get_property().link_chain.size() == 1
+        && cmpr.compare_type == Predicate::ComparisonType::Unspecified
+        && cmpr.option == Predicate::OperatorOption::None) {
+        // A property of the queried table is tested with a single set membership condition, unless a value is null
+        bool has_null = std::any_of(values.begin(), values.end(), [&](const parser::Expression& value) {
+            return ValueExpression(query, &args, &value).is_null();
+        });
+        size_t col_ndx = lhs.get_property().get_dest_ndx();
+        switch (has_null ? type_Mixed : lhs.get_property().get_dest_type()) {
+            case type_Int:
+                query.in(col_ndx, get_list_values<Int>(query, values, args));
+                return;
+            case type_String:
+                query.in(col_ndx, get_list_values<StringData>(query, values, args));
+                return;
+            case type_Timestamp:
+                query.in(col_ndx, get_list_values<Timestamp>(query, values, args));
+                return;
+            default:
+                break;
+        }
+    }
+
+    // Otherwise the property is compared to each of the values in turn
+    query.group();
+    for (const parser::Expression& value : values) {
+        Predicate equal_pred(Predicate::Type::Comparison);
+        equal_pred.cmpr = cmpr;
+        equal_pred.cmpr.op = Predicate::Operator::Equal;
+        equal_pred.cmpr.expr[1] = value;
+        query.Or();
+        add_comparison_to_query(query, equal_pred, args, mapping);
+    }
+    if (values.empty()) {
+        query.and_query(std::unique_ptr<realm::Expression>(new FalseExpression));
+    }
+    query.end_group();
+}
+
 void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &args, parser::KeyPathMapping& mapping)
 {
     Predicate::Comparison cmpr = pred.cmpr;
     auto lhs_type = cmpr.expr[0].type, rhs_type = cmpr.expr[1].type;
 
+    if (rhs_type == parser::Expression::Type::List) {
+        add_list_comparison_to_query(query, pred, args, mapping);
+        return;
+    }
+
     if (!is_property_operation(lhs_type) && !is_property_operation(rhs_type)) {
         // value vs value expressions are not supported (ex: 2 < 3 or null != null)
         throw std::logic_error("Predicate expressions must compare a keypath and another keypath or a constant value");
@@ -706,6 +773,39 @@ void add_comparison_to_query(Query &query, const Predicate &pred, Arguments &arg
     }
 }
 
+size_t get_num_arguments(const Predicate& pred);
+
+size_t get_num_arguments(const parser::Expression& e)
+{
+    size_t num_arguments = 0;
+    if (e.type == parser::Expression::Type::Argument) {
+        num_arguments = stot<size_t>(e.s) + 1;
+    }
+    if (e.subquery) {
+        num_arguments = std::max(num_arguments, get_num_arguments(*e.subquery));
+    }
+    if (e.list) {
+        for (const parser::Expression& value : *e.list) {
+            num_arguments = std::max(num_arguments, get_num_arguments(value));
+        }
+    }
+    return num_arguments;
+}
+
+size_t get_num_arguments(const Predicate& pred)
+{
+    size_t num_arguments = 0;
+    if (pred.type == Predicate::Type::Comparison) {
+        for (const parser::Expression& e : pred.cmpr.expr) {
+            num_arguments = std::max(num_arguments, get_num_arguments(e));
+        }
+    }
+    for (const Predicate& sub_pred : pred.cpnd.sub_predicates) {
+        num_arguments = std::max(num_arguments, get_num_arguments(sub_pred));
+    }
+    return num_arguments;
+}
+
 void update_query_with_predicate(Query &query, const Predicate &pred, Arguments &arguments, parser::KeyPathMapping& mapping)
 {
     if (pred.negate) {
@@ -816,5 +916,21 @@ void apply_ordering(DescriptorOrdering& ordering, ConstTableRef target, const pa
     apply_ordering(ordering, target, state, args);
 }
 
+PreparedQuery::PreparedQuery(const std::string& query_string)
+: m_result(std::make_shared<const ParserResult>(parser::parse(query_string)))
+, m_num_arguments(::get_num_arguments(m_result->predicate))
+{
+}
+
+void PreparedQuery::apply_predicate(Query& query, Arguments& arguments, parser::KeyPathMapping mapping) const
+{
+    query_builder::apply_predicate(query, m_result->predicate, arguments, std::move(mapping));
+}
+
+void PreparedQuery::apply_ordering(DescriptorOrdering& ordering, ConstTableRef target, Arguments& arguments) const
+{
+    query_builder::apply_ordering(ordering, target, m_result->ordering, arguments);
+}
+
 } // namespace query_builder
 } // namespace realm
@@ -42,6 +42,7 @@ using RowExpr = BasicRowExpr<Table>;
 namespace parser {
     struct Predicate;
     struct DescriptorOrderingState;
+    struct ParserResult;
 }
 
 namespace query_builder {
@@ -52,6 +53,25 @@ void apply_predicate(Query& query, const parser::Predicate& predicate, Arguments
 void apply_ordering(DescriptorOrdering& ordering, ConstTableRef target, const parser::DescriptorOrderingState& state, Arguments& arguments);
 void apply_ordering(DescriptorOrdering& ordering, ConstTableRef target, const parser::DescriptorOrderingState& state);
 
+// A query string which is parsed once and can then be applied to any number of queries, each time with its own
+// arguments for the `$0` style placeholders. The parsed form is never modified after construction and is shared
+// by all copies, so copying a PreparedQuery to hand it to another thread is cheap.
+class PreparedQuery {
+public:
+    explicit PreparedQuery(const std::string& query_string);
+
+    // The number of arguments the query string refers to, i.e. one more than the highest placeholder index
+    size_t get_num_arguments() const noexcept { return m_num_arguments; }
+
+    void apply_predicate(Query& query, Arguments& arguments,
+                         parser::KeyPathMapping mapping = parser::KeyPathMapping()) const;
+    void apply_ordering(DescriptorOrdering& ordering, ConstTableRef target, Arguments& arguments) const;
+
+private:
+    std::shared_ptr<const parser::ParserResult> m_result;
+    size_t m_num_arguments;
+};
+
 
 struct AnyContext
 {
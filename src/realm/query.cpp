@@ -26,8 +26,13 @@
 #include <realm/query_engine.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/table_view.hpp>
+#include <realm/util/scope_exit.hpp>
+#include <realm/util/thread.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
 
 
 using namespace realm;
@@ -100,6 +105,7 @@ Query::Query(const Query& source)
     , m_groups(source.m_groups)
     , m_current_descriptor(source.m_current_descriptor)
     , m_table(source.m_table)
+    , m_threadcount(source.m_threadcount)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -121,6 +127,7 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_threadcount = source.m_threadcount;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -430,6 +437,20 @@ std::unique_ptr<ParentNode> make_size_condition_node(const Descriptor& descripto
     }
 }
 
+// Add the row indexes from `begin` to `end` to `refs`, for a query without conditions
+void add_range(IntegerColumn& refs, size_t begin, size_t end)
+{
+    std::vector<int64_t> indexes;
+    while (begin < end) {
+        size_t n = std::min(end - begin, size_t(REALM_MAX_BPNODE_SIZE));
+        indexes.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            indexes[i] = int64_t(begin + i);
+        refs.add(indexes.data(), n); // Throws
+        begin += n;
+    }
+}
+
 } // anonymous namespace
 
 void Query::fetch_descriptor()
@@ -881,12 +902,169 @@ Query& Query::like(size_t column_ndx, StringData value, bool case_sensitive)
 }
 
 
+// Set membership
+
+Query& Query::in(size_t column_ndx, const std::vector<int64_t>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    DataType type = m_current_descriptor->get_column_type(column_ndx);
+    if (type != type_Int && type != type_Bool && type != type_OldDateTime)
+        throw LogicError{LogicError::type_mismatch};
+
+    if (m_current_descriptor->is_nullable(column_ndx)) {
+        add_node(std::unique_ptr<ParentNode>{new IntegerInNode<IntNullColumn>(values, column_ndx)});
+    }
+    else {
+        add_node(std::unique_ptr<ParentNode>{new IntegerInNode<IntegerColumn>(values, column_ndx)});
+    }
+    return *this;
+}
+
+Query& Query::in(size_t column_ndx, const std::vector<Timestamp>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_Timestamp)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>{new TimestampInNode(values, column_ndx)});
+    return *this;
+}
+
+Query& Query::in(size_t column_ndx, const std::vector<StringData>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_String)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>{new StringInNode(values, column_ndx)});
+    return *this;
+}
+
+
+// Parallel search ============================================================================
+
+size_t Query::get_parallel_threads(size_t start, size_t end, size_t limit) const
+{
+    if (m_threadcount <= 1 || m_view || limit != size_t(-1) || !has_conditions())
+        return 1;
+    if (!root_node()->can_search_in_parallel())
+        return 1;
+
+    size_t num_leaves = (end - start + REALM_MAX_BPNODE_SIZE - 1) / REALM_MAX_BPNODE_SIZE;
+    return std::min(size_t(m_threadcount), num_leaves);
+}
+
+Query::ChunkList Query::split_into_chunks(size_t start, size_t end, size_t num_threads)
+{
+    // A few chunks per thread evens out the load when the matches are unevenly distributed. Chunks end at multiples
+    // of the leaf size, which is where the leaves of columns that were filled by appending rows begin.
+    const size_t leaf_size = REALM_MAX_BPNODE_SIZE;
+    size_t num_leaves = (end - start + leaf_size - 1) / leaf_size;
+    size_t chunk_size = std::max(num_leaves / (num_threads * 4), size_t(1)) * leaf_size;
+
+    ChunkList chunks;
+    size_t chunk_start = start;
+    while (chunk_start < end) {
+        size_t chunk_end = std::min(chunk_start - chunk_start % leaf_size + chunk_size, end);
+        chunks.emplace_back(chunk_start, chunk_end);
+        chunk_start = chunk_end;
+    }
+    return chunks;
+}
+
+// Calls func(query, chunk_ndx) once for each chunk, spread over `num_threads` threads including the calling one.
+template <class F>
+void Query::search_in_parallel(const ChunkList& chunks, size_t num_threads, F func) const
+{
+    // Nodes keep the state of a search, so each thread needs its own copy of them. The copies are made up front, as
+    // copying a query is not thread safe.
+    std::vector<Query> queries(num_threads, *this); // Throws
+    std::atomic<size_t> next_chunk(0);
+    std::exception_ptr error;
+    util::Mutex error_mutex;
+
+    auto search = [&](Query& query) noexcept {
+        try {
+            query.init();
+            for (;;) {
+                size_t chunk_ndx = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk_ndx >= chunks.size())
+                    break;
+                func(query, chunk_ndx); // Throws
+            }
+        }
+        catch (...) {
+            next_chunk = chunks.size(); // Stop the other threads
+            util::LockGuard lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    std::vector<util::Thread> threads(num_threads - 1);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        Query* query = &queries[i + 1];
+        try {
+            threads[i].start([&search, query] { search(*query); }); // Throws
+        }
+        catch (std::system_error&) {
+            // The chunks are shared out on demand, so the threads that did start will search all of them
+            break;
+        }
+    }
+    search(queries[0]);
+    for (auto& thread : threads) {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void Query::find_all_parallel(IntegerColumn& result, size_t start, size_t end, size_t num_threads) const
+{
+    ChunkList chunks = split_into_chunks(start, end, num_threads);
+
+    // Each chunk collects its matches separately, so that they can be appended to the result in table order
+    Allocator& alloc = Allocator::get_default();
+    std::vector<std::unique_ptr<IntegerColumn>> chunk_results(chunks.size());
+    auto destroy_chunk_results = util::make_scope_exit([&]() noexcept {
+        for (auto& chunk_result : chunk_results) {
+            if (chunk_result && chunk_result->is_attached())
+                chunk_result->destroy();
+        }
+    });
+
+    search_in_parallel(chunks, num_threads, [&](Query& query, size_t chunk_ndx) {
+        auto& chunk_result = chunk_results[chunk_ndx];
+        chunk_result.reset(new IntegerColumn(IntegerColumn::unattached_root_tag(), alloc)); // Throws
+        chunk_result->init_from_ref(alloc, IntegerColumn::create(alloc));                  // Throws
+        QueryState<int64_t> st;
+        st.init(act_FindAll, chunk_result.get(), size_t(-1));
+        query.aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, query.root_node(), &st,
+                                 chunks[chunk_ndx].first, chunks[chunk_ndx].second, nullptr); // Throws
+        st.flush_matches(); // Throws
+    }); // Throws
+
+    std::vector<int64_t> matches;
+    for (auto& chunk_result : chunk_results) {
+        size_t n = chunk_result->size();
+        matches.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            matches[i] = chunk_result->get(i);
+        result.add(matches.data(), n); // Throws
+    }
+}
+
+
 // Aggregates =================================================================================
 
 size_t Query::peek_tablerow(size_t tablerow) const
 {
 #ifdef REALM_DEBUG
-    m_view->check_cookie();
+    if (m_view)
+        m_view->check_cookie();
 #endif
 
     if (has_conditions())
@@ -931,7 +1109,34 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
 
         SequentialGetter<ColType> source_column(*m_table, column_ndx);
 
-        if (!m_view) {
+        size_t num_threads = get_parallel_threads(start, end, limit);
+        if (num_threads > 1) {
+            ChunkList chunks = split_into_chunks(start, end, num_threads);
+            std::vector<QueryState<R>> chunk_states(chunks.size());
+            search_in_parallel(chunks, num_threads, [&](Query& query, size_t chunk_ndx) {
+                QueryState<R>& chunk_st = chunk_states[chunk_ndx];
+                chunk_st.init(action, nullptr, limit);
+                SequentialGetter<ColType> chunk_source_column(*query.m_table, column_ndx);
+                query.aggregate_internal(action, ColumnTypeTraits<T>::id, ColType::nullable, query.root_node(),
+                                         &chunk_st, chunks[chunk_ndx].first, chunks[chunk_ndx].second,
+                                         &chunk_source_column); // Throws
+            }); // Throws
+
+            // Merging in table order makes min and max report the first row holding the value, like a search on a
+            // single thread does
+            for (auto& chunk_st : chunk_states) {
+                st.m_match_count += chunk_st.m_match_count;
+                if (action == act_Sum) {
+                    st.m_state += chunk_st.m_state;
+                }
+                else if ((action == act_Max && chunk_st.m_state > st.m_state) ||
+                         (action == act_Min && chunk_st.m_state < st.m_state)) {
+                    st.m_state = chunk_st.m_state;
+                    st.m_minmax_index = chunk_st.m_minmax_index;
+                }
+            }
+        }
+        else if (!m_view) {
             aggregate_internal(action, ColumnTypeTraits<T>::id, ColType::nullable, root_node(), &st, start, end,
                                &source_column);
         }
@@ -1345,7 +1550,7 @@ size_t Query::find(size_t begin)
     }
     else {
         size_t end = m_table->size();
-        size_t res = root_node()->find_first(begin, end);
+        size_t res = root_node()->cheapest_child()->find_first(begin, end);
         return (res == end) ? not_found : res;
     }
 }
@@ -1362,6 +1567,7 @@ void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit)
     if (end == size_t(-1))
         end = m_table->size();
 
+    size_t num_threads = get_parallel_threads(begin, end, limit);
     if (m_view) {
         for (size_t t = 0; t < m_view->size() && ret.size() < limit; t++) {
             size_t tablerow = static_cast<size_t>(m_view->m_row_indexes.get(t));
@@ -1373,19 +1579,70 @@ void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit)
     else {
         if (!has_conditions()) {
             IntegerColumn& refs = ret.m_row_indexes;
-            for (size_t i = begin; i < end && refs.size() < limit; ++i) {
-                refs.add(i);
-            }
+            if (begin < end && refs.size() < limit)
+                add_range(refs, begin, begin + std::min(end - begin, limit - refs.size()));
+        }
+        else if (num_threads > 1) {
+            find_all_parallel(ret.m_row_indexes, begin, end, num_threads);
         }
         else {
             QueryState<int64_t> st;
             st.init(act_FindAll, &ret.m_row_indexes, limit);
             aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, begin, end,
                                nullptr);
+            st.flush_matches(); // Throws
         }
     }
 }
 
+// Find the matches for a view which is sorted by `sort` and then limited to its `top` first rows. Every time a batch of
+// matches has been found, the matches which cannot be among the first rows of the view are discarded, so that no
+// more than `top` plus a batch of matches are ever kept and sorted. Returns the number of discarded matches.
+size_t Query::find_all_top(TableViewBase& ret, size_t begin, size_t end, size_t limit, const SortDescriptor& sort,
+                           size_t top) const
+{
+    if (limit == 0 || m_table->is_degenerate())
+        return 0;
+
+    if (end == size_t(-1))
+        end = m_table->size();
+
+    if (m_view || limit <= top || get_parallel_threads(begin, end, limit) > 1) {
+        find_all(ret, begin, end, limit);
+        return 0;
+    }
+
+    init();
+
+    IntegerColumn& refs = ret.m_row_indexes;
+    const size_t min_batch_size = 1000;
+    const size_t batch_size = std::max(top, min_batch_size);
+    size_t num_found = 0;
+    size_t num_discarded = 0;
+    while (begin < end && num_found < limit) {
+        size_t max_matches = std::min(batch_size, limit - num_found);
+        size_t size_before = refs.size();
+        if (has_conditions()) {
+            QueryState<int64_t> st;
+            st.init(act_FindAll, &refs, max_matches);
+            aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, begin, end,
+                               nullptr);
+            st.flush_matches(); // Throws
+        }
+        else {
+            add_range(refs, begin, begin + std::min(end - begin, max_matches));
+        }
+        size_t num_matches = refs.size() - size_before;
+        num_found += num_matches;
+        if (num_matches < max_matches)
+            break; // The search reached `end`
+
+        begin = to_size_t(refs.get(refs.size() - 1)) + 1;
+        num_discarded += ret.retain_first_rows(sort, top);
+    }
+    return num_discarded;
+}
+
 TableView Query::find_all(size_t start, size_t end, size_t limit)
 {
 #if REALM_METRICS
@@ -1394,6 +1651,7 @@ TableView Query::find_all(size_t start, size_t end, size_t limit)
 
     TableView ret(*m_table, *this, start, end, limit);
     find_all(ret, start, end, limit);
+    ret.m_row_indexes.encode_leaves(); // Throws
     return ret;
 }
 
@@ -1417,6 +1675,7 @@ size_t Query::do_count(size_t start, size_t end, size_t limit) const
 
     init();
     size_t cnt = 0;
+    size_t num_threads = get_parallel_threads(start, end, limit);
 
     if (m_view) {
         for (size_t t = 0; t < m_view->size() && cnt < limit; t++) {
@@ -1426,6 +1685,19 @@ size_t Query::do_count(size_t start, size_t end, size_t limit) const
             }
         }
     }
+    else if (num_threads > 1) {
+        ChunkList chunks = split_into_chunks(start, end, num_threads);
+        std::vector<size_t> chunk_counts(chunks.size());
+        search_in_parallel(chunks, num_threads, [&](Query& query, size_t chunk_ndx) {
+            QueryState<int64_t> st;
+            st.init(act_Count, nullptr, limit);
+            query.aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, query.root_node(), &st,
+                                     chunks[chunk_ndx].first, chunks[chunk_ndx].second, nullptr); // Throws
+            chunk_counts[chunk_ndx] = size_t(st.m_state);
+        }); // Throws
+        for (size_t chunk_count : chunk_counts)
+            cnt += chunk_count;
+    }
     else {
         QueryState<int64_t> st;
         st.init(act_Count, nullptr, limit);
@@ -1521,136 +1793,6 @@ size_t Query::remove()
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::validate()
 {
     if (!m_groups.size())
@@ -1703,7 +1845,7 @@ size_t Query::find_internal(size_t start, size_t end) const
 
     size_t r;
     if (ParentNode* root = root_node())
-        r = root->find_first(start, end);
+        r = root->cheapest_child()->find_first(start, end);
     else
         r = start; // user built an empty query; return any first
 
@@ -26,14 +26,6 @@
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/views.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/binary_data.hpp>
@@ -240,6 +232,13 @@ public:
     Query& contains(size_t column_ndx, BinaryData value, bool case_sensitive = true);
     Query& like(size_t column_ndx, BinaryData b, bool case_sensitive = true);
 
+    // Conditions: set membership. A row matches if the value in the column is
+    // equal to any of the specified values. This is much faster than combining
+    // an equal() condition for each value with Or() when there are many values.
+    Query& in(size_t column_ndx, const std::vector<int64_t>& values);
+    Query& in(size_t column_ndx, const std::vector<Timestamp>& values);
+    Query& in(size_t column_ndx, const std::vector<StringData>& values);
+
     // Negation
     Query& Not();
 
@@ -320,12 +319,24 @@ public:
     // Deletion
     size_t remove();
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    ConstTableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+
+    /// Let find_all(), count() and the aggregates search with up to
+    /// `threadcount` threads. The rows are split into chunks aligned to leaf
+    /// boundaries, and each thread searches chunks with its own copy of the
+    /// conditions. The results are the same as those of a search on a single
+    /// thread, and find_all() returns rows in table order.
+    ///
+    /// Threads are only used when the query is not restricted by a view, no
+    /// limit is given, the searched range spans more than one leaf, and none
+    /// of the conditions follow links or search subtables. The default of 1
+    /// searches on the calling thread only.
+    ///
+    /// A view returned by find_all() also sorts and removes duplicates with
+    /// up to this many threads when it has enough rows, which gives the
+    /// same order as on a single thread.
+    void set_threads(unsigned int threadcount) noexcept;
+    unsigned int get_threads() const noexcept;
 
     const TableRef& get_table()
     {
@@ -424,7 +435,16 @@ private:
                             size_t start, size_t end, SequentialGetterBase* source_column) const;
 
     void find_all(TableViewBase& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+    size_t find_all_top(TableViewBase& tv, size_t start, size_t end, size_t limit, const SortDescriptor& sort,
+                        size_t top) const;
     size_t do_count(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+
+    using ChunkList = std::vector<std::pair<size_t, size_t>>;
+    size_t get_parallel_threads(size_t start, size_t end, size_t limit) const;
+    static ChunkList split_into_chunks(size_t start, size_t end, size_t num_threads);
+    template <class F>
+    void search_in_parallel(const ChunkList& chunks, size_t num_threads, F func) const;
+    void find_all_parallel(IntegerColumn& result, size_t start, size_t end, size_t num_threads) const;
     void delete_nodes() noexcept;
 
     bool has_conditions() const
@@ -441,6 +461,7 @@ private:
 
     friend class Table;
     friend class TableViewBase;
+    friend class QueryCursor;
     friend class metrics::QueryInfo;
 
     std::string error_code;
@@ -462,6 +483,8 @@ private:
     LinkViewRef m_source_link_view;               // link views are refcounted and shared.
     TableViewBase* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<TableViewBase> m_owned_source_table_view; // <--- except when indicated here
+
+    unsigned int m_threadcount = 1;
 };
 
 // Implementation:
@@ -476,6 +499,16 @@ inline Query& Query::not_equal(size_t column_ndx, const char* c_str, bool case_s
     return not_equal(column_ndx, StringData(c_str), case_sensitive);
 }
 
+inline void Query::set_threads(unsigned int threadcount) noexcept
+{
+    m_threadcount = threadcount == 0 ? 1 : threadcount;
+}
+
+inline unsigned int Query::get_threads() const noexcept
+{
+    return m_threadcount;
+}
+
 } // namespace realm
 
 #endif // REALM_QUERY_HPP
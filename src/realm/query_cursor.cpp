@@ -0,0 +1,96 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+
+#include <realm/query_cursor.hpp>
+#include <realm/query_engine.hpp>
+#include <realm/table_view.hpp>
+
+using namespace realm;
+
+QueryCursor::QueryCursor(const Query& query, size_t start, size_t end, size_t limit)
+    : m_query(query)
+    , m_begin(start)
+    , m_end(end)
+    , m_limit(limit)
+    , m_batch(IntegerColumn::unattached_root_tag(), Allocator::get_default())
+{
+    m_batch.get_root_array()->create(Array::type_Normal); // Throws
+
+    const Table* table = m_query.m_table.get();
+    if (!table || table->is_degenerate()) {
+        m_limit = 0;
+        return;
+    }
+    REALM_ASSERT_3(m_begin, <=, table->size());
+    if (m_end == size_t(-1))
+        m_end = table->size();
+
+    if (m_query.m_view)
+        m_query.m_view->sync_if_needed(); // Throws
+    m_query.init(); // Throws
+    m_table_version = table->get_version_counter();
+}
+
+QueryCursor::~QueryCursor() noexcept
+{
+    m_batch.destroy();
+}
+
+bool QueryCursor::next_batch()
+{
+    m_batch.clear(); // Throws
+    if (m_query.m_table->get_version_counter() != m_table_version)
+        throw LogicError(LogicError::illegal_combination);
+    if (m_begin >= m_end || m_num_found == m_limit)
+        return false;
+
+    size_t max_matches = std::min(size_t(REALM_MAX_BPNODE_SIZE), m_limit - m_num_found);
+    if (m_query.m_view) {
+        const RowIndexes& view = *m_query.m_view;
+        while (m_view_ndx < view.size() && m_batch.size() < max_matches) {
+            size_t row = to_size_t(view.m_row_indexes.get(m_view_ndx++));
+            if (row >= m_begin && row < m_end && m_query.peek_tablerow(row) != not_found)
+                m_batch.add(int64_t(row)); // Throws
+        }
+        if (m_view_ndx == view.size())
+            m_begin = m_end;
+    }
+    else {
+        if (m_query.has_conditions()) {
+            QueryState<int64_t> st;
+            st.init(act_FindAll, &m_batch, max_matches);
+            m_query.aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, m_query.root_node(), &st,
+                                       m_begin, m_end, nullptr); // Throws
+            st.flush_matches(); // Throws
+        }
+        else {
+            size_t n = std::min(max_matches, m_end - m_begin);
+            for (size_t i = 0; i < n; ++i)
+                m_batch.add(int64_t(m_begin + i)); // Throws
+        }
+        // Fewer matches than were asked for means that the search reached the end
+        if (m_batch.size() < max_matches)
+            m_begin = m_end;
+        else
+            m_begin = to_size_t(m_batch.back()) + 1;
+    }
+
+    m_num_found += m_batch.size();
+    return m_batch.size() > 0;
+}
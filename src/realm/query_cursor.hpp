@@ -0,0 +1,100 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+
+#ifndef REALM_QUERY_CURSOR_HPP
+#define REALM_QUERY_CURSOR_HPP
+
+#include <realm/column.hpp>
+#include <realm/query.hpp>
+
+namespace realm {
+
+/// QueryCursor finds the rows that match a query a batch at a time, so that
+/// the first rows can be processed before the rest are found, and without
+/// keeping the indexes of all matching rows in memory like a TableView does:
+///
+///     QueryCursor cursor(query);
+///     while (cursor.next_batch()) {
+///         for (size_t i = 0; i < cursor.size(); ++i)
+///             export_row(table[cursor.get_source_ndx(i)]);
+///     }
+///
+/// A batch holds up to REALM_MAX_BPNODE_SIZE rows, in the order in which
+/// find_all() would return them. The search of each batch resumes where the
+/// previous one stopped, so a cursor that is not read to the end never
+/// searches the rest of the table.
+///
+/// The table must not be modified while the cursor is in use. If it is,
+/// next_batch() throws LogicError::illegal_combination.
+class QueryCursor {
+public:
+    /// The arguments are the same as those of Query::find_all(). The query is
+    /// copied, so it can be changed or destroyed while the cursor is in use.
+    explicit QueryCursor(const Query& query, size_t start = 0, size_t end = size_t(-1),
+                         size_t limit = size_t(-1));
+    QueryCursor(const QueryCursor&) = delete;
+    QueryCursor& operator=(const QueryCursor&) = delete;
+    ~QueryCursor() noexcept;
+
+    /// Find the next batch of matching rows. Returns false, and leaves the
+    /// batch empty, when all matches have been found.
+    bool next_batch();
+
+    /// The number of rows in the current batch.
+    size_t size() const noexcept;
+
+    /// The index in the table of the row at the specified index in the
+    /// current batch.
+    size_t get_source_ndx(size_t batch_ndx) const noexcept;
+
+    /// The number of matching rows found so far, including the current batch.
+    size_t get_num_found() const noexcept;
+
+private:
+    Query m_query;
+    size_t m_begin;
+    size_t m_end;
+    size_t m_limit;
+    size_t m_num_found = 0;
+    size_t m_view_ndx = 0; // Next row of the view to test, for a query that is restricted by a view
+    uint_fast64_t m_table_version = 0;
+    IntegerColumn m_batch;
+};
+
+
+// Implementation:
+
+inline size_t QueryCursor::size() const noexcept
+{
+    return m_batch.size();
+}
+
+inline size_t QueryCursor::get_source_ndx(size_t batch_ndx) const noexcept
+{
+    return to_size_t(m_batch.get(batch_ndx));
+}
+
+inline size_t QueryCursor::get_num_found() const noexcept
+{
+    return m_num_found;
+}
+
+} // namespace realm
+
+#endif // REALM_QUERY_CURSOR_HPP
@@ -539,6 +539,12 @@ ExpressionNode::ExpressionNode(std::unique_ptr<Expression> expression)
     m_dT = 50.0;
 }
 
+void ExpressionNode::init()
+{
+    ParentNode::init();
+    m_expression->init();
+}
+
 void ExpressionNode::table_changed()
 {
     m_expression->set_base_table(m_table.get());
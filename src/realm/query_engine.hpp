@@ -89,10 +89,12 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <sstream>
 #include <string>
 #include <array>
+#include <unordered_set>
 
 #include <realm/array_basic.hpp>
 #include <realm/array_string.hpp>
 #include <realm/column_binary.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/column_fwd.hpp>
 #include <realm/column_link.hpp>
 #include <realm/column_linklist.hpp>
@@ -108,6 +110,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/metrics/query_info.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/query_operators.hpp>
+#include <realm/range_index.hpp>
 #include <realm/table.hpp>
 #include <realm/unicode.hpp>
 #include <realm/util/miscellaneous.hpp>
@@ -138,6 +141,10 @@ const size_t probe_matches = 4;
 
 const size_t bitwidth_time_unit = 64;
 
+// A range index is used for a condition only if at most one in this many rows match it. Otherwise, scanning the
+// column is faster than sorting the matches that the index lists in value order back into row order.
+const size_t range_index_max_match_ratio = 32;
+
 typedef bool (*CallbackDummy)(int64_t);
 
 class ParentNode {
@@ -158,9 +165,21 @@ public:
 
         m_children = v;
         m_children.erase(m_children.begin() + i);
+
+        // The other conditions are tested in this order when our own condition matches, so test the ones that are
+        // expected to match rarely first
+        auto score_compare = [](const ParentNode* a, const ParentNode* b) { return a->cost() < b->cost(); };
+        std::stable_sort(m_children.begin(), m_children.end(), score_compare);
         m_children.insert(m_children.begin(), this);
     }
 
+    // Returns the node that is expected to be the cheapest one to drive a search with find_first()
+    ParentNode* cheapest_child() const
+    {
+        auto score_compare = [](const ParentNode* a, const ParentNode* b) { return a->cost() < b->cost(); };
+        return *std::min_element(m_children.begin(), m_children.end(), score_compare);
+    }
+
     double cost() const
     {
         return 8 * bitwidth_time_unit / m_dD +
@@ -234,6 +253,13 @@ public:
             return m_child->validate();
     }
 
+    // Whether clones of this node may search the same table from different threads at the same time. Nodes that
+    // obtain link list or subtable accessors cannot, as those accessors are cached and shared by the clones.
+    virtual bool can_search_in_parallel() const
+    {
+        return !m_child || m_child->can_search_in_parallel();
+    }
+
     ParentNode(const ParentNode& from)
         : ParentNode(from, nullptr)
     {
@@ -346,6 +372,76 @@ protected:
 
 private:
     virtual void table_changed() = 0;
+
+protected:
+    // Use the range index of the condition column, if it has one, to find the rows that match
+    // `TConditionFunction` with `value`, and keep them in m_matching_rows. Sets m_use_matching_rows accordingly.
+    template <class TConditionFunction, class ColType, class T>
+    void init_range_index(const ColType& column, const T& value)
+    {
+        m_use_matching_rows = false;
+        m_matching_rows.clear();
+
+        std::unique_ptr<RangeIndex> index = m_table->get_range_index(m_condition_column_idx); // Throws
+        size_t begin, end;
+        if (!index || !index->template find_range<TConditionFunction>(column, value, begin, end))
+            return;
+        size_t num_rows = m_table->size();
+        if ((end - begin) * range_index_max_match_ratio > num_rows)
+            return;
+
+        index->get_rows(begin, end, m_matching_rows); // Throws
+        std::sort(m_matching_rows.begin(), m_matching_rows.end());
+        m_use_matching_rows = true;
+        m_dT = 0.0;
+        m_dD = double(num_rows) / (m_matching_rows.size() + 1.0);
+    }
+
+    // If `column` has a search index, look up the rows that hold any of `values` in it, and keep them in
+    // m_matching_rows. Sets m_use_matching_rows accordingly.
+    template <class T>
+    void init_search_index_matches(const ColumnBase& column, const std::vector<T>& values)
+    {
+        m_use_matching_rows = false;
+        m_matching_rows.clear();
+
+        const StringIndex* index = column.get_search_index();
+        if (!index)
+            return;
+
+        for (const T& value : values) {
+            InternalFindResult res;
+            switch (index->find_all_no_copy(value, res)) {
+                case FindRes_single:
+                    m_matching_rows.push_back(res.payload); // Throws
+                    break;
+                case FindRes_column: {
+                    const IntegerColumn rows(column.get_alloc(), ref_type(res.payload)); // Throws
+                    for (size_t i = res.start_ndx; i < res.end_ndx; ++i)
+                        m_matching_rows.push_back(to_size_t(rows.get(i))); // Throws
+                    break;
+                }
+                case FindRes_not_found:
+                    break;
+            }
+        }
+        std::sort(m_matching_rows.begin(), m_matching_rows.end());
+        m_use_matching_rows = true;
+        m_dT = 0.0;
+        m_dD = double(m_table->size()) / (m_matching_rows.size() + 1.0);
+    }
+
+    size_t find_first_matching_row(size_t start, size_t end) const
+    {
+        auto it = std::lower_bound(m_matching_rows.begin(), m_matching_rows.end(), start);
+        if (it == m_matching_rows.end() || *it >= end)
+            return not_found;
+        return *it;
+    }
+
+    // Rows that match the condition, in ascending order, when m_use_matching_rows is true
+    std::vector<size_t> m_matching_rows;
+    bool m_use_matching_rows = false;
 };
 
 // For conditions on a subtable (encapsulated in subtable()...end_subtable()). These return the parent row as match if
@@ -374,6 +470,11 @@ public:
         }
     }
 
+    bool can_search_in_parallel() const override
+    {
+        return false;
+    }
+
     void table_changed() override
     {
         m_col_type = m_table->get_real_column_type(m_condition_column_idx);
@@ -583,9 +684,11 @@ protected:
     using LeafType = typename ColType::LeafType;
     using LeafInfo = typename ColType::LeafInfo;
 
+    template <class TConditionFunction>
     size_t aggregate_local_impl(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
-                                SequentialGetterBase* source_column, int c)
+                                SequentialGetterBase* source_column)
     {
+        constexpr int c = TConditionFunction::condition;
         REALM_ASSERT(m_children.size() > 0);
         m_local_matches = 0;
         m_local_limit = local_limit;
@@ -605,6 +708,11 @@ protected:
             else
                 end_in_leaf = end - m_leaf_start;
 
+            if (!leaf_can_match<TConditionFunction>()) {
+                s = end_in_leaf + m_leaf_start;
+                continue;
+            }
+
             if (fastmode) {
                 bool cont;
                 size_t start_in_leaf = s - m_leaf_start;
@@ -674,6 +782,7 @@ protected:
 
         // Clear leaf cache
         m_leaf_end = 0;
+        m_bounds_checked_leaf_start = npos;
         m_array_ptr.reset(); // Explicitly destroy the old one first, because we're reusing the memory.
         m_array_ptr.reset(new (&m_leaf_cache_storage) LeafType(m_table->get_alloc()));
     }
@@ -696,6 +805,53 @@ protected:
         }
     }
 
+    // Returns false if the bounds of the cached leaf rule out any match, in which case the leaf can be skipped
+    template <class TConditionFunction>
+    bool leaf_can_match()
+    {
+        if (m_bounds_checked_leaf_start != m_leaf_start) {
+            int64_t min, max;
+            m_leaf_can_match = !get_leaf_bounds(*m_condition_column, *m_leaf_ptr, min, max) ||
+                               bounds_can_match<TConditionFunction>(m_value, min, max);
+            m_bounds_checked_leaf_start = m_leaf_start;
+        }
+        return m_leaf_can_match;
+    }
+
+    static bool get_leaf_bounds(const IntegerColumn& column, const ArrayInteger& leaf, int64_t& min, int64_t& max)
+    {
+        return column.get_leaf_bounds(leaf, min, max);
+    }
+
+    static bool get_leaf_bounds(const IntNullColumn&, const ArrayIntNull&, int64_t&, int64_t&)
+    {
+        return false;
+    }
+
+    template <class TConditionFunction>
+    static bool bounds_can_match(int64_t v, int64_t min, int64_t max)
+    {
+        if (std::is_same<TConditionFunction, Equal>::value)
+            return v >= min && v <= max;
+        if (std::is_same<TConditionFunction, NotEqual>::value)
+            return !(v == min && v == max);
+        if (std::is_same<TConditionFunction, Greater>::value)
+            return max > v;
+        if (std::is_same<TConditionFunction, Less>::value)
+            return min < v;
+        if (std::is_same<TConditionFunction, GreaterEqual>::value)
+            return max >= v;
+        if (std::is_same<TConditionFunction, LessEqual>::value)
+            return min <= v;
+        return true;
+    }
+
+    template <class TConditionFunction>
+    static bool bounds_can_match(util::Optional<int64_t>, int64_t, int64_t)
+    {
+        return true;
+    }
+
     bool should_run_in_fastmode(SequentialGetterBase* source_column) const
     {
         return (m_children.size() == 1 &&
@@ -719,6 +875,10 @@ protected:
     size_t m_leaf_end = 0;
     size_t m_local_end;
 
+    // Result of leaf_can_match() for the leaf starting at m_bounds_checked_leaf_start
+    size_t m_bounds_checked_leaf_start = npos;
+    bool m_leaf_can_match = true;
+
     // Aggregate optimization
     using TFind_callback_specialized = bool (ThisType::*)(size_t, size_t);
     TFind_callback_specialized m_find_callback_specialized = nullptr;
@@ -744,24 +904,45 @@ public:
     {
     }
 
+    void init() override
+    {
+        BaseType::init();
+
+        // Start out with the match distance that the column statistics predict, if there are any, instead of
+        // having to learn it while searching
+        ColumnStatistics stats;
+        if (this->m_table->get_column_statistics(this->m_condition_column_idx, stats) && stats.row_count != 0) {
+            double rows = double(stats.row_count);
+            this->m_dD = rows / (stats.estimate(TConditionFunction(), this->m_value) * rows + 1.0);
+        }
+
+        this->template init_range_index<TConditionFunction>(*this->m_condition_column, this->m_value); // Throws
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
         this->m_action = action;
         this->m_find_callback_specialized = get_specialized_callback(action, col_id, is_nullable);
+        ParentNode::aggregate_local_prepare(action, col_id, is_nullable);
     }
 
     size_t aggregate_local(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
                            SequentialGetterBase* source_column) override
     {
-        constexpr int cond = TConditionFunction::condition;
-        return this->aggregate_local_impl(st, start, end, local_limit, source_column, cond);
+        // The leaf searches below would scan the column, so go through the matches found in the range index instead
+        if (this->m_use_matching_rows)
+            return ParentNode::aggregate_local(st, start, end, local_limit, source_column);
+        return this->template aggregate_local_impl<TConditionFunction>(st, start, end, local_limit, source_column);
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
         REALM_ASSERT(this->m_table);
 
+        if (this->m_use_matching_rows)
+            return this->find_first_matching_row(start, end);
+
         while (start < end) {
 
             // Cache internal leaves
@@ -773,6 +954,11 @@ public:
             // It should just call array::get and save the initial overhead of find_first() which has become quite
             // big. Do this when we have cleaned up core a bit more.
 
+            if (!this->template leaf_can_match<TConditionFunction>()) {
+                start = this->m_leaf_end;
+                continue;
+            }
+
             size_t end2;
             if (end > this->m_leaf_end)
                 end2 = this->m_leaf_end - this->m_leaf_start;
@@ -909,10 +1095,15 @@ public:
     {
         ParentNode::init();
         m_dD = 100.0;
+        m_dT = 1.0;
+        init_range_index<TConditionFunction>(*m_condition_column.m_column, m_value); // Throws
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_use_matching_rows)
+            return find_first_matching_row(start, end);
+
         TConditionFunction cond;
 
         auto find = [&](bool nullability) {
@@ -986,6 +1177,13 @@ public:
         m_dD = 10.0;
     }
 
+    bool can_search_in_parallel() const override
+    {
+        return (std::is_same<TConditionValue, StringData>::value ||
+                std::is_same<TConditionValue, BinaryData>::value) &&
+               ParentNode::can_search_in_parallel();
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         for (size_t s = start; s < end; ++s) {
@@ -1128,10 +1326,15 @@ public:
         ParentNode::init();
 
         m_dD = 100.0;
+        m_dT = 0.0;
+        init_range_index<TConditionFunction>(*m_condition_column, m_value); // Throws
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_use_matching_rows)
+            return find_first_matching_row(start, end);
+
         size_t ret = m_condition_column->find<TConditionFunction>(m_value, start, end);
         return ret;
     }
@@ -1604,6 +1807,280 @@ private:
 };
 
 
+// Conditions that the value of a column is one of a set of values (see Query::in()). Each row is tested with a
+// single hash lookup, however many values there are. If the column has a search index, the rows with each of the
+// values are looked up in it instead.
+template <class ColType>
+class IntegerInNode : public ParentNode {
+public:
+    IntegerInNode(const std::vector<int64_t>& values, size_t column_ndx)
+        : m_values(values)
+    {
+        m_condition_column_idx = column_ndx;
+        std::sort(m_values.begin(), m_values.end());
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+        m_value_set.insert(m_values.begin(), m_values.end());
+    }
+
+    IntegerInNode(const IntegerInNode& from, QueryNodeHandoverPatches* patches)
+        : ParentNode(from, patches)
+        , m_values(from.m_values)
+        , m_value_set(from.m_value_set)
+    {
+        copy_getter(m_condition_column, m_condition_column_idx, from.m_condition_column, patches);
+    }
+
+    void table_changed() override
+    {
+        m_condition_column.init(&get_column<ColType>(m_condition_column_idx));
+    }
+
+    void verify_column() const override
+    {
+        do_verify_column(m_condition_column.m_column);
+    }
+
+    void init() override
+    {
+        ParentNode::init();
+        m_dT = 1.0;
+        m_dD = 100.0;
+
+        ColumnStatistics stats;
+        if (m_table->get_column_statistics(m_condition_column_idx, stats) && stats.row_count != 0) {
+            double fraction = 0;
+            for (int64_t value : m_values)
+                fraction += stats.estimate(Equal(), value);
+            double rows = double(stats.row_count);
+            m_dD = rows / (std::min(fraction, 1.0) * rows + 1.0);
+        }
+
+        init_search_index_matches(*m_condition_column.m_column, m_values); // Throws
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_use_matching_rows)
+            return find_first_matching_row(start, end);
+        if (m_values.empty())
+            return not_found;
+
+        for (size_t s = start; s < end; ++s) {
+            if (contains(m_condition_column.get_next(s)))
+                return s;
+        }
+        return not_found;
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column.m_column != nullptr);
+        std::string list;
+        for (int64_t value : m_values)
+            list += (list.empty() ? "" : ", ") + util::serializer::print_value(value);
+        return state.describe_column(ParentNode::m_table, m_condition_column.m_column->get_column_index()) +
+               " IN {" + list + "}";
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new IntegerInNode(*this, patches));
+    }
+
+private:
+    // Sorted and without duplicates
+    std::vector<int64_t> m_values;
+    std::unordered_set<int64_t> m_value_set;
+    SequentialGetter<ColType> m_condition_column;
+
+    bool contains(int64_t value) const
+    {
+        // Most values in a column are often outside the range of the set, and are rejected without hashing them
+        return value >= m_values.front() && value <= m_values.back() && m_value_set.count(value) != 0;
+    }
+
+    bool contains(util::Optional<int64_t> value) const
+    {
+        return value && contains(*value);
+    }
+};
+
+
+class TimestampInNode : public ParentNode {
+public:
+    TimestampInNode(const std::vector<Timestamp>& values, size_t column_ndx)
+    {
+        m_condition_column_idx = column_ndx;
+        for (const Timestamp& value : values) {
+            if (m_value_set.insert(value).second) // Throws
+                m_values.push_back(value);        // Throws
+        }
+    }
+
+    TimestampInNode(const TimestampInNode& from, QueryNodeHandoverPatches* patches)
+        : ParentNode(from, patches)
+        , m_values(from.m_values)
+        , m_value_set(from.m_value_set)
+        , m_condition_column(from.m_condition_column)
+    {
+        if (m_condition_column && patches)
+            m_condition_column_idx = m_condition_column->get_column_index();
+    }
+
+    void table_changed() override
+    {
+        m_condition_column = &get_column<TimestampColumn>(m_condition_column_idx);
+    }
+
+    void verify_column() const override
+    {
+        do_verify_column(m_condition_column);
+    }
+
+    void init() override
+    {
+        ParentNode::init();
+        m_dT = 1.0;
+        m_dD = 100.0;
+        init_search_index_matches(*m_condition_column, m_values); // Throws
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_use_matching_rows)
+            return find_first_matching_row(start, end);
+
+        for (size_t s = start; s < end; ++s) {
+            if (m_value_set.count(m_condition_column->get(s)) != 0)
+                return s;
+        }
+        return not_found;
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column != nullptr);
+        std::string list;
+        for (Timestamp value : m_values)
+            list += (list.empty() ? "" : ", ") + util::serializer::print_value(value);
+        return state.describe_column(ParentNode::m_table, m_condition_column->get_column_index()) + " IN {" +
+               list + "}";
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new TimestampInNode(*this, patches));
+    }
+
+private:
+    // The distinct values, in the order they were specified
+    std::vector<Timestamp> m_values;
+    std::unordered_set<Timestamp> m_value_set;
+    const TimestampColumn* m_condition_column = nullptr;
+};
+
+
+class StringInNode : public StringNodeBase {
+public:
+    StringInNode(const std::vector<StringData>& values, size_t column_ndx)
+        : StringNodeBase(StringData(), column_ndx)
+    {
+        set_values(values); // Throws
+    }
+
+    StringInNode(const StringInNode& from, QueryNodeHandoverPatches* patches)
+        : StringNodeBase(from, patches)
+    {
+        set_values(from.m_values); // Throws
+    }
+
+    void init() override
+    {
+        clear_leaf_state();
+        StringNodeBase::init();
+        m_dD = 10.0;
+
+        // The values of an enumerated string column are tested by their key
+        m_key_set.clear();
+        if (m_column_type == col_type_StringEnum) {
+            auto& column = static_cast<const StringEnumColumn&>(*m_condition_column);
+            for (StringData value : m_values) {
+                size_t key_ndx = column.get_key_ndx(value);
+                if (key_ndx != not_found)
+                    m_key_set.insert(int64_t(key_ndx));
+            }
+            m_keys.init(&column);
+            m_dT = 1.0;
+        }
+
+        init_search_index_matches(*m_condition_column, m_values); // Throws
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_use_matching_rows)
+            return find_first_matching_row(start, end);
+
+        if (m_column_type == col_type_StringEnum) {
+            if (m_key_set.empty())
+                return not_found;
+            for (size_t s = start; s < end; ++s) {
+                m_keys.cache_next(s);
+                if (m_key_set.count(m_keys.m_leaf_ptr->get(s - m_keys.m_leaf_start)) != 0)
+                    return s;
+            }
+            return not_found;
+        }
+
+        for (size_t s = start; s < end; ++s) {
+            if (m_value_set.count(get_string(s)) != 0)
+                return s;
+        }
+        return not_found;
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column != nullptr);
+        std::string list;
+        for (StringData value : m_values)
+            list += (list.empty() ? "" : ", ") + util::serializer::print_value(value);
+        return state.describe_column(ParentNode::m_table, m_condition_column->get_column_index()) + " IN {" +
+               list + "}";
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new StringInNode(*this, patches));
+    }
+
+private:
+    // The distinct values, which refer to the strings in m_buffers, or are null
+    std::vector<StringData> m_values;
+    std::vector<std::string> m_buffers;
+    std::unordered_set<StringData> m_value_set;
+
+    // Used for enumerated string columns
+    std::unordered_set<int64_t> m_key_set;
+    SequentialGetter<StringEnumColumn> m_keys;
+
+    void set_values(const std::vector<StringData>& values)
+    {
+        // Copy the strings first, as m_buffers must not be reallocated once m_values refers to it
+        m_buffers.reserve(values.size()); // Throws
+        for (StringData value : values) {
+            if (!value.is_null())
+                m_buffers.push_back(std::string(value)); // Throws
+        }
+        size_t buffer_ndx = 0;
+        for (StringData value : values) {
+            StringData copy = value.is_null() ? StringData() : StringData(m_buffers[buffer_ndx++]);
+            if (m_value_set.insert(copy).second) // Throws
+                m_values.push_back(copy);        // Throws
+        }
+    }
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
@@ -1685,6 +2162,15 @@ public:
         }
     }
 
+    bool can_search_in_parallel() const override
+    {
+        for (auto& condition : m_conditions) {
+            if (!condition->can_search_in_parallel())
+                return false;
+        }
+        return ParentNode::can_search_in_parallel();
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         if (start >= end)
@@ -1802,6 +2288,11 @@ public:
         m_first_in_known_range = not_found;
     }
 
+    bool can_search_in_parallel() const override
+    {
+        return m_condition->can_search_in_parallel() && ParentNode::can_search_in_parallel();
+    }
+
     size_t find_first_local(size_t start, size_t end) override;
 
     std::string validate() override
@@ -2006,9 +2497,16 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override;
 
+    void init() override;
     void table_changed() override;
     void verify_column() const override;
 
+    // Expressions may follow links
+    bool can_search_in_parallel() const override
+    {
+        return false;
+    }
+
     virtual std::string describe(util::serializer::SerialisationState& state) const override;
 
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override;
@@ -2048,6 +2546,11 @@ public:
         do_verify_column(m_column, m_origin_column);
     }
 
+    bool can_search_in_parallel() const override
+    {
+        return false;
+    }
+
     virtual std::string describe(util::serializer::SerialisationState&) const override
     {
         throw SerialisationError("Serialising a query which links to an object is currently unsupported.");
@@ -381,6 +381,11 @@ public:
     virtual size_t find_first(size_t start, size_t end) const = 0;
     virtual void set_base_table(const Table* table) = 0;
     virtual void verify_column() const = 0;
+
+    // Called before every search, after set_base_table()
+    virtual void init()
+    {
+    }
     virtual const Table* get_base_table() const = 0;
     virtual std::string description(util::serializer::SerialisationState& state) const = 0;
 
@@ -430,8 +435,67 @@ public:
     }
 
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
+
+    // Batch evaluation. A subexpression of numbers that come from successive rows of the table and are never null
+    // (no links and no nullable columns) can write the values of `num_rows` rows, starting at row `index`, to a
+    // buffer in one call. When both sides of a Compare can, it evaluates them a leaf's worth of rows at a time with
+    // these instead of calling evaluate() for every ValueBase::default_size rows.
+    virtual bool has_batch_evaluation() const
+    {
+        return false;
+    }
+    virtual void evaluate_batch(size_t, size_t, int64_t*)
+    {
+        REALM_UNREACHABLE();
+    }
+    virtual void evaluate_batch(size_t, size_t, float*)
+    {
+        REALM_UNREACHABLE();
+    }
+    virtual void evaluate_batch(size_t, size_t, double*)
+    {
+        REALM_UNREACHABLE();
+    }
+
+    // For following links backwards (see Compare::init_semi_join()): the links that the values of a column come
+    // through, and a copy of the subexpression which takes its values from the target table of the links instead.
+    // A constant has no links and is its own copy.
+    virtual const LinkMap* get_link_map() const
+    {
+        return nullptr;
+    }
+    virtual std::unique_ptr<Subexpr> clone_for_link_target() const
+    {
+        return nullptr;
+    }
 };
 
+// The types of values of a batch (see Subexpr::evaluate_batch())
+template <class T>
+using IsBatchType = std::integral_constant<bool, std::is_same<T, int64_t>::value || std::is_same<T, float>::value ||
+                                                     std::is_same<T, double>::value>;
+
+// Copy elements `begin` to `end` of a leaf to a batch
+template <class U>
+void copy_to_batch(const Array& leaf, size_t begin, size_t end, U* destination)
+{
+    int64_t chunk[8];
+    for (; begin + 8 <= end; begin += 8) {
+        leaf.get_chunk(begin, chunk);
+        for (size_t i = 0; i < 8; ++i)
+            *destination++ = static_cast<U>(chunk[i]);
+    }
+    for (; begin < end; ++begin)
+        *destination++ = static_cast<U>(leaf.get(begin));
+}
+
+template <class T, class U>
+void copy_to_batch(const BasicArray<T>& leaf, size_t begin, size_t end, U* destination)
+{
+    for (; begin < end; ++begin)
+        *destination++ = static_cast<U>(leaf.get(begin));
+}
+
 template <typename T, typename... Args>
 std::unique_ptr<Subexpr> make_subexpr(Args&&... args)
 {
@@ -443,6 +507,7 @@ class Columns;
 template <class T>
 class Value;
 class ConstantStringValue;
+class LinkMap;
 template <class T>
 class Subexpr2;
 template <class oper, class TLeft = Subexpr, class TRight = Subexpr>
@@ -1227,6 +1292,32 @@ public:
         destination.import(*this);
     }
 
+    std::unique_ptr<Subexpr> clone_for_link_target() const override
+    {
+        return this->clone(nullptr);
+    }
+
+    // A constant is evaluated in batches by repeating it
+    bool has_batch_evaluation() const override
+    {
+        return !ValueBase::m_from_link_list && is_constant(is_number());
+    }
+
+    void evaluate_batch(size_t, size_t num_rows, int64_t* destination) override
+    {
+        fill_batch(num_rows, destination, is_number());
+    }
+
+    void evaluate_batch(size_t, size_t num_rows, float* destination) override
+    {
+        fill_batch(num_rows, destination, is_number());
+    }
+
+    void evaluate_batch(size_t, size_t num_rows, double* destination) override
+    {
+        fill_batch(num_rows, destination, is_number());
+    }
+
 
     template <class TOperator>
     REALM_FORCEINLINE void fun(const Value* left, const Value* right)
@@ -1427,6 +1518,35 @@ public:
     }
 
     NullableVector<T> m_storage;
+
+private:
+    using is_number = std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+    bool is_constant(std::true_type) const
+    {
+        for (size_t i = 0; i < ValueBase::m_values; ++i) {
+            if (m_storage.is_null(i) || m_storage[i] != m_storage[0])
+                return false;
+        }
+        return ValueBase::m_values > 0;
+    }
+
+    bool is_constant(std::false_type) const
+    {
+        return false;
+    }
+
+    template <class U>
+    void fill_batch(size_t num_rows, U* destination, std::true_type)
+    {
+        std::fill(destination, destination + num_rows, static_cast<U>(m_storage[0]));
+    }
+
+    template <class U>
+    void fill_batch(size_t, U*, std::false_type)
+    {
+        REALM_UNREACHABLE();
+    }
 };
 
 class ConstantStringValue : public Value<StringData> {
@@ -1921,6 +2041,39 @@ public:
         return !m_link_columns.empty();
     }
 
+    // Whether the links can be followed backwards with get_origin_rows(), which they can unless some of them are
+    // backlinks themselves
+    bool can_follow_backwards() const
+    {
+        return links_exist() &&
+               std::find(m_link_types.begin(), m_link_types.end(), col_type_BackLink) == m_link_types.end();
+    }
+
+    // The rows of the base table that link to any of the specified rows of the target table, in ascending order
+    std::vector<size_t> get_origin_rows(std::vector<size_t> rows) const
+    {
+        for (size_t i = m_link_columns.size(); i > 0; --i) {
+            const Table& origin = *m_tables[i - 1];
+            const Table& target = *m_tables[i];
+            size_t column_ndx = m_link_columns[i - 1]->get_column_index();
+            std::vector<bool> found(origin.size());
+            std::vector<size_t> origin_rows;
+            for (size_t row : rows) {
+                size_t count = target.get_backlink_count(row, origin, column_ndx);
+                for (size_t j = 0; j < count; ++j) {
+                    size_t origin_row = target.get_backlink(row, origin, column_ndx, j);
+                    if (!found[origin_row]) {
+                        found[origin_row] = true;
+                        origin_rows.push_back(origin_row);
+                    }
+                }
+            }
+            std::sort(origin_rows.begin(), origin_rows.end());
+            rows = std::move(origin_rows);
+        }
+        return rows;
+    }
+
     std::vector<const ColumnBase*> m_link_columns;
 
 private:
@@ -2116,6 +2269,18 @@ public:
         return SizeOperator<Size<T>>(this->clone(nullptr));
     }
 
+    const LinkMap* get_link_map() const override
+    {
+        return links_exist() ? &m_link_map : nullptr;
+    }
+
+    std::unique_ptr<Subexpr> clone_for_link_target() const override
+    {
+        if (!links_exist())
+            return nullptr;
+        return make_subexpr<Columns<T>>(column_ndx(), m_link_map.target_table());
+    }
+
 private:
     // Column index of payload column of m_table
     mutable size_t m_column_ndx;
@@ -3212,6 +3377,60 @@ public:
         }
     }
 
+    bool has_batch_evaluation() const override
+    {
+        return IsBatchType<T>::value && m_sg && !links_exist() && !m_nullable;
+    }
+
+    const LinkMap* get_link_map() const override
+    {
+        return links_exist() ? &m_link_map : nullptr;
+    }
+
+    std::unique_ptr<Subexpr> clone_for_link_target() const override
+    {
+        if (!links_exist())
+            return nullptr;
+        return make_subexpr<Columns<T>>(column_ndx(), m_link_map.target_table());
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, int64_t* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, float* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, double* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
+    // Copy the values straight from the leaves, a leaf at a time
+    template <class U>
+    void evaluate_batch_internal(size_t index, size_t num_rows, U* destination, std::true_type)
+    {
+        auto sgc = static_cast<SequentialGetter<ColType>*>(m_sg.get());
+        size_t end = index + num_rows;
+        while (index < end) {
+            sgc->cache_next(index);
+            size_t end_in_leaf = std::min(end, sgc->m_leaf_end);
+            copy_to_batch(*sgc->m_leaf_ptr, index - sgc->m_leaf_start, end_in_leaf - sgc->m_leaf_start,
+                          destination);
+            destination += end_in_leaf - index;
+            index = end_in_leaf;
+        }
+    }
+
+    template <class U>
+    void evaluate_batch_internal(size_t, size_t, U*, std::false_type)
+    {
+        REALM_UNREACHABLE();
+    }
+
     bool links_exist() const
     {
         return m_link_map.m_link_columns.size() > 0;
@@ -3758,6 +3977,30 @@ public:
         destination.import(result);
     }
 
+    bool has_batch_evaluation() const override
+    {
+        // Integer division by zero is undefined, so integer division is left to evaluate(), which never divides
+        // by a null
+        bool is_int_div = std::is_same<oper, Div<T>>::value && std::is_integral<T>::value;
+        return IsBatchType<T>::value && !is_int_div && m_left->has_batch_evaluation() &&
+               m_right->has_batch_evaluation();
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, int64_t* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, float* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
+    void evaluate_batch(size_t index, size_t num_rows, double* destination) override
+    {
+        evaluate_batch_internal(index, num_rows, destination, IsBatchType<T>());
+    }
+
     virtual std::string description(util::serializer::SerialisationState& state) const override
     {
         std::string s;
@@ -3786,6 +4029,30 @@ private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+
+    // Values of the operands for batch evaluation
+    std::vector<T> m_left_values;
+    std::vector<T> m_right_values;
+
+    template <class U>
+    void evaluate_batch_internal(size_t index, size_t num_rows, U* destination, std::true_type)
+    {
+        m_left_values.resize(num_rows);  // Throws
+        m_right_values.resize(num_rows); // Throws
+        const T* left = m_left_values.data();
+        const T* right = m_right_values.data();
+        m_left->evaluate_batch(index, num_rows, m_left_values.data());
+        m_right->evaluate_batch(index, num_rows, m_right_values.data());
+        oper o;
+        for (size_t i = 0; i < num_rows; ++i)
+            destination[i] = static_cast<U>(o(left[i], right[i]));
+    }
+
+    template <class U>
+    void evaluate_batch_internal(size_t, size_t, U*, std::false_type)
+    {
+        REALM_UNREACHABLE();
+    }
 };
 
 
@@ -3826,8 +4093,24 @@ public:
         return l ? l : r;
     }
 
+    void init() override
+    {
+        m_use_semi_join = init_semi_join(); // Throws
+        m_use_batches = !m_use_semi_join && IsBatchType<T>::value && m_left->has_batch_evaluation() &&
+                        m_right->has_batch_evaluation();
+        m_batch_begin = 0;
+        m_batch_end = 0;
+    }
+
     size_t find_first(size_t start, size_t end) const override
     {
+        if (m_use_semi_join) {
+            auto match = std::lower_bound(m_semi_join_rows.begin(), m_semi_join_rows.end(), start);
+            return match != m_semi_join_rows.end() && *match < end ? *match : not_found;
+        }
+        if (m_use_batches)
+            return find_first_in_batches(start, end, IsBatchType<T>());
+
         size_t match;
         Value<T> right;
         Value<T> left;
@@ -3885,8 +4168,110 @@ private:
     {
     }
 
+    // A comparison of a column of the target table of a path of links with a constant, such as
+    // `owner.name == "x"`, is otherwise evaluated by following the links forward from every row. When the target
+    // table has fewer rows than the table, it is cheaper to find the target rows that match and follow the links
+    // backwards from them to the rows that match. This finds those rows, or returns false if this cannot be done.
+    bool init_semi_join()
+    {
+        m_semi_join_rows.clear();
+        const LinkMap* link_map = m_left->get_link_map();
+        bool links_on_left = link_map != nullptr;
+        if (!links_on_left)
+            link_map = m_right->get_link_map();
+        if (!link_map || (links_on_left && m_right->get_link_map()) || !link_map->can_follow_backwards())
+            return false;
+        const Table* target = link_map->target_table();
+        if (target->size() >= link_map->base_table()->size())
+            return false;
+
+        // The other side must be a constant
+        std::unique_ptr<Subexpr> left = m_left->clone_for_link_target();
+        std::unique_ptr<Subexpr> right = m_right->clone_for_link_target();
+        if (!left || !right)
+            return false;
+
+        // A missing single link gives a null value. When that matches, every row must be evaluated.
+        if (link_map->only_unary_links()) {
+            Value<T> missing = make_value_for_link<T>(true, 0);
+            Value<T> constant;
+            size_t match;
+            if (links_on_left) {
+                right->evaluate(0, constant);
+                match = Value<T>::template compare<TCond>(&missing, &constant);
+            }
+            else {
+                left->evaluate(0, constant);
+                match = Value<T>::template compare<TCond>(&constant, &missing);
+            }
+            if (match != not_found)
+                return false;
+        }
+
+        Compare<TCond, T> target_compare(std::move(left), std::move(right));
+        target_compare.set_base_table(target);
+        target_compare.init();
+        std::vector<size_t> target_rows;
+        size_t size = target->size();
+        for (size_t row = target_compare.find_first(0, size); row != not_found;
+             row = target_compare.find_first(row + 1, size)) {
+            target_rows.push_back(row);
+        }
+        m_semi_join_rows = link_map->get_origin_rows(std::move(target_rows)); // Throws
+        return true;
+    }
+
+    // The results of the last batch are kept, as find_first() is called again for the rows after each match
+    size_t find_first_in_batches(size_t start, size_t end, std::true_type) const
+    {
+        while (start < end) {
+            if (start < m_batch_begin || start >= m_batch_end)
+                compute_batch(start, std::min(end - start, size_t(REALM_MAX_BPNODE_SIZE))); // Throws
+            size_t end_in_batch = std::min(end, m_batch_end);
+            auto begin = m_batch_results.begin() + (start - m_batch_begin);
+            auto match = std::find(begin, m_batch_results.begin() + (end_in_batch - m_batch_begin), char(1));
+            size_t ndx = start + size_t(match - begin);
+            if (ndx < end_in_batch)
+                return ndx;
+            start = end_in_batch;
+        }
+        return not_found;
+    }
+
+    size_t find_first_in_batches(size_t, size_t, std::false_type) const
+    {
+        REALM_UNREACHABLE();
+    }
+
+    void compute_batch(size_t start, size_t num_rows) const
+    {
+        m_left_values.resize(num_rows);   // Throws
+        m_right_values.resize(num_rows);  // Throws
+        m_batch_results.resize(num_rows); // Throws
+        m_left->evaluate_batch(start, num_rows, m_left_values.data());
+        m_right->evaluate_batch(start, num_rows, m_right_values.data());
+        const T* left = m_left_values.data();
+        const T* right = m_right_values.data();
+        char* results = m_batch_results.data();
+        TCond c;
+        for (size_t i = 0; i < num_rows; ++i)
+            results[i] = c(left[i], right[i]);
+        m_batch_begin = start;
+        m_batch_end = start + num_rows;
+    }
+
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+
+    bool m_use_semi_join = false;
+    std::vector<size_t> m_semi_join_rows;
+
+    bool m_use_batches = false;
+    mutable size_t m_batch_begin = 0;
+    mutable size_t m_batch_end = 0;
+    mutable std::vector<T> m_left_values;
+    mutable std::vector<T> m_right_values;
+    mutable std::vector<char> m_batch_results;
 };
 }
 #endif // REALM_QUERY_EXPRESSION_HPP
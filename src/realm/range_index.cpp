@@ -0,0 +1,203 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/range_index.hpp>
+
+#include <algorithm>
+
+#include <realm/column_timestamp.hpp>
+
+using namespace realm;
+
+namespace {
+
+// The order in which an index lists the rows: unordered values (nulls) first, then by value, then by row index
+template <class T>
+bool is_less(const T& value_a, size_t row_a, const T& value_b, size_t row_b)
+{
+    bool unordered_a = _impl::is_unordered_value(value_a);
+    bool unordered_b = _impl::is_unordered_value(value_b);
+    if (unordered_a || unordered_b) {
+        if (unordered_a != unordered_b)
+            return unordered_a;
+        return row_a < row_b;
+    }
+    const auto& v_a = _impl::get_ordered_value(value_a);
+    const auto& v_b = _impl::get_ordered_value(value_b);
+    if (v_a < v_b)
+        return true;
+    if (v_b < v_a)
+        return false;
+    return row_a < row_b;
+}
+
+template <class ColType>
+ref_type create_index(const ColType& column, bool skip_unordered, Allocator& alloc)
+{
+    using value_type = decltype(column.get(0));
+
+    size_t num_rows = column.size();
+    std::vector<value_type> values;
+    std::vector<size_t> rows;
+    values.reserve(num_rows); // Throws
+    rows.reserve(num_rows);   // Throws
+    for (size_t i = 0; i < num_rows; ++i) {
+        values.push_back(column.get(i)); // Throws
+        if (!skip_unordered || !_impl::is_unordered_value(values.back()))
+            rows.push_back(i);
+    }
+
+    auto less = [&](size_t a, size_t b) { return is_less(values[a], a, values[b], b); };
+    std::sort(rows.begin(), rows.end(), less); // Throws
+
+    IntegerColumn index(alloc, IntegerColumn::create(alloc)); // Throws
+    try {
+        for (size_t row : rows)
+            index.add(int64_t(row)); // Throws
+    }
+    catch (...) {
+        index.destroy();
+        throw;
+    }
+    // The root of the B+-tree changes as it grows
+    return index.get_ref();
+}
+
+} // anonymous namespace
+
+
+ref_type RangeIndex::create(const ColumnBase& column, ColumnType type, bool nullable, Allocator& alloc)
+{
+    switch (type) {
+        case col_type_Int:
+            if (nullable)
+                return create_index(static_cast<const IntNullColumn&>(column), false, alloc); // Throws
+            return create_index(static_cast<const IntegerColumn&>(column), false, alloc); // Throws
+        case col_type_Timestamp:
+            return create_index(static_cast<const TimestampColumn&>(column), false, alloc); // Throws
+        case col_type_Float:
+            return create_index(static_cast<const FloatColumn&>(column), true, alloc); // Throws
+        case col_type_Double:
+            return create_index(static_cast<const DoubleColumn&>(column), true, alloc); // Throws
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+void RangeIndex::insert(const ColumnBase& column, ColumnType type, bool nullable, size_t row_ndx, size_t num_rows)
+{
+    switch (type) {
+        case col_type_Int:
+            if (nullable) {
+                do_insert(static_cast<const IntNullColumn&>(column), false, row_ndx, num_rows); // Throws
+                return;
+            }
+            do_insert(static_cast<const IntegerColumn&>(column), false, row_ndx, num_rows); // Throws
+            return;
+        case col_type_Timestamp:
+            do_insert(static_cast<const TimestampColumn&>(column), false, row_ndx, num_rows); // Throws
+            return;
+        case col_type_Float:
+            do_insert(static_cast<const FloatColumn&>(column), true, row_ndx, num_rows); // Throws
+            return;
+        case col_type_Double:
+            do_insert(static_cast<const DoubleColumn&>(column), true, row_ndx, num_rows); // Throws
+            return;
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+void RangeIndex::erase(const ColumnBase& column, ColumnType type, bool nullable, size_t row_ndx)
+{
+    switch (type) {
+        case col_type_Int:
+            if (nullable) {
+                do_erase(static_cast<const IntNullColumn&>(column), false, row_ndx); // Throws
+                return;
+            }
+            do_erase(static_cast<const IntegerColumn&>(column), false, row_ndx); // Throws
+            return;
+        case col_type_Timestamp:
+            do_erase(static_cast<const TimestampColumn&>(column), false, row_ndx); // Throws
+            return;
+        case col_type_Float:
+            do_erase(static_cast<const FloatColumn&>(column), true, row_ndx); // Throws
+            return;
+        case col_type_Double:
+            do_erase(static_cast<const DoubleColumn&>(column), true, row_ndx); // Throws
+            return;
+        default:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+template <class ColType>
+void RangeIndex::do_insert(const ColType& column, bool skip_unordered, size_t row_ndx, size_t num_rows)
+{
+    if (num_rows == 0 || (skip_unordered && _impl::is_unordered_value(column.get(row_ndx))))
+        return;
+
+    // Rows with the same value are listed in the order of their row indexes, so the new rows go next to each other
+    size_t pos = find_position(column, row_ndx);
+    for (size_t i = 0; i < num_rows; ++i)
+        m_rows.insert(pos + i, int64_t(row_ndx + i)); // Throws
+}
+
+template <class ColType>
+void RangeIndex::do_erase(const ColType& column, bool skip_unordered, size_t row_ndx)
+{
+    if (skip_unordered && _impl::is_unordered_value(column.get(row_ndx)))
+        return;
+
+    size_t pos = find_position(column, row_ndx);
+    REALM_ASSERT(pos < size() && get(pos) == row_ndx);
+    bool is_last = pos == size() - 1;
+    m_rows.erase(pos, is_last); // Throws
+}
+
+// The position at which the specified row is, or would be, listed
+template <class ColType>
+size_t RangeIndex::find_position(const ColType& column, size_t row_ndx) const
+{
+    auto value = column.get(row_ndx);
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        size_t row = get(mid);
+        if (is_less(column.get(row), row, value, row_ndx)) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void RangeIndex::get_rows(size_t begin, size_t end, std::vector<size_t>& rows) const
+{
+    REALM_ASSERT(begin <= end && end <= size());
+    rows.reserve(rows.size() + (end - begin)); // Throws
+    for (size_t pos = begin; pos < end; ++pos)
+        rows.push_back(get(pos)); // Throws
+}
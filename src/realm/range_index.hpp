@@ -0,0 +1,288 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_RANGE_INDEX_HPP
+#define REALM_RANGE_INDEX_HPP
+
+#include <cmath>
+#include <vector>
+
+#include <realm/column.hpp>
+#include <realm/column_type.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/timestamp.hpp>
+
+namespace realm {
+
+/// A range index lists the rows of an integer, timestamp, float or double
+/// column in the order of their values, so that the rows whose values fall in
+/// a range can be found with a binary search (see Table::add_range_index()).
+///
+/// It is a B+-tree of row indexes. Rows with equal values are listed in
+/// ascending order. In integer and timestamp columns, every row is listed,
+/// and nulls come first. In float and double columns, nulls and NaNs are left
+/// out, as no range condition can match them.
+///
+/// Like a search index, it is kept up to date as the table is modified. The
+/// functions that modify it take the column, its type, and whether it is
+/// nullable, as create() does.
+class RangeIndex {
+public:
+    RangeIndex(Allocator&, ref_type);
+
+    /// Create an index of the values in the specified column, and return its
+    /// ref. `type` must be one of col_type_Int, col_type_Timestamp,
+    /// col_type_Float and col_type_Double.
+    static ref_type create(const ColumnBase&, ColumnType type, bool nullable, Allocator&);
+
+    ref_type get_ref() const noexcept;
+    void set_parent(ArrayParent*, size_t ndx_in_parent) noexcept;
+
+    /// List the rows [`row_ndx`, `row_ndx + num_rows`), which must all have
+    /// the same value. The rows that are already listed must not be among
+    /// them (see adjust_row_indexes()).
+    void insert(const ColumnBase&, ColumnType type, bool nullable, size_t row_ndx, size_t num_rows = 1);
+
+    /// Stop listing the specified row. It must still have the value that it
+    /// had when it was listed.
+    void erase(const ColumnBase&, ColumnType type, bool nullable, size_t row_ndx);
+
+    /// Add `diff` to the listed row indexes that are greater than or equal to
+    /// `row_ndx`.
+    void adjust_row_indexes(size_t row_ndx, int_fast64_t diff);
+
+    void clear();
+
+    /// The number of rows that are listed.
+    size_t size() const noexcept;
+
+    /// The index of the row at the specified position.
+    size_t get(size_t pos) const noexcept;
+
+    /// Find the positions [`begin`, `end`) of the rows for which `Cond` holds
+    /// between their value and `value`. Returns false if the condition is not
+    /// one that the index can answer, or if `value` is null.
+    template <class Cond, class ColType, class T>
+    bool find_range(const ColType&, T value, size_t& begin, size_t& end) const;
+
+    /// Append the rows at the positions [`begin`, `end`) to `rows`.
+    void get_rows(size_t begin, size_t end, std::vector<size_t>& rows) const;
+
+private:
+    IntegerColumn m_rows;
+
+    template <class ColType>
+    void do_insert(const ColType&, bool skip_unordered, size_t row_ndx, size_t num_rows);
+    template <class ColType>
+    void do_erase(const ColType&, bool skip_unordered, size_t row_ndx);
+    template <class ColType>
+    size_t find_position(const ColType&, size_t row_ndx) const;
+    template <class ColType, class T>
+    size_t lower_bound(const ColType&, const T& value) const;
+    template <class ColType, class T>
+    size_t upper_bound(const ColType&, const T& value) const;
+    template <class ColType>
+    size_t first_non_null(const ColType&) const;
+};
+
+
+namespace _impl {
+
+// Nulls, and NaNs in float and double columns, are not ordered like other values
+
+inline bool is_unordered_value(int64_t) noexcept
+{
+    return false;
+}
+
+inline bool is_unordered_value(const util::Optional<int64_t>& value) noexcept
+{
+    return !value;
+}
+
+inline bool is_unordered_value(const Timestamp& value) noexcept
+{
+    return value.is_null();
+}
+
+inline bool is_unordered_value(float value) noexcept
+{
+    return std::isnan(value);
+}
+
+inline bool is_unordered_value(double value) noexcept
+{
+    return std::isnan(value);
+}
+
+inline int64_t get_ordered_value(int64_t value) noexcept
+{
+    return value;
+}
+
+inline int64_t get_ordered_value(const util::Optional<int64_t>& value) noexcept
+{
+    return *value;
+}
+
+inline const Timestamp& get_ordered_value(const Timestamp& value) noexcept
+{
+    return value;
+}
+
+inline float get_ordered_value(float value) noexcept
+{
+    return value;
+}
+
+inline double get_ordered_value(double value) noexcept
+{
+    return value;
+}
+
+} // namespace _impl
+
+
+// Implementation:
+
+inline RangeIndex::RangeIndex(Allocator& alloc, ref_type ref)
+    : m_rows(alloc, ref)
+{
+}
+
+inline ref_type RangeIndex::get_ref() const noexcept
+{
+    return m_rows.get_ref();
+}
+
+inline void RangeIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_rows.set_parent(parent, ndx_in_parent);
+}
+
+inline void RangeIndex::adjust_row_indexes(size_t row_ndx, int_fast64_t diff)
+{
+    m_rows.adjust_ge(int_fast64_t(row_ndx), diff); // Throws
+}
+
+inline void RangeIndex::clear()
+{
+    m_rows.clear(); // Throws
+}
+
+inline size_t RangeIndex::size() const noexcept
+{
+    return m_rows.size();
+}
+
+inline size_t RangeIndex::get(size_t pos) const noexcept
+{
+    return to_size_t(m_rows.get(pos));
+}
+
+template <class Cond, class ColType, class T>
+bool RangeIndex::find_range(const ColType& column, T value, size_t& begin, size_t& end) const
+{
+    if (_impl::is_unordered_value(value))
+        return false;
+    auto v = _impl::get_ordered_value(value);
+
+    if (std::is_same<Cond, Equal>::value) {
+        begin = lower_bound(column, v);
+        end = upper_bound(column, v);
+    }
+    else if (std::is_same<Cond, Greater>::value) {
+        begin = upper_bound(column, v);
+        end = size();
+    }
+    else if (std::is_same<Cond, GreaterEqual>::value) {
+        begin = lower_bound(column, v);
+        end = size();
+    }
+    else if (std::is_same<Cond, Less>::value) {
+        begin = first_non_null(column);
+        end = lower_bound(column, v);
+    }
+    else if (std::is_same<Cond, LessEqual>::value) {
+        begin = first_non_null(column);
+        end = upper_bound(column, v);
+    }
+    else {
+        return false;
+    }
+    if (begin > end)
+        begin = end;
+    return true;
+}
+
+template <class ColType, class T>
+size_t RangeIndex::lower_bound(const ColType& column, const T& value) const
+{
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        auto v = column.get(get(mid));
+        if (_impl::is_unordered_value(v) || _impl::get_ordered_value(v) < value) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+template <class ColType, class T>
+size_t RangeIndex::upper_bound(const ColType& column, const T& value) const
+{
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        auto v = column.get(get(mid));
+        if (_impl::is_unordered_value(v) || !(value < _impl::get_ordered_value(v))) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+template <class ColType>
+size_t RangeIndex::first_non_null(const ColType& column) const
+{
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (_impl::is_unordered_value(column.get(get(mid)))) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+} // namespace realm
+
+#endif // REALM_RANGE_INDEX_HPP
@@ -414,6 +414,30 @@ public:
         return false;
     }
 
+    bool add_range_index(size_t col_ndx)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(col_ndx < m_table->get_column_count()))) {
+                log("table->add_range_index(%1);", col_ndx); // Throws
+                m_table->add_range_index(col_ndx);           // Throws
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool remove_range_index(size_t col_ndx)
+    {
+        if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_table->is_attached()))) {
+            if (REALM_LIKELY(REALM_COVER_ALWAYS(col_ndx < m_table->get_column_count()))) {
+                log("table->remove_range_index(%1);", col_ndx); // Throws
+                m_table->remove_range_index(col_ndx);           // Throws
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool set_link_type(size_t col_ndx, LinkType link_type)
     {
         if (REALM_LIKELY(REALM_COVER_ALWAYS(m_table && m_desc))) {
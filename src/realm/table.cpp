@@ -40,6 +40,8 @@
 #include <realm/column_link.hpp>
 #include <realm/column_linklist.hpp>
 #include <realm/column_backlink.hpp>
+#include <realm/column_statistics.hpp>
+#include <realm/range_index.hpp>
 #include <realm/index_string.hpp>
 #include <realm/group.hpp>
 #include <realm/link_view.hpp>
@@ -503,7 +505,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
     // Load from allocated memory
     m_top.set_parent(parent, ndx_in_parent);
     m_top.init_from_ref(top_ref);
-    REALM_ASSERT_3(m_top.size(), ==, 2);
+    REALM_ASSERT(m_top.size() >= 2 && m_top.size() <= 4);
 
     size_t spec_ndx_in_parent = 0;
     m_spec.manage(new Spec(get_alloc()));
@@ -944,6 +946,11 @@ void Table::do_insert_root_column(size_t ndx, ColumnType type, StringData name,
     size_t ndx_in_parent = info.m_column_ref_ndx;
     ref_type col_ref = create_column(type, m_size, nullable, m_columns.get_alloc()); // Throws
     m_columns.insert(ndx_in_parent, col_ref);                                        // Throws
+
+    // The range indexes are referred to by column index
+    Array refs(m_columns.get_alloc());
+    if (init_range_index_refs(refs) && ndx <= refs.size())
+        refs.insert(ndx, 0); // Throws
 }
 
 
@@ -965,6 +972,15 @@ void Table::do_erase_root_column(size_t ndx)
         Array::destroy_deep(index_ref, m_columns.get_alloc());
         m_columns.erase(ndx_in_parent);
     }
+
+    // The same goes for a range index, which is referred to by column index
+    Array refs(m_columns.get_alloc());
+    if (init_range_index_refs(refs) && ndx < refs.size()) {
+        ref_type index_ref = refs.get_as_ref(ndx);
+        refs.erase(ndx); // Throws
+        if (index_ref != 0)
+            Array::destroy_deep(index_ref, refs.get_alloc());
+    }
 }
 
 
@@ -1738,6 +1754,76 @@ void Table::remove_search_index(size_t col_ndx)
 }
 
 
+bool Table::has_range_index(size_t col_ndx) const noexcept
+{
+    // Utilize the guarantee that m_cols.size() == 0 for a detached table accessor.
+    if (REALM_UNLIKELY(col_ndx >= m_cols.size()))
+        return false;
+    return (m_spec->get_column_attr(col_ndx) & col_attr_RangeIndexed) != 0;
+}
+
+
+void Table::add_range_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(!is_group_level()))
+        throw LogicError(LogicError::wrong_kind_of_table);
+
+    if (REALM_UNLIKELY(col_ndx >= get_column_count()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    DataType type = get_column_type(col_ndx);
+    if (REALM_UNLIKELY(type != type_Int && type != type_Timestamp && type != type_Float && type != type_Double))
+        throw LogicError(LogicError::illegal_type);
+
+    int attr = m_spec->get_column_attr(col_ndx);
+    if (attr & col_attr_RangeIndexed)
+        return;
+
+    // Older versions of the library, which can open files of a format before
+    // 11, know neither the column attribute nor the range index
+    if (REALM_UNLIKELY(get_parent_group()->m_file_format_version < 11))
+        throw LogicError(LogicError::file_format_too_old);
+
+    m_spec->set_column_attr(col_ndx, ColumnAttr(attr | col_attr_RangeIndexed)); // Throws
+    build_range_index(col_ndx);                                                 // Throws
+    bump_version();
+
+    if (Replication* repl = get_repl())
+        repl->add_range_index(this, col_ndx); // Throws
+}
+
+
+void Table::remove_range_index(size_t col_ndx)
+{
+    if (REALM_UNLIKELY(!is_attached()))
+        throw LogicError(LogicError::detached_accessor);
+
+    if (REALM_UNLIKELY(col_ndx >= get_column_count()))
+        throw LogicError(LogicError::column_index_out_of_range);
+
+    int attr = m_spec->get_column_attr(col_ndx);
+    if (!(attr & col_attr_RangeIndexed))
+        return;
+
+    m_spec->set_column_attr(col_ndx, ColumnAttr(attr & ~col_attr_RangeIndexed)); // Throws
+
+    Array refs(m_top.get_alloc());
+    if (init_range_index_refs(refs) && col_ndx < refs.size()) {
+        if (ref_type index_ref = refs.get_as_ref(col_ndx)) {
+            refs.set(col_ndx, 0); // Throws
+            Array::destroy_deep(index_ref, refs.get_alloc());
+        }
+    }
+    bump_version();
+
+    if (Replication* repl = get_repl())
+        repl->remove_range_index(this, col_ndx); // Throws
+}
+
+
 void Table::_add_search_index(size_t col_ndx)
 {
     ColumnBase& col = get_column_base(col_ndx);
@@ -2204,6 +2290,7 @@ void Table::insert_empty_row(size_t row_ndx, size_t num_rows)
         bool insert_nulls = is_nullable(col_ndx);
         col.insert_rows(row_ndx, num_rows, m_size, insert_nulls); // Throws
     }
+    insert_into_range_indexes(row_ndx, num_rows, m_size); // Throws
     if (row_ndx < m_size)
         adj_row_acc_insert_rows(row_ndx, num_rows);
     m_size += num_rows;
@@ -2243,6 +2330,7 @@ size_t Table::add_row_with_key(size_t key_col_ndx, util::Optional<int64_t> key)
             col.insert_rows(row_ndx, 1, m_size, insert_nulls); // Throws
         }
     }
+    insert_into_range_indexes(row_ndx, 1, m_size); // Throws
     m_size++;
 
     if (Replication* repl = get_repl()) {
@@ -2288,6 +2376,7 @@ size_t Table::add_row_with_keys(size_t key_1_col_ndx, int64_t key_1,
             col.insert_rows(row_ndx, 1, m_size, insert_nulls); // Throws
         }
     }
+    insert_into_range_indexes(row_ndx, 1, m_size); // Throws
     m_size++;
 
     if (Replication* repl = get_repl()) {
@@ -2502,6 +2591,10 @@ void Table::do_remove(size_t row_ndx, bool broken_reciprocal_backlinks)
         repl->erase_rows(this, row_ndx, num_rows_to_erase, m_size, is_move_last_over); // Throws
     }
 
+    erase_from_range_indexes(row_ndx); // Throws
+    if (row_ndx + 1 < m_size)
+        adjust_range_indexes(row_ndx + 1, -1); // Throws
+
     for (size_t col_ndx = num_public_cols; col_ndx > 0; --col_ndx) {
         ColumnBase& col = get_column_base(col_ndx - 1);
         size_t prior_num_rows = m_size;
@@ -2544,13 +2637,19 @@ void Table::do_move_last_over(size_t row_ndx, bool broken_reciprocal_backlinks)
         repl->erase_rows(this, row_ndx, num_rows_to_erase, m_size, is_move_last_over); // Throws
     }
 
+    size_t last_row_ndx = m_size - 1;
+    erase_from_range_indexes(row_ndx); // Throws
+    if (row_ndx != last_row_ndx)
+        erase_from_range_indexes(last_row_ndx); // Throws
+
     for (size_t col_ndx = num_public_cols; col_ndx > 0; --col_ndx) {
         ColumnBase& col = get_column_base(col_ndx - 1);
         size_t prior_num_rows = m_size;
         col.move_last_row_over(row_ndx, prior_num_rows, broken_reciprocal_backlinks); // Throws
     }
 
-    size_t last_row_ndx = m_size - 1;
+    if (row_ndx != last_row_ndx)
+        reinsert_into_range_indexes(row_ndx); // Throws
     adj_row_acc_move_over(last_row_ndx, row_ndx);
     --m_size;
     bump_version();
@@ -2561,11 +2660,15 @@ void Table::do_swap_rows(size_t row_ndx_1, size_t row_ndx_2)
 {
     REALM_ASSERT(row_ndx_1 < row_ndx_2);
 
+    erase_from_range_indexes(row_ndx_1); // Throws
+    erase_from_range_indexes(row_ndx_2); // Throws
     size_t num_cols = m_spec->get_column_count();
     for (size_t col_ndx = 0; col_ndx != num_cols; ++col_ndx) {
         ColumnBase& col = get_column_base(col_ndx);
         col.swap_rows(row_ndx_1, row_ndx_2);
     }
+    reinsert_into_range_indexes(row_ndx_1); // Throws
+    reinsert_into_range_indexes(row_ndx_2); // Throws
     adj_row_acc_swap_rows(row_ndx_1, row_ndx_2);
     bump_version();
 }
@@ -2583,6 +2686,12 @@ void Table::do_move_row(size_t from_ndx, size_t to_ndx)
 
     adj_row_acc_move_row(from_ndx, to_ndx);
 
+    // The rows between the two positions shift by one towards the position that the moved row leaves
+    erase_from_range_indexes(from_ndx);     // Throws
+    adjust_range_indexes(from_ndx + 1, -1); // Throws
+    adjust_range_indexes(to_ndx, 1);        // Throws
+    size_t final_ndx = to_ndx;
+
     // Adjust the row indexes to compensate for the temporary row used
     if (from_ndx > to_ndx)
         ++from_ndx;
@@ -2599,6 +2708,7 @@ void Table::do_move_row(size_t from_ndx, size_t to_ndx)
         col.swap_rows(from_ndx, to_ndx);
         col.erase_rows(from_ndx, 1, m_size + 1, broken_reciprocal_backlinks);
     }
+    reinsert_into_range_indexes(final_ndx); // Throws
     bump_version();
 }
 
@@ -2619,6 +2729,8 @@ void Table::do_merge_rows(size_t row_ndx, size_t new_row_ndx)
     size_t row_ndx_1 = row_ndx, row_ndx_2 = new_row_ndx;
     if (row_ndx_1 > row_ndx_2)
         std::swap(row_ndx_1, row_ndx_2);
+    erase_from_range_indexes(row_ndx_1); // Throws
+    erase_from_range_indexes(row_ndx_2); // Throws
     size_t num_cols = m_spec->get_column_count();
     for (size_t col_ndx = 0; col_ndx != num_cols; ++col_ndx) {
         ColumnBase& col = get_column_base(col_ndx);
@@ -2628,6 +2740,8 @@ void Table::do_merge_rows(size_t row_ndx, size_t new_row_ndx)
         }
         col.swap_rows(row_ndx_1, row_ndx_2);
     }
+    reinsert_into_range_indexes(row_ndx_1); // Throws
+    reinsert_into_range_indexes(row_ndx_2); // Throws
 
     adj_row_acc_merge_rows(row_ndx, new_row_ndx);
     bump_version();
@@ -2678,6 +2792,7 @@ void Table::do_clear(bool broken_reciprocal_backlinks)
         ColumnBase& col = get_column_base(col_ndx);
         col.clear(m_size, broken_reciprocal_backlinks); // Throws
     }
+    clear_range_indexes(); // Throws
     m_size = 0;
 
     discard_row_accessors();
@@ -3162,11 +3277,11 @@ size_t Table::set_unique(size_t col_ndx, size_t ndx, int_fast64_t value)
 
     if (is_nullable(col_ndx)) {
         auto& col = get_column_int_null(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col_ndx, col, ndx, value, conflict); // Throws
     }
     else {
         auto& col = get_column(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col_ndx, col, ndx, value, conflict); // Throws
     }
 
     if (!conflict) {
@@ -3210,11 +3325,11 @@ size_t Table::set_unique(size_t col_ndx, size_t ndx, StringData value)
     // FIXME: String and StringEnum columns should have a common base class
     if (actual_type == ColumnType::col_type_String) {
         StringColumn& col = get_column_string(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col_ndx, col, ndx, value, conflict); // Throws
     }
     else {
         StringEnumColumn& col = get_column_string_enum(col_ndx);
-        ndx = do_set_unique(col, ndx, value, conflict); // Throws
+        ndx = do_set_unique(col_ndx, col, ndx, value, conflict); // Throws
     }
 
     if (!conflict) {
@@ -3249,7 +3364,7 @@ size_t Table::set_unique(size_t col_ndx, size_t row_ndx, null)
 
     // Only valid for int columns; use `set_string_unique` to set null strings
     auto& col = get_column_int_null(col_ndx);
-    row_ndx = do_set_unique_null(col, row_ndx, conflict); // Throws
+    row_ndx = do_set_unique_null(col_ndx, col, row_ndx, conflict); // Throws
 
     if (!conflict) {
         if (Replication* repl = get_repl())
@@ -3275,6 +3390,7 @@ void Table::set(size_t col_ndx, size_t ndx, int_fast64_t value, bool is_default)
     REALM_ASSERT_3(ndx, <, m_size);
     bump_version();
 
+    erase_from_range_index(col_ndx, ndx); // Throws
     if (is_nullable(col_ndx)) {
         auto& col = get_column_int_null(col_ndx);
         col.set(ndx, value);
@@ -3283,6 +3399,7 @@ void Table::set(size_t col_ndx, size_t ndx, int_fast64_t value, bool is_default)
         auto& col = get_column(col_ndx);
         col.set(ndx, value);
     }
+    reinsert_into_range_index(col_ndx, ndx); // Throws
 
     if (Replication* repl = get_repl())
         repl->set_int(this, col_ndx, ndx, value, is_default ? _impl::instr_SetDefault : _impl::instr_Set); // Throws
@@ -3299,8 +3416,10 @@ void Table::set(size_t col_ndx, size_t ndx, Timestamp value, bool is_default)
     if (!is_nullable(col_ndx) && value.is_null())
         throw LogicError(LogicError::column_not_nullable);
 
+    erase_from_range_index(col_ndx, ndx); // Throws
     TimestampColumn& col = get_column<TimestampColumn, col_type_Timestamp>(col_ndx);
     col.set(ndx, value);
+    reinsert_into_range_index(col_ndx, ndx); // Throws
 
     if (Replication* repl = get_repl()) {
         if (value.is_null())
@@ -3361,8 +3480,10 @@ void Table::set(size_t col_ndx, size_t ndx, float value, bool is_default)
     REALM_ASSERT_3(ndx, <, m_size);
     bump_version();
 
+    erase_from_range_index(col_ndx, ndx); // Throws
     FloatColumn& col = get_column_float(col_ndx);
     col.set(ndx, value);
+    reinsert_into_range_index(col_ndx, ndx); // Throws
 
     if (Replication* repl = get_repl())
         repl->set_float(this, col_ndx, ndx, value, is_default ? _impl::instr_SetDefault : _impl::instr_Set); // Throws
@@ -3375,8 +3496,10 @@ void Table::set(size_t col_ndx, size_t ndx, double value, bool is_default)
     REALM_ASSERT_3(ndx, <, m_size);
     bump_version();
 
+    erase_from_range_index(col_ndx, ndx); // Throws
     DoubleColumn& col = get_column_double(col_ndx);
     col.set(ndx, value);
+    reinsert_into_range_index(col_ndx, ndx); // Throws
 
     if (Replication* repl = get_repl())
         repl->set_double(this, col_ndx, ndx, value,
@@ -3482,8 +3605,10 @@ void Table::set(size_t col_ndx, size_t row_ndx, null, bool is_default)
     REALM_ASSERT_3(row_ndx, <, m_size);
 
     bump_version();
+    erase_from_range_index(col_ndx, row_ndx); // Throws
     ColumnBase& col = get_column_base(col_ndx);
     col.set_null(row_ndx);
+    reinsert_into_range_index(col_ndx, row_ndx); // Throws
 
     if (Replication* repl = get_repl())
         repl->set_null(this, col_ndx, row_ndx, is_default ? _impl::instr_SetDefault : _impl::instr_Set); // Throws
@@ -3576,18 +3701,22 @@ size_t Table::do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict
 }
 
 template <class ColType>
-size_t Table::do_set_unique_null(ColType& col, size_t ndx, bool& conflict)
+size_t Table::do_set_unique_null(size_t col_ndx, ColType& col, size_t ndx, bool& conflict)
 {
     ndx = do_find_unique(col, ndx, null{}, conflict);
+    erase_from_range_index(col_ndx, ndx); // Throws
     col.set_null(ndx);
+    reinsert_into_range_index(col_ndx, ndx); // Throws
     return ndx;
 }
 
 template <class ColType, class T>
-size_t Table::do_set_unique(ColType& col, size_t ndx, T&& value, bool& conflict)
+size_t Table::do_set_unique(size_t col_ndx, ColType& col, size_t ndx, T&& value, bool& conflict)
 {
     ndx = do_find_unique(col, ndx, value, conflict);
+    erase_from_range_index(col_ndx, ndx); // Throws
     col.set(ndx, value);
+    reinsert_into_range_index(col_ndx, ndx); // Throws
     return ndx;
 }
 
@@ -3607,7 +3736,9 @@ void Table::add_int(size_t col_ndx, size_t ndx, int_fast64_t value)
         auto& col = get_column_int_null(col_ndx);
         Optional<int64_t> old = col.get(ndx);
         if (old) {
+            erase_from_range_index(col_ndx, ndx); // Throws
             col.set(ndx, add_wrap(*old, value));
+            reinsert_into_range_index(col_ndx, ndx); // Throws
         }
         else {
             throw LogicError{LogicError::illegal_combination};
@@ -3616,7 +3747,9 @@ void Table::add_int(size_t col_ndx, size_t ndx, int_fast64_t value)
     else {
         auto& col = get_column(col_ndx);
         int64_t old = col.get(ndx);
+        erase_from_range_index(col_ndx, ndx); // Throws
         col.set(ndx, add_wrap(old, value));
+        reinsert_into_range_index(col_ndx, ndx); // Throws
     }
 
     if (Replication* repl = get_repl())
@@ -4392,6 +4525,22 @@ ConstTableView Table::get_distinct_view(size_t col_ndx) const
 TableView Table::get_sorted_view(size_t col_ndx, bool ascending)
 {
     TableView tv = where().find_all();
+
+    // A range index of an int or timestamp column lists all rows in the order that the sort would put them in,
+    // with nulls first, and equal values in the order of their rows
+    std::unique_ptr<RangeIndex> index;
+    ColumnType type = get_real_column_type(col_ndx);
+    if (ascending && (type == col_type_Int || type == col_type_Timestamp))
+        index = get_range_index(col_ndx); // Throws
+    if (index && index->size() == tv.size()) {
+        tv.m_descriptor_ordering.append_sort(SortDescriptor(*this, {{col_ndx}}, {ascending})); // Throws
+        tv.m_row_indexes.clear();
+        size_t n = index->size();
+        for (size_t i = 0; i < n; ++i)
+            tv.m_row_indexes.add(index->get(i)); // Throws
+        return tv;
+    }
+
     tv.sort(col_ndx, ascending);
     return tv;
 }
@@ -4956,7 +5105,7 @@ public:
             for (size_t i = 0; i != n; ++i) {
                 int attr = spec.get_column_attr(i);
                 // Remove any index specifying attributes
-                attr &= ~(col_attr_Indexed | col_attr_Unique);
+                attr &= ~(col_attr_Indexed | col_attr_Unique | col_attr_RangeIndexed);
                 spec.set_column_attr(i, ColumnAttr(attr)); // Throws
             }
             bool deep = true;                                         // Deep
@@ -5041,6 +5190,289 @@ void Table::write(std::ostream& out, size_t offset, size_t slice_size, StringDat
 }
 
 
+bool Table::get_column_statistics(size_t col_ndx, ColumnStatistics& stats) const
+{
+    if (!m_top.is_attached() || m_top.size() < 3)
+        return false;
+
+    Allocator& alloc = m_top.get_alloc();
+    ref_type ref = m_top.get_as_ref(2);
+    if (ref == 0)
+        return false;
+    Array all_stats(alloc);
+    all_stats.init_from_ref(ref);
+    if (col_ndx >= all_stats.size())
+        return false;
+    ref_type stats_ref = all_stats.get_as_ref(col_ndx);
+    if (stats_ref == 0)
+        return false;
+
+    stats.read(alloc, stats_ref); // Throws
+    return true;
+}
+
+
+std::unique_ptr<RangeIndex> Table::get_range_index(size_t col_ndx) const
+{
+    if (!m_top.is_attached() || m_top.size() < 4 || !has_range_index(col_ndx))
+        return nullptr;
+
+    Allocator& alloc = m_top.get_alloc();
+    ref_type ref = m_top.get_as_ref(3);
+    if (ref == 0)
+        return nullptr;
+    Array all_indexes(alloc);
+    all_indexes.init_from_ref(ref);
+    if (col_ndx >= all_indexes.size())
+        return nullptr;
+    ref_type index_ref = all_indexes.get_as_ref(col_ndx);
+    if (index_ref == 0)
+        return nullptr;
+
+    return std::unique_ptr<RangeIndex>(new RangeIndex(alloc, index_ref)); // Throws
+}
+
+
+// Replace the array in slot `top_ndx` of m_top, which has one ref for each column, by one that refers to
+// `create(col_ndx, column, old_ref)` for each column for which `wanted(col_ndx)` is true, and to nothing for the
+// others. Columns whose root array is in read-only memory have not been modified since the last commit, and keep the
+// ref they had. For the others, `old_ref` is the ref they had, which is destroyed afterwards, or zero. If the spec was
+// modified, however, columns may have been inserted, removed or moved, so all refs are created anew, from nothing.
+template <class W, class C>
+void Table::update_per_column_refs(size_t top_ndx, W wanted, C create)
+{
+    REALM_ASSERT(m_top.is_attached());
+    Allocator& alloc = m_top.get_alloc();
+
+    Array old_refs(alloc);
+    if (m_top.size() > top_ndx) {
+        if (ref_type ref = m_top.get_as_ref(top_ndx))
+            old_refs.init_from_ref(ref);
+    }
+    size_t num_old_refs = old_refs.is_attached() ? old_refs.size() : 0;
+    bool schema_changed = !alloc.is_read_only(m_spec->get_ref());
+
+    size_t num_cols = m_spec->get_column_count();
+    std::vector<ref_type> refs(num_cols, 0);     // Throws
+    std::vector<bool> created(num_cols, false); // Throws
+    bool changed = num_old_refs != num_cols;
+    try {
+        for (size_t i = 0; i < num_cols; ++i) {
+            ref_type old_ref = i < num_old_refs ? old_refs.get_as_ref(i) : 0;
+            if (!wanted(i)) {
+                changed = changed || old_ref != 0;
+                continue;
+            }
+
+            const ColumnBase& column = get_column_base(i);
+            if (old_ref != 0 && !schema_changed && alloc.is_read_only(column.get_ref())) {
+                refs[i] = old_ref;
+                continue;
+            }
+
+            refs[i] = create(i, column, schema_changed ? 0 : old_ref); // Throws
+            created[i] = true;
+            changed = true;
+        }
+        if (!changed || (num_old_refs == 0 && std::count(refs.begin(), refs.end(), 0) == std::ptrdiff_t(num_cols)))
+            return;
+
+        Array new_refs(alloc);
+        new_refs.create(Array::type_HasRefs); // Throws
+        _impl::ShallowArrayDestroyGuard dg(&new_refs);
+        for (ref_type ref : refs)
+            new_refs.add(from_ref(ref)); // Throws
+        while (m_top.size() < top_ndx)
+            m_top.add(0); // Throws
+        if (m_top.size() == top_ndx) {
+            m_top.add(from_ref(new_refs.get_ref())); // Throws
+        }
+        else {
+            m_top.set(top_ndx, from_ref(new_refs.get_ref())); // Throws
+        }
+        dg.release();
+    }
+    catch (...) {
+        for (size_t i = 0; i < num_cols; ++i) {
+            if (created[i])
+                Array::destroy_deep(refs[i], alloc);
+        }
+        throw;
+    }
+
+    // Free the arrays that were replaced
+    if (old_refs.is_attached()) {
+        for (size_t i = 0; i < num_old_refs; ++i) {
+            ref_type old_ref = old_refs.get_as_ref(i);
+            if (old_ref != 0 && (i >= num_cols || refs[i] != old_ref))
+                Array::destroy_deep(old_ref, alloc);
+        }
+        old_refs.destroy();
+    }
+}
+
+
+void Table::update_column_statistics()
+{
+    auto wanted = [&](size_t col_ndx) {
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        return type == col_type_Int || type == col_type_Bool || type == col_type_OldDateTime;
+    };
+    auto create = [&](size_t col_ndx, const ColumnBase& column, ref_type old_ref) {
+        // Sampling the column again is only worth it when a large part of it has been modified
+        ColumnStatistics stats;
+        if (old_ref != 0) {
+            stats.read(m_top.get_alloc(), old_ref); // Throws
+            stats.modified_count += ColumnStatistics::count_modified_rows(column);
+        }
+        if (old_ref == 0 || stats.is_stale()) {
+            if (is_nullable(col_ndx)) {
+                stats = ColumnStatistics::compute(static_cast<const IntNullColumn&>(column)); // Throws
+            }
+            else {
+                stats = ColumnStatistics::compute(static_cast<const IntegerColumn&>(column)); // Throws
+            }
+        }
+        return stats.write(m_top.get_alloc()); // Throws
+    };
+    update_per_column_refs(2, wanted, create); // Throws
+}
+
+
+// Attach `refs` to the array in the 4th slot of m_top, which refers to the range indexes. Returns false if there is
+// none.
+bool Table::init_range_index_refs(Array& refs) noexcept
+{
+    if (!m_top.is_attached() || m_top.size() < 4 || m_top.get_as_ref(3) == 0)
+        return false;
+    refs.set_parent(&m_top, 3);
+    refs.init_from_parent();
+    return true;
+}
+
+
+// Call `func(index, col_ndx)` for the range index of the specified column, or of every column if `col_ndx` is npos.
+template <class F>
+void Table::for_each_range_index(size_t col_ndx, F func)
+{
+    Array refs(m_top.get_alloc());
+    if (!init_range_index_refs(refs))
+        return;
+    size_t begin = col_ndx == npos ? 0 : col_ndx;
+    size_t end = col_ndx == npos ? refs.size() : std::min(col_ndx + 1, refs.size());
+    for (size_t i = begin; i < end; ++i) {
+        ref_type index_ref = refs.get_as_ref(i);
+        if (index_ref == 0)
+            continue;
+        RangeIndex index(refs.get_alloc(), index_ref);
+        index.set_parent(&refs, i);
+        func(index, i); // Throws
+    }
+}
+
+
+void Table::insert_into_range_indexes(size_t row_ndx, size_t num_rows, size_t prior_num_rows)
+{
+    for_each_range_index(npos, [&](RangeIndex& index, size_t col_ndx) {
+        if (row_ndx < prior_num_rows)
+            index.adjust_row_indexes(row_ndx, int_fast64_t(num_rows)); // Throws
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        index.insert(get_column_base(col_ndx), type, is_nullable(col_ndx), row_ndx, num_rows); // Throws
+    });
+}
+
+
+void Table::reinsert_into_range_indexes(size_t row_ndx)
+{
+    for_each_range_index(npos, [&](RangeIndex& index, size_t col_ndx) {
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        index.insert(get_column_base(col_ndx), type, is_nullable(col_ndx), row_ndx); // Throws
+    });
+}
+
+
+void Table::erase_from_range_indexes(size_t row_ndx)
+{
+    for_each_range_index(npos, [&](RangeIndex& index, size_t col_ndx) {
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        index.erase(get_column_base(col_ndx), type, is_nullable(col_ndx), row_ndx); // Throws
+    });
+}
+
+
+void Table::adjust_range_indexes(size_t row_ndx, int_fast64_t diff)
+{
+    for_each_range_index(npos, [&](RangeIndex& index, size_t) {
+        index.adjust_row_indexes(row_ndx, diff); // Throws
+    });
+}
+
+
+void Table::clear_range_indexes()
+{
+    for_each_range_index(npos, [&](RangeIndex& index, size_t) {
+        index.clear(); // Throws
+    });
+}
+
+
+void Table::reinsert_into_range_index(size_t col_ndx, size_t row_ndx)
+{
+    if (!has_range_index(col_ndx))
+        return;
+    for_each_range_index(col_ndx, [&](RangeIndex& index, size_t) {
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        index.insert(get_column_base(col_ndx), type, is_nullable(col_ndx), row_ndx); // Throws
+    });
+}
+
+
+void Table::erase_from_range_index(size_t col_ndx, size_t row_ndx)
+{
+    if (!has_range_index(col_ndx))
+        return;
+    for_each_range_index(col_ndx, [&](RangeIndex& index, size_t) {
+        ColumnType type = m_spec->get_column_type(col_ndx);
+        index.erase(get_column_base(col_ndx), type, is_nullable(col_ndx), row_ndx); // Throws
+    });
+}
+
+
+void Table::build_range_index(size_t col_ndx)
+{
+    Allocator& alloc = m_top.get_alloc();
+    ColumnType type = m_spec->get_column_type(col_ndx);
+    ref_type index_ref = RangeIndex::create(get_column_base(col_ndx), type, is_nullable(col_ndx), alloc); // Throws
+    _impl::DeepArrayRefDestroyGuard dg(index_ref, alloc);
+
+    Array refs(alloc);
+    if (!init_range_index_refs(refs)) {
+        size_t num_cols = m_spec->get_column_count();
+        refs.create(Array::type_HasRefs, false, num_cols, 0); // Throws
+        _impl::ShallowArrayDestroyGuard dg_2(&refs);
+        while (m_top.size() < 3)
+            m_top.add(0); // Throws
+        if (m_top.size() == 3) {
+            m_top.add(from_ref(refs.get_ref())); // Throws
+        }
+        else {
+            m_top.set(3, from_ref(refs.get_ref())); // Throws
+        }
+        dg_2.release();
+        refs.set_parent(&m_top, 3);
+    }
+    // Columns that were added after the array was created have no slot yet
+    while (refs.size() <= col_ndx)
+        refs.add(0); // Throws
+    if (ref_type old_ref = refs.get_as_ref(col_ndx)) {
+        refs.set(col_ndx, 0); // Throws
+        Array::destroy_deep(old_ref, alloc);
+    }
+    refs.set(col_ndx, from_ref(index_ref)); // Throws
+    dg.release();
+}
+
+
 void Table::update_from_parent(size_t old_baseline) noexcept
 {
     REALM_ASSERT(is_attached());
@@ -6097,6 +6529,38 @@ void Table::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexce
 }
 
 
+void Table::adj_views_changed_rows(size_t row_ndx, size_t num_rows) noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->record_changed_rows(row_ndx, num_rows);
+    }
+}
+
+
+void Table::adj_views_discard_changes() noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->discard_changed_rows();
+    }
+}
+
+
+void Table::adj_views_changes_recorded(uint_fast64_t prior_version) noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    if (m_views.empty())
+        return;
+    for (auto& view : m_views) {
+        view->adj_changes_version(prior_version, m_version);
+    }
+    // Changes made through this accessor are not recorded, so they must bump the version of the table beyond the
+    // one that the views have recorded the changes up to
+    m_top.get_alloc().observe_version();
+}
+
+
 void Table::adj_insert_column(size_t col_ndx)
 {
     // Beyond the constraints on the specified column index, this function must
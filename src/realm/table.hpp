@@ -44,6 +44,8 @@ class BacklinkColumn;
 template <class>
 class BacklinkCount;
 class BinaryColumy;
+class ColumnStatistics;
+class RangeIndex;
 class ConstTableView;
 class Group;
 class LinkColumn;
@@ -253,6 +255,38 @@ public:
     void add_search_index(size_t column_ndx);
     void remove_search_index(size_t column_ndx);
 
+    //@}
+    //@{
+
+    /// has_range_index() returns true if, and only if a range index has been
+    /// added to the specified column. Rather than throwing, it returns false if
+    /// the table accessor is detached or the specified index is out of range.
+    ///
+    /// add_range_index() adds a range index to the specified column, which
+    /// must be of type int, timestamp, float or double. A range index lists
+    /// the rows of the table in the order of their values in the column. It
+    /// lets queries find the rows that satisfy an `==`, `>`, `>=`, `<` or `<=`
+    /// condition on the column without scanning it, when those rows are few,
+    /// and it lets get_sorted_view() skip the sorting of an int or timestamp
+    /// column in ascending order. It has no effect if a range index has already
+    /// been added to the specified column (idempotency).
+    ///
+    /// remove_range_index() removes the range index from the specified column.
+    /// It has no effect if the specified column has no range index.
+    ///
+    /// Like a search index, a range index is updated as the table is
+    /// modified. It is stored in a part of the table that only exists in file
+    /// format 11, so this table must be a group-level table, and
+    /// add_range_index() throws LogicError::file_format_too_old if the file is
+    /// kept in an older format (see
+    /// Group::get_target_file_format_version_for_session()).
+    ///
+    /// \param column_ndx The index of a column of the table.
+
+    bool has_range_index(size_t column_ndx) const noexcept;
+    void add_range_index(size_t column_ndx);
+    void remove_range_index(size_t column_ndx);
+
     //@}
 
     //@{
@@ -824,6 +858,19 @@ public:
     // enforce == false will auto-evaluate if they should be enumerated or not
     void optimize(bool enforce = false);
 
+    /// Get the statistics of an integer (or bool or OldDateTime) column as of
+    /// the last commit that sampled it (see ColumnStatistics). Returns false
+    /// if none are available, which is always the case for subtables, for
+    /// tables that are not part of a file, and for files in a format older
+    /// than 11. Within a write transaction, they do not reflect modifications
+    /// made by the transaction.
+    bool get_column_statistics(size_t column_ndx, ColumnStatistics&) const;
+
+    /// Get the range index of the specified column (see add_range_index()),
+    /// or null if the column has none, or if the file is in a format older
+    /// than 11.
+    std::unique_ptr<RangeIndex> get_range_index(size_t column_ndx) const;
+
     /// Write this table (or a slice of this table) to the specified
     /// output stream.
     ///
@@ -984,6 +1031,10 @@ private:
     // degenerate state in a different way.
     Array m_top;
     Array m_columns; // 2nd slot in m_top (for root tables)
+    // The 3rd slot in m_top is optional, and refers to the column statistics
+    // (see get_column_statistics()). It has one entry for each column, which
+    // is zero for columns without statistics. The 4th slot is optional too,
+    // and refers to the range indexes (see get_range_index()) in the same way.
 
     // Management class for the spec object. Only if the table has an independent
     // spec, the spec object should be deleted when the table object is deleted.
@@ -1107,9 +1158,9 @@ private:
     template <class ColType, class T>
     size_t do_find_unique(ColType& col, size_t ndx, T&& value, bool& conflict);
     template <class ColType>
-    size_t do_set_unique_null(ColType& col, size_t ndx, bool& conflict);
+    size_t do_set_unique_null(size_t col_ndx, ColType& col, size_t ndx, bool& conflict);
     template <class ColType, class T>
-    size_t do_set_unique(ColType& column, size_t row_ndx, T&& value, bool& conflict);
+    size_t do_set_unique(size_t col_ndx, ColType& column, size_t row_ndx, T&& value, bool& conflict);
 
     void _add_search_index(size_t column_ndx);
     void _remove_search_index(size_t column_ndx);
@@ -1225,6 +1276,33 @@ private:
     /// when the transaction ends.
     void update_from_parent(size_t old_baseline) noexcept;
 
+    /// Called by Group when a transaction is committed. Adds the modified
+    /// rows to the statistics of the integer columns that were modified, and
+    /// computes them anew when they are stale, or when the schema was
+    /// changed. The statistics of the other columns are kept.
+    void update_column_statistics();
+
+    // Range indexes (see get_range_index()) are kept in step with the values
+    // of their columns. A row must be erased from the indexes before its
+    // values change, and inserted into them afterwards.
+    bool init_range_index_refs(Array& refs) noexcept;
+    template <class F>
+    void for_each_range_index(size_t col_ndx, F func);
+    void insert_into_range_indexes(size_t row_ndx, size_t num_rows, size_t prior_num_rows);
+    void reinsert_into_range_indexes(size_t row_ndx);
+    void erase_from_range_indexes(size_t row_ndx);
+    void adjust_range_indexes(size_t row_ndx, int_fast64_t diff);
+    void clear_range_indexes();
+    void reinsert_into_range_index(size_t col_ndx, size_t row_ndx);
+    void erase_from_range_index(size_t col_ndx, size_t row_ndx);
+
+    /// Build the range index of the specified column, replacing the one it
+    /// has, if any.
+    void build_range_index(size_t col_ndx);
+
+    template <class W, class C>
+    void update_per_column_refs(size_t top_ndx, W wanted, C create);
+
     // Support function for conversions
     void to_string_header(std::ostream& out, std::vector<size_t>& widths) const;
     void to_string_row(size_t row_ndx, std::ostream& out, const std::vector<size_t>& widths) const;
@@ -1525,6 +1603,18 @@ private:
     /// Called by adj_acc_move_over() to adjust row accessors.
     void adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept;
 
+    /// Record the changes applied by Group::advance_transact() in the views
+    /// of this table which are synchronized incrementally (see
+    /// TableViewBase::set_incremental_sync()). adj_views_changed_rows()
+    /// records that rows were inserted or modified, and
+    /// adj_views_discard_changes() that the table was changed in a way that
+    /// the views cannot follow. adj_views_changes_recorded() must be called
+    /// once the version of this table has been bumped from `prior_version`
+    /// for the advance.
+    void adj_views_changed_rows(size_t row_ndx, size_t num_rows) noexcept;
+    void adj_views_discard_changes() noexcept;
+    void adj_views_changes_recorded(uint_fast64_t prior_version) noexcept;
+
     void adj_insert_column(size_t col_ndx);
     void adj_erase_column(size_t col_ndx) noexcept;
 
@@ -2461,6 +2551,11 @@ public:
         table.update_from_parent(old_baseline);
     }
 
+    static void update_column_statistics(Table& table)
+    {
+        table.update_column_statistics(); // Throws
+    }
+
     static void detach(Table& table) noexcept
     {
         table.detach();
@@ -2676,6 +2771,26 @@ public:
         table.adj_acc_clear_root_table();
     }
 
+    static void adj_views_changed_rows(Table& table, size_t row_ndx, size_t num_rows) noexcept
+    {
+        table.adj_views_changed_rows(row_ndx, num_rows);
+    }
+
+    static void adj_views_discard_changes(Table& table) noexcept
+    {
+        table.adj_views_discard_changes();
+    }
+
+    static void adj_views_changes_recorded(Table& table, uint_fast64_t prior_version) noexcept
+    {
+        table.adj_views_changes_recorded(prior_version);
+    }
+
+    static uint_fast64_t get_version(const Table& table) noexcept
+    {
+        return table.m_version;
+    }
+
     static void adj_acc_clear_nonroot_table(Table& table) noexcept
     {
         table.adj_acc_clear_nonroot_table();
@@ -23,10 +23,22 @@
 #include <realm/column_tpl.hpp>
 #include <realm/impl/sequential_getter.hpp>
 
+#include <algorithm>
 #include <unordered_set>
 
 using namespace realm;
 
+namespace {
+
+// A view is synchronized in full rather than incrementally when more than one in this many rows of the table were
+// changed, as rerunning the query is then about as fast
+const size_t incremental_sync_max_change_ratio = 8;
+
+// At most this many changed rows are recorded for a view, after which it will be synchronized in full
+const size_t max_recorded_changes = 1000000;
+
+} // anonymous namespace
+
 TableViewBase::TableViewBase(TableViewBase& src, HandoverPatch& patch, MutableSourcePayload mode)
     : RowIndexes(src, mode)
     , m_linked_column(src.m_linked_column)
@@ -553,9 +565,23 @@ uint_fast64_t TableViewBase::sync_if_needed() const
 }
 
 
+void TableViewBase::set_incremental_sync(bool enable) noexcept
+{
+    m_incremental_sync = enable;
+    m_changed_rows.clear();
+    // Changes can only be recorded from here on
+    m_changes_version = util::none;
+    if (enable && m_table && is_in_sync())
+        m_changes_version = m_last_seen_version;
+}
+
 void TableViewBase::adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept
 {
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx), num_rows);
+    for (auto& changed_row : m_changed_rows) {
+        if (changed_row >= row_ndx)
+            changed_row += num_rows;
+    }
 }
 
 
@@ -570,6 +596,12 @@ void TableViewBase::adj_row_acc_erase_row(size_t row_ndx) noexcept
         m_row_indexes.set(it, -1);
     }
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx) + 1, -1);
+
+    m_changed_rows.erase(std::remove(m_changed_rows.begin(), m_changed_rows.end(), row_ndx), m_changed_rows.end());
+    for (auto& changed_row : m_changed_rows) {
+        if (changed_row > row_ndx)
+            --changed_row;
+    }
 }
 
 
@@ -592,6 +624,12 @@ void TableViewBase::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx
             break;
         m_row_indexes.set(it, to_row_ndx);
     }
+
+    // The moved row counts as changed, as its place among the other rows is not the same
+    m_changed_rows.erase(std::remove(m_changed_rows.begin(), m_changed_rows.end(), to_row_ndx),
+                         m_changed_rows.end());
+    std::replace(m_changed_rows.begin(), m_changed_rows.end(), from_row_ndx, to_row_ndx);
+    record_changed_rows(to_row_ndx, 1);
 }
 
 
@@ -611,6 +649,9 @@ void TableViewBase::adj_row_acc_swap_rows(size_t row_ndx_1, size_t row_ndx_2) no
             it_2 = m_row_indexes.find_first(row_ndx_2, it_2);
         }
     }
+
+    record_changed_rows(row_ndx_1, 1);
+    record_changed_rows(row_ndx_2, 1);
 }
 
 
@@ -626,6 +667,9 @@ void TableViewBase::adj_row_acc_move_row(size_t from_row_ndx, size_t to_row_ndx)
     while ((it = m_row_indexes.find_first(from_row_ndx, it)) != not_found)
         m_row_indexes.set(it, to_row_ndx);
     m_row_indexes.adjust_ge(int_fast64_t(from_row_ndx), -1);
+
+    // All the rows in between are moved, so the view is better off synchronized in full
+    discard_changed_rows();
 }
 
 
@@ -634,6 +678,44 @@ void TableViewBase::adj_row_acc_clear() noexcept
     m_num_detached_refs = m_row_indexes.size();
     for (size_t i = 0, num_rows = m_row_indexes.size(); i < num_rows; ++i)
         m_row_indexes.set(i, -1);
+    m_changed_rows.clear();
+}
+
+
+void TableViewBase::record_changed_rows(size_t row_ndx, size_t num_rows) noexcept
+{
+    if (!m_changes_version)
+        return;
+    if (m_changed_rows.size() + num_rows > max_recorded_changes) {
+        discard_changed_rows();
+        return;
+    }
+    try {
+        for (size_t i = 0; i < num_rows; ++i)
+            m_changed_rows.push_back(row_ndx + i); // Throws
+    }
+    catch (...) {
+        discard_changed_rows();
+    }
+}
+
+
+void TableViewBase::discard_changed_rows() noexcept
+{
+    m_changes_version = util::none;
+    m_changed_rows.clear();
+}
+
+
+void TableViewBase::adj_changes_version(uint_fast64_t prior_version, uint_fast64_t version) noexcept
+{
+    // If the table was changed by other means since the changes were last recorded, some changes were missed
+    if (m_changes_version && *m_changes_version == prior_version) {
+        m_changes_version = version;
+    }
+    else {
+        discard_changed_rows();
+    }
 }
 
 
@@ -744,7 +826,12 @@ void TableViewBase::do_sync()
     // - Table::get_backlink_view()
     // Here we sync with the respective source.
 
-    if (m_linkview_source) {
+    bool incremental = can_sync_incrementally();
+    size_t num_discarded = 0;
+    if (incremental) {
+        do_sync_incrementally();
+    }
+    else if (m_linkview_source) {
         m_row_indexes.clear();
         for (size_t t = 0; t < m_linkview_source->size(); t++)
             m_row_indexes.add(m_linkview_source->get(t).get_index());
@@ -779,13 +866,98 @@ void TableViewBase::do_sync()
         if (m_query.m_view)
             m_query.m_view->sync_if_needed();
 
-        m_query.find_all(*const_cast<TableViewBase*>(this), m_start, m_end, m_limit);
+        // When the view is sorted and then limited, the matches that cannot make it past the limit are discarded
+        // as they are found
+        if (m_descriptor_ordering.size() >= 2 && m_descriptor_ordering.descriptor_is_sort(0) &&
+            m_descriptor_ordering.descriptor_is_limit(1) && m_descriptor_ordering[0]->is_valid()) {
+            const auto& sort = static_cast<const SortDescriptor&>(*m_descriptor_ordering[0]);
+            size_t top = static_cast<const LimitDescriptor&>(*m_descriptor_ordering[1]).get_limit();
+            num_discarded = m_query.find_all_top(*this, m_start, m_end, m_limit, sort, top);
+        }
+        else {
+            m_query.find_all(*const_cast<TableViewBase*>(this), m_start, m_end, m_limit);
+        }
     }
     m_num_detached_refs = 0;
 
-    do_sort(m_descriptor_ordering);
+    if (!incremental)
+        do_sort(m_descriptor_ordering);
+    m_limit_count += num_discarded;
+
+    // Large results take up much less memory this way, especially when most of the rows of the table match
+    m_row_indexes.encode_leaves(); // Throws
 
     m_last_seen_version = outside_version();
+    m_changed_rows.clear();
+    m_changes_version = util::none;
+    if (m_incremental_sync)
+        m_changes_version = m_last_seen_version;
+}
+
+bool TableViewBase::can_sync_incrementally() const
+{
+    if (!m_changes_version || !m_table || *m_changes_version != outside_version())
+        return false;
+
+    // Only the changes to the rows of m_table are recorded, so the view must not depend on anything else
+    if (!m_query.m_table || m_query.m_view || m_linkview_source || m_linked_column ||
+        m_distinct_column_source != npos)
+        return false;
+    if (m_start != 0 || m_end != size_t(-1) || m_limit != size_t(-1))
+        return false;
+    size_t num_descriptors = m_descriptor_ordering.size();
+    if (num_descriptors > 1 || (num_descriptors == 1 && !m_descriptor_ordering.descriptor_is_sort(0)))
+        return false;
+    const Spec& spec = _impl::TableFriend::get_spec(*m_table);
+    for (size_t i = 0; i < spec.get_column_count(); ++i) {
+        ColumnType type = spec.get_column_type(i);
+        if (type == col_type_Link || type == col_type_LinkList || type == col_type_BackLink)
+            return false;
+    }
+
+    return m_changed_rows.size() <= m_table->size() / incremental_sync_max_change_ratio;
+}
+
+void TableViewBase::do_sync_incrementally()
+{
+    std::vector<size_t>& changed_rows = m_changed_rows;
+    std::sort(changed_rows.begin(), changed_rows.end());
+    changed_rows.erase(std::unique(changed_rows.begin(), changed_rows.end()), changed_rows.end());
+
+    m_query.init();
+    auto is_match = [&](size_t row_ndx) { return m_query.peek_tablerow(row_ndx) != not_found; };
+
+    if (m_descriptor_ordering.is_empty() || !m_descriptor_ordering[0]->is_valid()) {
+        // The rows are in table order, except for rows that were moved, which count as changed. Once the changed
+        // rows are taken out, the ones which match can be put back in place one by one.
+        for (size_t ndx = m_row_indexes.size(); ndx > 0; --ndx) {
+            int64_t row_ndx = m_row_indexes.get(ndx - 1);
+            if (row_ndx == -1 || std::binary_search(changed_rows.begin(), changed_rows.end(), size_t(row_ndx)))
+                m_row_indexes.erase(ndx - 1);
+        }
+        for (size_t row_ndx : changed_rows) {
+            if (is_match(row_ndx))
+                m_row_indexes.insert(m_row_indexes.lower_bound(int64_t(row_ndx)), int64_t(row_ndx));
+        }
+    }
+    else {
+        // The rows which were not changed stay in order, and the changed rows which match are merged in among them
+        std::vector<size_t> rows;
+        rows.reserve(m_row_indexes.size());
+        for (size_t i = 0; i < m_row_indexes.size(); ++i) {
+            int64_t row_ndx = m_row_indexes.get(i);
+            if (row_ndx != -1 && !std::binary_search(changed_rows.begin(), changed_rows.end(), size_t(row_ndx)))
+                rows.push_back(size_t(row_ndx));
+        }
+        size_t num_sorted = rows.size();
+        for (size_t row_ndx : changed_rows) {
+            if (is_match(row_ndx))
+                rows.push_back(row_ndx);
+        }
+        const auto& sort = static_cast<const SortDescriptor&>(*m_descriptor_ordering[0]);
+        merge_sorted_rows(sort, rows, num_sorted);
+    }
+    m_num_detached_refs = 0;
 }
 
 bool TableViewBase::is_in_table_order() const
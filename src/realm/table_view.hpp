@@ -287,6 +287,14 @@ public:
     // if the TableView depends on an object (LinkView or row) that has been deleted.
     uint_fast64_t sync_if_needed() const;
 
+    // Let sync_if_needed() bring the view up to date with the changes that were applied by advancing the read
+    // transaction (or promoting it to a write transaction), rather than by rerunning the query: only the rows which
+    // the changes touched are tested against the query, and put in place among the rows of the view. This applies to
+    // views of a query that is not restricted to a view, a range or a limit, on a table without links or backlinks,
+    // which are sorted by a single sort descriptor or not at all. Other views, and views of a table that was changed
+    // by a write transaction of this SharedGroup since they were last synchronized, are synchronized in full.
+    void set_incremental_sync(bool enable) noexcept;
+
     // Sort m_row_indexes according to one column
     void sort(size_t column, bool ascending = true);
 
@@ -331,6 +339,11 @@ protected:
 
     void do_sync();
 
+    unsigned int get_sort_threads() const noexcept override
+    {
+        return m_query.get_threads();
+    }
+
     // Null if, and only if, the view is detached.
     mutable TableRef m_table;
 
@@ -360,6 +373,14 @@ protected:
     mutable util::Optional<uint_fast64_t> m_last_seen_version;
 
     size_t m_num_detached_refs = 0;
+
+    // When m_incremental_sync is set, the rows of m_table that were changed by transaction advances since the view
+    // was last synchronized are recorded in m_changed_rows. m_changes_version is the version of m_table which
+    // includes all those changes, or none if changes were missed, and the view must be synchronized in full.
+    bool m_incremental_sync = false;
+    std::vector<size_t> m_changed_rows;
+    util::Optional<uint_fast64_t> m_changes_version;
+
     /// Construct null view (no memory allocated).
     TableViewBase();
 
@@ -417,6 +438,8 @@ protected:
 private:
     void allocate_row_indexes();
     void detach() const noexcept; // may have to remove const
+    bool can_sync_incrementally() const;
+    void do_sync_incrementally();
     size_t find_first_integer(size_t column_ndx, int64_t value) const;
     template <class oper>
     Timestamp minmax_timestamp(size_t column_ndx, size_t* return_ndx) const;
@@ -424,6 +447,7 @@ private:
     friend class Table;
     friend class Query;
     friend class SharedGroup;
+    friend class GroupBy;
 
     // Called by table to adjust any row references:
     void adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept;
@@ -432,6 +456,11 @@ private:
     void adj_row_acc_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept;
     void adj_row_acc_move_row(size_t from_row_ndx, size_t to_row_ndx) noexcept;
     void adj_row_acc_clear() noexcept;
+
+    // Called by table to record the changes of a transaction advance (see set_incremental_sync()):
+    void record_changed_rows(size_t row_ndx, size_t num_rows) noexcept;
+    void discard_changed_rows() noexcept;
+    void adj_changes_version(uint_fast64_t prior_version, uint_fast64_t version) noexcept;
 };
 
 
@@ -790,6 +819,9 @@ inline TableViewBase::TableViewBase(const TableViewBase& tv)
     , m_limit(tv.m_limit)
     , m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_incremental_sync(tv.m_incremental_sync)
+    , m_changed_rows(tv.m_changed_rows)
+    , m_changes_version(tv.m_changes_version)
 {
     // FIXME: This code is unreasonably complicated because it uses `IntegerColumn` as
     // a free-standing container, and because `IntegerColumn` does not conform to the
@@ -821,6 +853,9 @@ inline TableViewBase::TableViewBase(TableViewBase&& tv) noexcept
     // version number so that we can later trigger a sync if needed.
     m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_incremental_sync(tv.m_incremental_sync)
+    , m_changed_rows(std::move(tv.m_changed_rows))
+    , m_changes_version(tv.m_changes_version)
 {
     RowIndexes::m_limit_count = tv.m_limit_count;
     if (m_table)
@@ -857,6 +892,9 @@ inline TableViewBase& TableViewBase::operator=(TableViewBase&& tv) noexcept
     m_linkview_source = std::move(tv.m_linkview_source);
     m_descriptor_ordering = std::move(tv.m_descriptor_ordering);
     m_distinct_column_source = tv.m_distinct_column_source;
+    m_incremental_sync = tv.m_incremental_sync;
+    m_changed_rows = std::move(tv.m_changed_rows);
+    m_changes_version = tv.m_changes_version;
 
     return *this;
 }
@@ -893,6 +931,9 @@ inline TableViewBase& TableViewBase::operator=(const TableViewBase& tv)
     m_linkview_source = tv.m_linkview_source;
     m_descriptor_ordering = tv.m_descriptor_ordering;
     m_distinct_column_source = tv.m_distinct_column_source;
+    m_incremental_sync = tv.m_incremental_sync;
+    m_changed_rows = tv.m_changed_rows;
+    m_changes_version = tv.m_changes_version;
 
     return *this;
 }
@@ -164,4 +164,16 @@ inline std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& out, const
 
 } // namespace realm
 
+namespace std {
+template <>
+struct hash<::realm::Timestamp> {
+    inline size_t operator()(const ::realm::Timestamp& value) const noexcept
+    {
+        if (value.is_null())
+            return 0;
+        return std::hash<int64_t>()(value.get_seconds()) ^ std::hash<int32_t>()(value.get_nanoseconds());
+    }
+};
+} // namespace std
+
 #endif // REALM_TIMESTAMP_HPP
@@ -38,6 +38,8 @@
 #ifdef REALM_COMPILER_SSE
 #ifdef _MSC_VER
 #include <intrin.h>
+#else
+#include <cpuid.h>
 #endif
 #endif
 
@@ -62,6 +64,27 @@ inline unsigned long long _xgetbv(unsigned index)
 
 #endif
 #endif
+
+#ifdef REALM_COMPILER_AVX2
+// Returns the EBX register of CPUID leaf 7 (structured extended feature flags), or 0 if the leaf is not available.
+int cpuid_leaf7_ebx()
+{
+#ifdef _MSC_VER
+    int CPUInfo[4];
+    __cpuid(CPUInfo, 0);
+    if (CPUInfo[0] < 7)
+        return 0;
+    __cpuidex(CPUInfo, 7, 0);
+    return CPUInfo[1];
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7)
+        return 0;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return int(ebx);
+#endif
+}
+#endif
 #endif
 
 } // anonymous namespace
@@ -106,6 +129,7 @@ void cpuid_init()
     }
 
     bool avxSupported = false;
+    unsigned long long xcrFeatureMask = 0;
 
 // seems like in jenkins builds, __GNUC__ is defined for clang?! todo fixme
 #if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
@@ -114,20 +138,32 @@ void cpuid_init()
 
     if (osUsesXSAVE_XRSTORE && cpuAVXSuport) {
         // Check if the OS will save the YMM registers
-        unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
+        xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
         avxSupported = (xcrFeatureMask & 0x6) || false;
     }
 #endif
 
     if (avxSupported) {
         avx_support = 0; // AVX1 supported
+
+#ifdef REALM_COMPILER_AVX2
+        // AVX2 and AVX-512 are reported by leaf 7. AVX-512 additionally requires that the OS saves the opmask
+        // registers and the upper halves of the ZMM registers (XCR0 bits 5, 6 and 7)
+        int leaf7 = cpuid_leaf7_ebx();
+        if (leaf7 & (1 << 5)) {
+            avx_support = 1; // AVX2 supported
+
+            bool cpuAVX512Support = (leaf7 & (1 << 16)) && (leaf7 & (1 << 30)); // AVX512F and AVX512BW
+            if (cpuAVX512Support && (xcrFeatureMask & 0xe6) == 0xe6)
+                avx_support = 2; // AVX-512 supported
+        }
+#endif
     }
     else {
         avx_support = -1; // No AVX supported
     }
 
-// 1 is reserved for AVX2
-
+    static_cast<void>(xcrFeatureMask);
 #endif
 }
 
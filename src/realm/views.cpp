@@ -19,14 +19,76 @@
 #include <realm/views.hpp>
 
 #include <realm/column_link.hpp>
+#include <realm/column_string_enum.hpp>
+#include <realm/column_timestamp.hpp>
+#include <realm/impl/parallel.hpp>
 #include <realm/table.hpp>
+#include <realm/unicode.hpp>
 
+#include <functional>
+#include <numeric>
 #include <typeinfo>
+#include <unordered_set>
 
 using namespace realm;
 
 namespace {
 
+// A radix sort is only used for at least this many rows, as it has to go through all of them at least twice for
+// every column, whereas a comparison sort of a few rows is quick anyway
+const size_t radix_sort_threshold = 256;
+
+// When a sort is followed by a limit of at most one in this many rows, a partial comparison sort is used even if a
+// radix sort is possible
+const size_t partial_sort_ratio = 16;
+
+const uint64_t sign_bit = uint64_t(1) << 63;
+
+using IndexPair = ColumnsDescriptor::IndexPair;
+
+// Sorts `rows` by `less`, which must be a total ordering. With more than one thread, the rows are split into one part
+// per thread, the parts are sorted by `sort_part` at the same time, and neighbouring parts are then merged pairwise,
+// also in parallel, until one is left. As there are no ties, this gives the same order as a sort of all rows at once.
+template <class Less, class SortPart>
+void sort_in_parallel(std::vector<IndexPair>& rows, size_t num_threads, Less less, SortPart sort_part)
+{
+    size_t num_parts = std::min(num_threads, rows.size() / _impl::parallel_min_rows_per_thread);
+    if (num_parts <= 1) {
+        sort_part(rows.begin(), rows.end()); // Throws
+        return;
+    }
+
+    // Part i is [bounds[i], bounds[i + 1])
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= num_parts; ++i)
+        bounds.push_back(rows.size() * i / num_parts);
+    _impl::run_in_parallel(num_parts, [&](size_t i) {
+        sort_part(rows.begin() + bounds[i], rows.begin() + bounds[i + 1]); // Throws
+    }); // Throws
+
+    std::vector<IndexPair> buffer(rows.size());
+    while (num_parts > 1) {
+        _impl::run_in_parallel(num_parts / 2, [&](size_t i) {
+            auto begin = rows.begin() + bounds[2 * i];
+            auto middle = rows.begin() + bounds[2 * i + 1];
+            auto end = rows.begin() + bounds[2 * i + 2];
+            std::merge(begin, middle, middle, end, buffer.begin() + bounds[2 * i], less);
+        }); // Throws
+        if (num_parts % 2 != 0) {
+            // The last part has nothing to be merged with
+            std::copy(rows.begin() + bounds[num_parts - 1], rows.end(), buffer.begin() + bounds[num_parts - 1]);
+        }
+        rows.swap(buffer);
+
+        std::vector<size_t> merged_bounds;
+        for (size_t i = 0; i < num_parts; i += 2)
+            merged_bounds.push_back(bounds[i]);
+        merged_bounds.push_back(rows.size());
+        bounds = std::move(merged_bounds);
+        num_parts = bounds.size() - 1;
+    }
+}
+
 } // anonymous namespace
 
 ColumnsDescriptor::ColumnsDescriptor(Table const& table, std::vector<std::vector<size_t>> column_indices)
@@ -115,34 +177,325 @@ public:
                            [=](auto&& col) { return col.is_null.empty() ? false : col.is_null[i.index_in_view]; });
     }
 
+    // Whether the sort keys of all the columns were extracted, so that radix_sort() can be used
+    bool can_radix_sort() const
+    {
+        return std::all_of(m_columns.begin(), m_columns.end(), [](auto&& col) { return !col.keys.empty(); });
+    }
+
+    // Sort the rows in the same order as std::sort() with this predicate would. Requires can_radix_sort().
+    void radix_sort(std::vector<IndexPair>::iterator begin, std::vector<IndexPair>::iterator end) const;
+
+    // Whether all the columns are of a type that hash() supports
+    bool can_hash() const
+    {
+        return std::all_of(m_columns.begin(), m_columns.end(),
+                           [](auto&& col) { return !col.keys.empty() || col.get_hash; });
+    }
+
+    // Rows with equal values in all the columns have the same hash. Requires can_hash().
+    size_t hash(IndexPair i) const;
+
+    // Whether the rows have equal values in all the columns
+    bool equal(IndexPair i, IndexPair j) const;
+
 private:
+    // The values of int, bool, timestamp and enumerated string columns are turned into pairs of unsigned integers
+    // which are in the same order as the values themselves (with nulls first), and inverted for descending order.
+    // Rows are then compared without looking the values up in the column again.
+    struct SortKey {
+        uint64_t hi;
+        uint64_t lo;
+
+        bool operator==(const SortKey& other) const
+        {
+            return hi == other.hi && lo == other.lo;
+        }
+        bool operator<(const SortKey& other) const
+        {
+            return hi < other.hi || (hi == other.hi && lo < other.lo);
+        }
+        unsigned get_byte(int byte_ndx) const
+        {
+            return unsigned((byte_ndx < 8 ? lo >> (8 * byte_ndx) : hi >> (8 * (byte_ndx - 8))) & 0xff);
+        }
+    };
+
     struct SortColumn {
         std::vector<bool> is_null;
         std::vector<size_t> translated_row;
         const ColumnBase* column;
         bool ascending;
+        // Indexed by index_in_view. Empty if the keys of the column cannot be extracted.
+        std::vector<SortKey> keys;
+        // Hashes the value of a row in the column. Only used for columns without keys, and null if their type is not
+        // supported.
+        size_t (*get_hash)(const ColumnBase& column, size_t row);
+
+        void extract_keys(std::vector<IndexPair> const& rows, size_t max_index);
+
+        template <class F>
+        void fill_keys(std::vector<IndexPair> const& rows, size_t max_index, F get_key);
     };
     std::vector<SortColumn> m_columns;
 };
 
+template <class F>
+void ColumnsDescriptor::Sorter::SortColumn::fill_keys(std::vector<IndexPair> const& rows, size_t max_index,
+                                                     F get_key)
+{
+    keys.resize(max_index + 1);
+    for (auto& row : rows) {
+        size_t i = row.index_in_view;
+        SortKey key;
+        if (!is_null.empty() && is_null[i]) {
+            // Null links come after all values
+            key = {uint64_t(-1), uint64_t(-1)};
+        }
+        else {
+            key = get_key(translated_row.empty() ? row.index_in_column : translated_row[i]);
+        }
+        if (!ascending) {
+            key = {~key.hi, ~key.lo};
+        }
+        keys[i] = key;
+    }
+}
+
+void ColumnsDescriptor::Sorter::SortColumn::extract_keys(std::vector<IndexPair> const& rows, size_t max_index)
+{
+    // Values are encoded as {hi, lo}, where a null value is {0, 0} and all other values have a non-zero `lo`.
+    // Only the exact column types are handled, as link, backlink and subtable columns derive from IntegerColumn.
+    const std::type_info& type = typeid(*column);
+    if (type == typeid(IntegerColumn)) {
+        auto& col = static_cast<const IntegerColumn&>(*column);
+        fill_keys(rows, max_index, [&](size_t row) -> SortKey { return {uint64_t(col.get(row)) ^ sign_bit, 1}; });
+    }
+    else if (type == typeid(IntNullColumn)) {
+        auto& col = static_cast<const IntNullColumn&>(*column);
+        fill_keys(rows, max_index, [&](size_t row) -> SortKey {
+            util::Optional<int64_t> value = col.get(row);
+            if (!value)
+                return {0, 0};
+            return {uint64_t(*value) ^ sign_bit, 1};
+        });
+    }
+    else if (type == typeid(TimestampColumn)) {
+        auto& col = static_cast<const TimestampColumn&>(*column);
+        fill_keys(rows, max_index, [&](size_t row) -> SortKey {
+            Timestamp value = col.get(row);
+            if (value.is_null())
+                return {0, 0};
+            uint32_t nanoseconds = uint32_t(value.get_nanoseconds()) ^ 0x80000000u;
+            return {uint64_t(value.get_seconds()) ^ sign_bit, (uint64_t(1) << 32) | nanoseconds};
+        });
+    }
+    else if (type == typeid(StringEnumColumn)) {
+        // The rows refer to the strings by their index in the list of keys of the column, so it is enough to rank
+        // the distinct strings once
+        auto& col = static_cast<const StringEnumColumn&>(*column);
+        const StringColumn& strings = col.get_keys();
+        std::vector<size_t> order(strings.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return strings.compare_values(a, b) > 0;
+        });
+        std::vector<uint64_t> ranks(strings.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            ranks[order[i]] = strings.is_null(order[i]) ? 0 : i + 1;
+        }
+        fill_keys(rows, max_index, [&](size_t row) -> SortKey {
+            uint64_t rank = ranks[to_size_t(col.IntegerColumn::get(row))];
+            return {rank, rank != 0};
+        });
+    }
+}
+
+size_t ColumnsDescriptor::Sorter::hash(IndexPair i) const
+{
+    size_t hash = 0;
+    for (auto& col : m_columns) {
+        size_t value_hash;
+        if (!col.keys.empty()) {
+            const SortKey& key = col.keys[i.index_in_view];
+            value_hash = _impl::combine_hash(std::hash<uint64_t>()(key.hi), std::hash<uint64_t>()(key.lo));
+        }
+        else if (!col.is_null.empty() && col.is_null[i.index_in_view]) {
+            value_hash = 0;
+        }
+        else {
+            size_t row = col.translated_row.empty() ? i.index_in_column : col.translated_row[i.index_in_view];
+            value_hash = col.get_hash(*col.column, row);
+        }
+        hash = _impl::combine_hash(hash, value_hash);
+    }
+    return hash;
+}
+
+bool ColumnsDescriptor::Sorter::equal(IndexPair i, IndexPair j) const
+{
+    for (auto& col : m_columns) {
+        if (!col.keys.empty()) {
+            if (!(col.keys[i.index_in_view] == col.keys[j.index_in_view]))
+                return false;
+            continue;
+        }
+
+        size_t index_i = i.index_in_column;
+        size_t index_j = j.index_in_column;
+        if (!col.translated_row.empty()) {
+            bool null_i = col.is_null[i.index_in_view];
+            bool null_j = col.is_null[j.index_in_view];
+            if (null_i || null_j) {
+                if (null_i != null_j)
+                    return false;
+                continue;
+            }
+            index_i = col.translated_row[i.index_in_view];
+            index_j = col.translated_row[j.index_in_view];
+        }
+        if (col.column->compare_values(index_i, index_j) != 0)
+            return false;
+    }
+    return true;
+}
+
+namespace {
+
+// Removes the rows with the same values as a row before them, in a single pass that keeps the rest in their current
+// order. Requires sorter.can_hash(). With several threads, the rows are hashed in parallel, and each thread then looks
+// for duplicates among the rows whose hash falls in its share.
+void remove_duplicates(std::vector<IndexPair>& rows, const ColumnsDescriptor::Sorter& sorter, size_t num_threads)
+{
+    const size_t num_rows = rows.size();
+    size_t num_parts = std::max(std::min(num_threads, num_rows / _impl::parallel_min_rows_per_thread), size_t(1));
+
+    std::vector<size_t> hashes(num_rows);
+    _impl::run_in_parallel(num_parts, [&](size_t part) {
+        for (size_t r = num_rows * part / num_parts; r < num_rows * (part + 1) / num_parts; ++r)
+            hashes[r] = sorter.hash(rows[r]);
+    }); // Throws
+
+    // The sets hold positions in `rows`
+    std::vector<char> keep(num_rows);
+    _impl::run_in_parallel(num_parts, [&](size_t part) {
+        auto hash = [&](size_t r) { return hashes[r]; };
+        auto equal = [&](size_t r1, size_t r2) { return sorter.equal(rows[r1], rows[r2]); };
+        std::unordered_set<size_t, decltype(hash), decltype(equal)> seen(num_rows / num_parts, hash,
+                                                                         equal); // Throws
+        for (size_t r = 0; r < num_rows; ++r) {
+            if (hashes[r] % num_parts == part)
+                keep[r] = seen.insert(r).second; // Throws
+        }
+    }); // Throws
+
+    size_t num_kept = 0;
+    for (size_t r = 0; r < num_rows; ++r) {
+        if (keep[r])
+            rows[num_kept++] = rows[r];
+    }
+    rows.resize(num_kept);
+}
+
+// Sorts the rows with `sorter`, by a radix sort if the keys of all the columns were extracted
+void sort_rows(std::vector<IndexPair>& rows, const ColumnsDescriptor::Sorter& sorter, size_t num_threads)
+{
+    bool use_radix_sort = sorter.can_radix_sort() && rows.size() >= radix_sort_threshold;
+    sort_in_parallel(rows, num_threads, std::ref(sorter), [&](auto begin, auto end) {
+        if (use_radix_sort) {
+            sorter.radix_sort(begin, end); // Throws
+        }
+        else {
+            std::sort(begin, end, std::ref(sorter));
+        }
+    }); // Throws
+}
+
+} // anonymous namespace
+
+void ColumnsDescriptor::Sorter::radix_sort(std::vector<IndexPair>::iterator begin,
+                                           std::vector<IndexPair>::iterator end) const
+{
+    REALM_ASSERT_DEBUG(can_radix_sort());
+
+    // This is a least significant digit radix sort, which does a stable counting sort by every byte of the keys,
+    // starting with the least significant byte of the last column. Rows with equal keys are left in the order they
+    // start out in, which has to be the order in the view for the result to be the same as with operator().
+    if (end - begin < 2)
+        return;
+    std::vector<IndexPair> rows(begin, end);
+    if (!std::is_sorted(rows.begin(), rows.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; }))
+        std::sort(rows.begin(), rows.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+
+    const size_t num_rows = rows.size();
+    const int num_bytes = int(2 * sizeof(uint64_t));
+    std::vector<IndexPair> buffer(num_rows);
+    std::vector<size_t> counts(num_bytes * 256);
+    for (auto col = m_columns.rbegin(); col != m_columns.rend(); ++col) {
+        const std::vector<SortKey>& keys = col->keys;
+
+        // Count the rows with each value of every byte in a single pass
+        std::fill(counts.begin(), counts.end(), 0);
+        for (auto& row : rows) {
+            const SortKey& key = keys[row.index_in_view];
+            for (int byte_ndx = 0; byte_ndx < num_bytes; ++byte_ndx)
+                ++counts[byte_ndx * 256 + key.get_byte(byte_ndx)];
+        }
+
+        for (int byte_ndx = 0; byte_ndx < num_bytes; ++byte_ndx) {
+            size_t* count = &counts[byte_ndx * 256];
+            // Small values and timestamps without nanoseconds leave most bytes the same in all rows, and those are
+            // skipped
+            if (count[keys[rows[0].index_in_view].get_byte(byte_ndx)] == num_rows)
+                continue;
+
+            size_t offset = 0;
+            for (int value = 0; value < 256; ++value) {
+                size_t num = count[value];
+                count[value] = offset;
+                offset += num;
+            }
+            for (auto& row : rows)
+                buffer[count[keys[row.index_in_view].get_byte(byte_ndx)]++] = row;
+            rows.swap(buffer);
+        }
+    }
+    std::copy(rows.begin(), rows.end(), begin);
+}
+
 ColumnsDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> const& columns,
                                  std::vector<bool> const& ascending, std::vector<IndexPair> const& rows)
 {
     REALM_ASSERT(!columns.empty());
     REALM_ASSERT_EX(columns.size() == ascending.size(), columns.size(), ascending.size());
 
+    size_t max_index = 0;
+    for (auto& row : rows)
+        max_index = std::max(max_index, row.index_in_view);
+
     m_columns.reserve(columns.size());
     for (size_t i = 0; i < columns.size(); ++i) {
-        m_columns.push_back({{}, {}, columns[i].back(), ascending[i]});
+        const ColumnBase* column = columns[i].back();
+        const std::type_info& type = typeid(*column);
+        size_t (*get_hash)(const ColumnBase&, size_t) = nullptr;
+        if (type == typeid(StringColumn)) {
+            get_hash = &_impl::hash_string;
+        }
+        else if (type == typeid(FloatColumn)) {
+            get_hash = &_impl::hash_floating_point<float>;
+        }
+        else if (type == typeid(DoubleColumn)) {
+            get_hash = &_impl::hash_floating_point<double>;
+        }
+        m_columns.push_back({{}, {}, column, ascending[i], {}, get_hash});
         REALM_ASSERT_EX(!columns[i].empty(), i);
         if (columns[i].size() == 1) { // no link chain
+            m_columns.back().extract_keys(rows, max_index); // Throws
             continue;
         }
 
         auto& translated_rows = m_columns.back().translated_row;
         auto& is_null = m_columns.back().is_null;
-        size_t max_index = std::max_element(rows.begin(), rows.end(),
-                                            [](auto&& a, auto&& b) { return a.index_in_view < b.index_in_view; })->index_in_view;
         translated_rows.resize(max_index + 1);
         is_null.resize(max_index + 1);
 
@@ -160,6 +513,7 @@ ColumnsDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> co
             }
             translated_rows[index_in_view] = translated_index;
         }
+        m_columns.back().extract_keys(rows, max_index); // Throws
     }
 }
 
@@ -261,6 +615,14 @@ SortDescriptor::Sorter SortDescriptor::sorter(std::vector<IndexPair> const& rows
 bool SortDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ordering) const
 {
     for (size_t t = 0; t < m_columns.size(); t++) {
+        if (!m_columns[t].keys.empty()) {
+            const SortKey& key_i = m_columns[t].keys[i.index_in_view];
+            const SortKey& key_j = m_columns[t].keys[j.index_in_view];
+            if (key_i == key_j)
+                continue;
+            return key_i < key_j;
+        }
+
         size_t index_i = i.index_in_column;
         size_t index_j = j.index_in_column;
 
@@ -522,6 +884,7 @@ void RowIndexes::do_sort(const DescriptorOrdering& ordering) {
             ++detached_ref_count;
     }
 
+    const size_t num_threads = get_sort_threads();
     const int num_descriptors = int(ordering.size());
     for (int desc_ndx = 0; desc_ndx < num_descriptors; ++desc_ndx) {
 
@@ -532,7 +895,20 @@ void RowIndexes::do_sort(const DescriptorOrdering& ordering) {
                 const auto* sort_descr = static_cast<const SortDescriptor*>(ordering[desc_ndx]);
                 SortDescriptor::Sorter sort_predicate = sort_descr->sorter(v);
 
-                std::sort(v.begin(), v.end(), std::ref(sort_predicate));
+                // When the sort is followed by a limit, only the rows within the limit need to be put in order.
+                // The sort predicate is a total ordering, so they end up exactly as after a full sort.
+                size_t num_sorted = v.size();
+                if (desc_ndx + 1 < num_descriptors && ordering.descriptor_is_limit(desc_ndx + 1)) {
+                    const auto* limit_descr = static_cast<const LimitDescriptor*>(ordering[desc_ndx + 1]);
+                    num_sorted = std::min(num_sorted, limit_descr->get_limit());
+                }
+                bool use_radix_sort = sort_predicate.can_radix_sort() && v.size() >= radix_sort_threshold;
+                if (num_sorted < v.size() && (!use_radix_sort || num_sorted < v.size() / partial_sort_ratio)) {
+                    std::partial_sort(v.begin(), v.begin() + num_sorted, v.end(), std::ref(sort_predicate));
+                }
+                else {
+                    sort_rows(v, sort_predicate, num_threads); // Throws
+                }
 
                 bool is_last_ordering = desc_ndx == num_descriptors - 1;
                 // not doing this on the last step is an optimisation
@@ -559,8 +935,15 @@ void RowIndexes::do_sort(const DescriptorOrdering& ordering) {
                             v.end());
                 }
 
+                // The rows are in order of index_in_view here, so keeping the first row with each set of values
+                // keeps the one that comes first in the view, as well as the order of the rows
+                if (distinct_predicate.can_hash()) {
+                    remove_duplicates(v, distinct_predicate, num_threads); // Throws
+                    break;
+                }
+
                 // Sort by the columns to distinct on
-                std::sort(v.begin(), v.end(), std::ref(distinct_predicate));
+                sort_rows(v, distinct_predicate, num_threads); // Throws
 
                 // Remove all duplicates
                 v.erase(std::unique(v.begin(), v.end(),
@@ -573,7 +956,10 @@ void RowIndexes::do_sort(const DescriptorOrdering& ordering) {
                 if (!will_be_sorted_next) {
                     // Restore the original order, this is either the original
                     // tableview order or the order of the previous sort
-                    std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+                    auto by_index_in_view = [](auto a, auto b) { return a.index_in_view < b.index_in_view; };
+                    sort_in_parallel(v, num_threads, by_index_in_view, [&](auto begin, auto end) {
+                        std::sort(begin, end, by_index_in_view);
+                    }); // Throws
                 }
 
                 break;
@@ -600,6 +986,54 @@ void RowIndexes::do_sort(const DescriptorOrdering& ordering) {
     }
 }
 
+size_t RowIndexes::retain_first_rows(const SortDescriptor& sort, size_t limit)
+{
+    size_t sz = m_row_indexes.size();
+    if (sz <= limit)
+        return 0;
+
+    std::vector<ColumnsDescriptor::IndexPair> v;
+    v.reserve(sz);
+    for (size_t t = 0; t < sz; t++) {
+        v.push_back({to_size_t(m_row_indexes.get(t)), t});
+    }
+    SortDescriptor::Sorter sort_predicate = sort.sorter(v);
+    std::nth_element(v.begin(), v.begin() + limit, v.end(), std::ref(sort_predicate));
+    v.erase(v.begin() + limit, v.end());
+    std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+
+    m_row_indexes.clear();
+    for (auto& pair : v) {
+        m_row_indexes.add(pair.index_in_column);
+    }
+    return sz - limit;
+}
+
+void RowIndexes::merge_sorted_rows(const SortDescriptor& sort, const std::vector<size_t>& rows, size_t num_sorted)
+{
+    std::vector<IndexPair> v;
+    v.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        v.push_back({rows[i], i});
+    }
+    SortDescriptor::Sorter sort_predicate = sort.sorter(v);
+    auto less = [&](IndexPair a, IndexPair b) {
+        bool total_ordering = false;
+        if (sort_predicate(a, b, total_ordering))
+            return true;
+        if (sort_predicate(b, a, total_ordering))
+            return false;
+        return a.index_in_column < b.index_in_column;
+    };
+    std::sort(v.begin() + num_sorted, v.end(), less);
+    std::inplace_merge(v.begin(), v.begin() + num_sorted, v.end(), less);
+
+    m_row_indexes.clear();
+    for (auto& pair : v) {
+        m_row_indexes.add(pair.index_in_column);
+    }
+}
+
 RowIndexes::RowIndexes(IntegerColumn::unattached_root_tag urt, realm::Allocator& alloc)
     : m_row_indexes(urt, alloc)
 #ifdef REALM_COOKIE_CHECK
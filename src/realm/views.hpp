@@ -231,6 +231,20 @@ public:
 protected:
     void do_sort(const DescriptorOrdering& ordering);
 
+    // The number of threads that do_sort() may sort with
+    virtual unsigned int get_sort_threads() const noexcept
+    {
+        return 1;
+    }
+
+    // Remove all but the `limit` first rows in the order given by `sort`, and keep the remaining rows in their
+    // current order. Returns the number of rows that were removed.
+    size_t retain_first_rows(const SortDescriptor& sort, size_t limit);
+
+    // Replace the rows by `rows`, where the first `num_sorted` are in the order given by `sort` already, and put the
+    // others in place among them. Rows which are equal by `sort` end up in table order.
+    void merge_sorted_rows(const SortDescriptor& sort, const std::vector<size_t>& rows, size_t num_sorted);
+
     static const uint64_t cookie_expected = 0x7765697677777777ull; // 0x77656976 = 'view'; 0x77777777 = '7777' = alive
     size_t m_limit_count = 0;
     uint64_t m_debug_cookie;
@@ -0,0 +1,87 @@
+/*************************************************************************
+ *
+ * Copyright 2018 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include <realm/util/file.hpp>
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+
+#include "../util/timer.hpp"
+#include "../util/benchmark_results.hpp"
+
+using namespace realm;
+using namespace realm::util;
+using namespace realm::test_util;
+
+
+namespace {
+
+using Durability = SharedGroupOptions::Durability;
+
+// Measure the time it takes to commit write transactions that each change a
+// single value, until commit() returns and the change is durable.
+void run(BenchmarkResults& results, Durability durability, const char* ident, const char* lead_text)
+{
+    std::string path = "benchmark-commit-latency.realm";
+    File::try_remove(path);
+    File::try_remove(path + ".wal");
+
+    const size_t num_rows = 1000;
+    const int num_commits = 1000;
+    {
+        std::unique_ptr<Replication> hist = make_in_realm_history(path);
+        SharedGroupOptions options;
+        options.durability = durability;
+        SharedGroup sg(*hist, options);
+        {
+            WriteTransaction wt(sg);
+            TableRef table = wt.add_table("table");
+            table->add_column(type_Int, "value");
+            table->add_empty_row(num_rows);
+            wt.commit();
+        }
+
+        Timer timer(Timer::type_RealTime);
+        for (int i = 0; i != num_commits; ++i) {
+            timer.reset();
+            WriteTransaction wt(sg);
+            wt.get_table(0)->set_int(0, size_t(i) % num_rows, i);
+            wt.commit();
+            results.submit(ident, timer);
+        }
+        results.finish(ident, lead_text);
+    }
+
+    File::try_remove(path);
+    File::try_remove(path + ".wal");
+    File::try_remove(path + ".lock");
+}
+
+} // unnamed namespace
+
+
+int main()
+{
+    int max_lead_text_size = 36;
+    BenchmarkResults results(max_lead_text_size);
+
+    run(results, Durability::Full, "commit_full", "Single value commit (Full)");
+    run(results, Durability::Logged, "commit_logged", "Single value commit (Logged)");
+}
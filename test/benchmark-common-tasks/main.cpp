@@ -478,6 +478,89 @@ struct BenchmarkDistinctIntManyDupes : BenchmarkWithIntsTable {
     }
 };
 
+/// Counts the rows matching `ints > 0` in a column where every leaf has the same bit width (as chosen by
+/// the magnitude of the stored values), to compare the vectorized integer finders across widths. Every run scans
+/// `rows` rows, so rows/ns is `rows` divided by the reported time.
+struct BenchmarkQueryIntWidth : BenchmarkWithIntsTable {
+    static const size_t rows = BASE_SIZE * 100;
+
+    explicit BenchmarkQueryIntWidth(int64_t max_value)
+        : m_max_value(max_value)
+    {
+    }
+
+    void before_all(SharedGroup& group)
+    {
+        BenchmarkWithIntsTable::before_all(group);
+        WriteTransaction tr(group);
+        TableRef t = tr.get_table("IntOnly");
+        t->add_empty_row(rows);
+        Random r;
+        for (size_t i = 0; i < rows; ++i) {
+            t->set_int(0, i, r.draw_int(-m_max_value, m_max_value));
+        }
+        tr.commit();
+    }
+
+    void operator()(SharedGroup& group)
+    {
+        ReadTransaction tr(group);
+        ConstTableRef table = tr.get_table("IntOnly");
+        volatile size_t dummy = table->where().greater(0, 0).count();
+        static_cast<void>(dummy);
+    }
+
+    int64_t m_max_value;
+};
+
+struct BenchmarkQueryIntWidth8 : BenchmarkQueryIntWidth {
+    BenchmarkQueryIntWidth8()
+        : BenchmarkQueryIntWidth(100)
+    {
+    }
+
+    const char* name() const
+    {
+        return "QueryIntWidth8";
+    }
+};
+
+struct BenchmarkQueryIntWidth16 : BenchmarkQueryIntWidth {
+    BenchmarkQueryIntWidth16()
+        : BenchmarkQueryIntWidth(30000)
+    {
+    }
+
+    const char* name() const
+    {
+        return "QueryIntWidth16";
+    }
+};
+
+struct BenchmarkQueryIntWidth32 : BenchmarkQueryIntWidth {
+    BenchmarkQueryIntWidth32()
+        : BenchmarkQueryIntWidth(2000000000LL)
+    {
+    }
+
+    const char* name() const
+    {
+        return "QueryIntWidth32";
+    }
+};
+
+struct BenchmarkQueryIntWidth64 : BenchmarkQueryIntWidth {
+    BenchmarkQueryIntWidth64()
+        : BenchmarkQueryIntWidth(8000000000LL)
+    {
+    }
+
+    const char* name() const
+    {
+        return "QueryIntWidth64";
+    }
+};
+
 struct BenchmarkInsert : BenchmarkWithStringsTable {
     const char* name() const
     {
@@ -981,6 +1064,10 @@ int benchmark_common_tasks_main()
     BENCH(AddTable);
     BENCH(BenchmarkQuery);
     BENCH(BenchmarkQueryNot);
+    BENCH(BenchmarkQueryIntWidth8);
+    BENCH(BenchmarkQueryIntWidth16);
+    BENCH(BenchmarkQueryIntWidth32);
+    BENCH(BenchmarkQueryIntWidth64);
     BENCH(BenchmarkSize);
     BENCH(BenchmarkSort);
     BENCH(BenchmarkSortInt);
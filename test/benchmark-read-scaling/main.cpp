@@ -0,0 +1,97 @@
+/*************************************************************************
+ *
+ * Copyright 2018 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <realm/util/file.hpp>
+#include <realm/group_shared.hpp>
+
+#include "../util/timer.hpp"
+#include "../util/benchmark_results.hpp"
+
+using namespace realm;
+using namespace realm::util;
+using namespace realm::test_util;
+
+
+namespace {
+
+// Measure the time it takes to start and end a million read transactions,
+// spread evenly over the specified number of threads, each with a
+// SharedGroup of its own. As long as read transactions do not contend with
+// each other, the time goes down as threads are added, until there are more
+// threads than cores.
+void run(BenchmarkResults& results, const std::string& path, int num_threads)
+{
+    const int num_transactions = 1000000;
+    int transactions_per_thread = num_transactions / num_threads;
+
+    std::vector<std::unique_ptr<SharedGroup>> shared_groups;
+    for (int i = 0; i != num_threads; ++i)
+        shared_groups.emplace_back(new SharedGroup(path));
+
+    auto read = [&](SharedGroup& sg) {
+        for (int i = 0; i != transactions_per_thread; ++i) {
+            sg.begin_read();
+            sg.end_read();
+        }
+    };
+
+    Timer timer(Timer::type_RealTime);
+    std::vector<std::thread> threads;
+    for (int i = 0; i != num_threads; ++i)
+        threads.emplace_back(read, std::ref(*shared_groups[i]));
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = timer.get_elapsed_time();
+
+    std::string ident = "read_transactions_" + std::to_string(num_threads);
+    std::string lead_text = "Read transactions (" + std::to_string(num_threads) + " threads)";
+    results.submit_single(ident.c_str(), lead_text.c_str(), seconds);
+}
+
+} // unnamed namespace
+
+
+int main()
+{
+    std::string path = "benchmark-read-scaling.realm";
+    File::try_remove(path);
+    {
+        SharedGroup sg(path);
+        WriteTransaction wt(sg);
+        wt.add_table("table");
+        wt.commit();
+    }
+
+    int max_lead_text_size = 36;
+    BenchmarkResults results(max_lead_text_size);
+
+    int max_threads = std::max(int(std::thread::hardware_concurrency()), 1);
+    for (int num_threads = 1; num_threads < max_threads; num_threads *= 2)
+        run(results, path, num_threads);
+    run(results, path, max_threads);
+
+    File::try_remove(path);
+    File::try_remove(path + ".lock");
+}
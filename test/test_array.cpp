@@ -902,6 +902,68 @@ TEST(Array_find_sse)
 }
 
 
+// Exercise the vectorized finders (SSE, AVX2 and AVX-512, whichever the CPU supports) at every byte-multiple width
+// and for all four conditions, with search ranges that start and end at unaligned positions. Results are checked
+// against a naive scan.
+TEST(Array_FindVectorized)
+{
+    Array a(Allocator::get_default());
+    a.create(Array::type_Normal);
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    const int64_t maxima[] = {100, 30000, 2000000000LL, 8000000000LL};
+    const int conditions[] = {cond_Equal, cond_NotEqual, cond_Greater, cond_Less};
+    const size_t size = 1000;
+
+    for (int64_t max : maxima) {
+        a.clear();
+        for (size_t i = 0; i < size; ++i)
+            a.add(random.draw_int<int64_t>(-5, 5) * (max / 5));
+        a.set(size / 2, max); // Make sure the array gets the width we want
+
+        for (size_t start : {size_t(0), size_t(1), size_t(3), size_t(17)}) {
+            for (size_t end : {size, size - 1, size - 13}) {
+                for (int64_t value : {-max, -(max / 5), int64_t(0), (max / 5) + 1, max}) {
+                    for (int cond : conditions) {
+                        size_t expected_count = 0;
+                        size_t expected_first = not_found;
+                        int64_t expected_sum = 0;
+                        for (size_t i = start; i < end; ++i) {
+                            int64_t v = a.get(i);
+                            bool match = (cond == cond_Equal && v == value) ||
+                                         (cond == cond_NotEqual && v != value) ||
+                                         (cond == cond_Greater && v > value) || (cond == cond_Less && v < value);
+                            if (match) {
+                                if (expected_count == 0)
+                                    expected_first = i;
+                                ++expected_count;
+                                expected_sum += v;
+                            }
+                        }
+
+                        QueryState<int64_t> count_state;
+                        count_state.init(act_Count, nullptr, size_t(-1));
+                        a.find(cond, act_Count, value, start, end, 0, &count_state);
+                        CHECK_EQUAL(expected_count, size_t(count_state.m_state));
+
+                        QueryState<int64_t> sum_state;
+                        sum_state.init(act_Sum, nullptr, size_t(-1));
+                        a.find(cond, act_Sum, value, start, end, 0, &sum_state);
+                        CHECK_EQUAL(expected_sum, sum_state.m_state);
+
+                        QueryState<int64_t> first_state;
+                        first_state.init(act_ReturnFirst, nullptr, 1);
+                        a.find(cond, act_ReturnFirst, value, start, end, 0, &first_state);
+                        CHECK_EQUAL(expected_first, size_t(first_state.m_state));
+                    }
+                }
+            }
+        }
+    }
+    a.destroy();
+}
+
+
 TEST(Array_Greater)
 {
     Array a(Allocator::get_default());
@@ -22,6 +22,10 @@
 
 #include <realm/array_integer.hpp>
 #include <realm/column.hpp>
+#include <realm/group_shared.hpp>
+#include <realm/history.hpp>
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
 
 #include "test.hpp"
 
@@ -409,3 +413,476 @@ TEST(ArrayIntNull_MinMaxOfNegativeIntegers)
 
     a.destroy();
 }
+
+
+namespace {
+
+// Whether the specified leaf of an integer column with more than one leaf is
+// stored in encoded form
+bool is_encoded(const Table& table, size_t col_ndx, size_t leaf_ndx)
+{
+    const ColumnBase& col_base = _impl::TableFriend::get_column(table, col_ndx);
+    const Array* root = static_cast<const IntegerColumn&>(col_base).get_root_array();
+    REALM_ASSERT(root->is_inner_bptree_node());
+    Array leaf(root->get_alloc());
+    leaf.init_from_ref(root->get_as_ref(1 + leaf_ndx));
+    return leaf.is_encoded();
+}
+
+bool get_encoded_bounds(const Table& table, size_t col_ndx, size_t leaf_ndx, int64_t& min, int64_t& max)
+{
+    const ColumnBase& col_base = _impl::TableFriend::get_column(table, col_ndx);
+    const Array* root = static_cast<const IntegerColumn&>(col_base).get_root_array();
+    REALM_ASSERT(root->is_inner_bptree_node());
+    Array leaf(root->get_alloc());
+    leaf.init_from_ref(root->get_as_ref(1 + leaf_ndx));
+    return leaf.get_encoded_bounds(min, max);
+}
+
+} // anonymous namespace
+
+// Committed leaves of integer columns are stored in frame-of-reference encoded
+// form when that is smaller. They must read like plain leaves, and turn into
+// plain leaves when modified.
+//
+// The tests of encoded leaves need leaves large enough for an encoding to be
+// smaller than the plain form, so they are skipped with tiny B+-tree nodes.
+TEST_IF(ArrayInteger_FrameOfReferenceEncodedLeaves, REALM_MAX_BPNODE_SIZE >= 1000)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    const int64_t epoch = 1500000000000; // Milliseconds
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_column(type_Int, "int_null", true);
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            table->set_int(0, i, epoch + int64_t(i % 100));
+            if (i % 3 != 0)
+                table->set_int(1, i, epoch - int64_t(i));
+        }
+        wt.commit();
+    }
+
+    auto check = [&](const Table& table, int64_t first) {
+        int64_t sum = first - epoch;
+        for (size_t i = 0; i < num_rows; ++i) {
+            int64_t expected = i == 0 ? first : epoch + int64_t(i % 100);
+            CHECK_EQUAL(table.get_int(0, i), expected);
+            sum += int64_t(i % 100);
+            if (i % 3 != 0)
+                CHECK_EQUAL(table.get_int(1, i), epoch - int64_t(i));
+            else
+                CHECK(table.is_null(1, i));
+        }
+        CHECK_EQUAL(table.sum_int(0), sum + epoch * int64_t(num_rows));
+        CHECK_EQUAL(table.maximum_int(0), epoch + 99);
+        CHECK_EQUAL(table.minimum_int(0), std::min(first, epoch));
+        CHECK_EQUAL(table.find_first_int(0, epoch + 42), 42);
+        CHECK_EQUAL(table.find_first_int(0, 42), not_found);
+        CHECK_EQUAL(table.count_int(0, epoch + 99), num_rows / 100);
+        CHECK_EQUAL(table.where().greater(0, epoch + 97).count(), 2 * (num_rows / 100));
+        CHECK_EQUAL(table.where().between(0, epoch + 10, epoch + 19).find(), 10);
+        CHECK_EQUAL(table.where().less(0, std::numeric_limits<int64_t>::min() + 1).count(), 0);
+        CHECK_EQUAL(table.where().greater(0, std::numeric_limits<int64_t>::min()).count(), num_rows);
+        CHECK_EQUAL(table.where().not_equal(0, std::numeric_limits<int64_t>::max()).count(), num_rows);
+        CHECK_EQUAL(table.where().equal(1, epoch - 5).find(), 5);
+        CHECK_EQUAL(table.where().equal(1, null()).count(), (num_rows + 2) / 3);
+        CHECK_EQUAL(table.maximum_int(1), epoch - 1);
+    };
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 0));
+        CHECK(is_encoded(*table, 0, 2));
+        check(*table, epoch);
+
+        // The encoded leaves give bounds without a scan. The lower bound is exact.
+        int64_t min = 0, max = 0;
+        CHECK(get_encoded_bounds(*table, 0, 1, min, max));
+        CHECK_EQUAL(min, epoch);
+        CHECK_GREATER_EQUAL(max, epoch + 99);
+        CHECK(get_encoded_bounds(*table, 1, 1, min, max));
+        CHECK_LESS_EQUAL(min, epoch - int64_t(2 * REALM_MAX_BPNODE_SIZE - 1));
+        CHECK_GREATER_EQUAL(max, epoch - int64_t(REALM_MAX_BPNODE_SIZE + 1));
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("table");
+        check(*table, epoch);
+        // Needs a wider offset than the encoded leaf has
+        table->set_int(0, 0, -1);
+        CHECK(!is_encoded(*table, 0, 0));
+        CHECK(is_encoded(*table, 0, 1));
+        check(*table, -1);
+        // Fits in the encoded leaf
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + 1, epoch + 50);
+        CHECK(!is_encoded(*table, 0, 1));
+        CHECK_EQUAL(table->get_int(0, REALM_MAX_BPNODE_SIZE + 1), epoch + 50);
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + 1, epoch + 1);
+        table->insert_empty_row(2 * REALM_MAX_BPNODE_SIZE + 5);
+        table->remove(2 * REALM_MAX_BPNODE_SIZE + 5);
+        check(*table, -1);
+        wt.commit();
+    }
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        check(*table, -1);
+    }
+
+    // Compaction and Group::write() keep leaves encoded
+    CHECK(sg.compact());
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        check(*table, -1);
+
+        Group group(rt.get_group().write_to_mem());
+        ConstTableRef table_2 = group.get_table("table");
+        CHECK(is_encoded(*table_2, 0, 1));
+        check(*table_2, -1);
+        CHECK(*table == *table_2);
+    }
+}
+
+
+// Leaves with long runs of the same value are stored in run-length encoded
+// form, which is also used for bool columns and nullable integer columns.
+TEST_IF(ArrayInteger_RunLengthEncodedLeaves, REALM_MAX_BPNODE_SIZE >= 1000)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    const size_t run_length = 50;
+    auto status = [&](size_t i) { return int64_t(i / run_length % 3) * 1000 - 1000; };
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "status");
+        table->add_column(type_Bool, "flag");
+        table->add_column(type_Int, "int_null", true);
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            table->set_int(0, i, status(i));
+            table->set_bool(1, i, i / run_length % 2 == 1);
+            if (i / run_length % 4 == 0)
+                table->set_int(2, i, int64_t(i / run_length));
+        }
+        wt.commit();
+    }
+
+    auto check = [&](const Table& table) {
+        size_t count[3] = {0, 0, 0};
+        size_t num_flags = 0, num_nulls = 0;
+        int64_t sum = 0;
+        for (size_t i = 0; i < num_rows; ++i) {
+            CHECK_EQUAL(table.get_int(0, i), status(i));
+            CHECK_EQUAL(table.get_bool(1, i), i / run_length % 2 == 1);
+            if (i / run_length % 4 == 0) {
+                CHECK_EQUAL(table.get_int(2, i), int64_t(i / run_length));
+            }
+            else {
+                CHECK(table.is_null(2, i));
+                ++num_nulls;
+            }
+            ++count[i / run_length % 3];
+            num_flags += i / run_length % 2;
+            sum += status(i);
+        }
+        CHECK_EQUAL(table.count_int(0, -1000), count[0]);
+        CHECK_EQUAL(table.count_int(0, 0), count[1]);
+        CHECK_EQUAL(table.count_int(0, 1000), count[2]);
+        CHECK_EQUAL(table.count_int(0, 1), 0);
+        CHECK_EQUAL(table.where().equal(0, 1000).count(), count[2]);
+        CHECK_EQUAL(table.where().not_equal(0, 1000).count(), count[0] + count[1]);
+        CHECK_EQUAL(table.where().greater(0, -1000).count(), count[1] + count[2]);
+        CHECK_EQUAL(table.where().equal(0, 1000).count(0, num_rows, 7), 7);
+        CHECK_EQUAL(table.where().equal(0, 0).find(), run_length);
+        size_t begin = REALM_MAX_BPNODE_SIZE + 1;
+        size_t expected = begin;
+        while (status(expected) != 1000)
+            ++expected;
+        CHECK_EQUAL(table.where().equal(0, 1000).find(begin), expected);
+        CHECK_EQUAL(table.find_all_int(0, 0).size(), count[1]);
+        CHECK_EQUAL(table.sum_int(0), sum);
+        CHECK_EQUAL(table.where().greater(0, -1000).sum_int(0), sum + 1000 * int64_t(count[0]));
+        CHECK_EQUAL(table.minimum_int(0), -1000);
+        CHECK_EQUAL(table.maximum_int(0), 1000);
+        CHECK_EQUAL(table.where().equal(1, true).count(), num_flags);
+        CHECK_EQUAL(table.where().equal(2, null()).count(), num_nulls);
+        CHECK_EQUAL(table.where().greater(2, 3).find(), 4 * run_length);
+    };
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 0));
+        CHECK(is_encoded(*table, 1, 1));
+        CHECK(is_encoded(*table, 2, 2));
+        check(*table);
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("table");
+        // Break a run in the middle and then restore it
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + run_length / 2, 5);
+        CHECK(!is_encoded(*table, 0, 1));
+        CHECK_EQUAL(table->count_int(0, 5), 1);
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + run_length / 2, status(REALM_MAX_BPNODE_SIZE + run_length / 2));
+        table->set_null(2, 0);
+        table->set_int(2, 0, 0);
+        check(*table);
+        wt.commit();
+    }
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        check(*table);
+    }
+}
+
+// Sorted values made up of ranges of consecutive values, like the row indexes
+// of a view, are stored as ranges.
+TEST_IF(ArrayInteger_RangesEncodedLeaves, REALM_MAX_BPNODE_SIZE >= 1000)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    const size_t range_length = 100;
+    auto row = [&](size_t i) { return int64_t(i + i / range_length * 7); };
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "row");
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i)
+            table->set_int(0, i, row(i));
+        wt.commit();
+    }
+
+    auto check = [&](const Table& table) {
+        int64_t sum = 0;
+        for (size_t i = 0; i < num_rows; ++i) {
+            CHECK_EQUAL(table.get_int(0, i), row(i));
+            sum += row(i);
+        }
+        CHECK_EQUAL(table.sum_int(0), sum);
+        CHECK_EQUAL(table.minimum_int(0), 0);
+        CHECK_EQUAL(table.maximum_int(0), row(num_rows - 1));
+        CHECK_EQUAL(table.find_first_int(0, row(REALM_MAX_BPNODE_SIZE + 5)), REALM_MAX_BPNODE_SIZE + 5);
+        CHECK_EQUAL(table.find_first_int(0, row(range_length) - 1), not_found);
+        CHECK_EQUAL(table.count_int(0, row(2 * REALM_MAX_BPNODE_SIZE)), 1);
+        CHECK_EQUAL(table.count_int(0, row(range_length) - 3), 0);
+        CHECK_EQUAL(table.where().greater_equal(0, row(range_length) - 3).find(), range_length);
+        CHECK_EQUAL(table.where().greater(0, row(REALM_MAX_BPNODE_SIZE)).count(), num_rows - REALM_MAX_BPNODE_SIZE - 1);
+        CHECK_EQUAL(table.where().less(0, row(REALM_MAX_BPNODE_SIZE)).sum_int(0),
+                    table.where().less(0, REALM_MAX_BPNODE_SIZE).sum_int(0) +
+                        table.where().between(0, row(0) + REALM_MAX_BPNODE_SIZE, row(REALM_MAX_BPNODE_SIZE) - 1).sum_int(0));
+        CHECK_EQUAL(table.find_all_int(0, row(REALM_MAX_BPNODE_SIZE + 1)).size(), 1);
+    };
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        CHECK(is_encoded(*table, 0, 2));
+        check(*table);
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("table");
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + 1, row(REALM_MAX_BPNODE_SIZE + 1) + 1);
+        CHECK(!is_encoded(*table, 0, 1));
+        CHECK(is_encoded(*table, 0, 2));
+        table->set_int(0, REALM_MAX_BPNODE_SIZE + 1, row(REALM_MAX_BPNODE_SIZE + 1));
+        check(*table);
+        wt.commit();
+    }
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        check(*table);
+    }
+}
+
+
+// Leaves can also be encoded in memory, which is done for the row indexes of
+// views. They are decoded when they are modified.
+TEST_IF(ArrayInteger_EncodeInMemory, REALM_MAX_BPNODE_SIZE >= 1000)
+{
+    const size_t num_values = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    const int64_t epoch = 1500000000000; // Milliseconds
+    std::vector<int64_t> values;
+    for (size_t i = 0; i < num_values; ++i)
+        values.push_back(epoch + int64_t(i % 3 == 0 ? 1000 + 2 * i : i * i % 1000));
+    std::vector<int64_t> ranges;
+    for (size_t i = 0; i < num_values; ++i)
+        ranges.push_back(int64_t(i + i / 50 * 3));
+
+    ref_type ref = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn c(Allocator::get_default(), ref);
+    ref_type ref_2 = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn c_2(Allocator::get_default(), ref_2);
+    c.add(values.data(), 5);
+    c.add(values.data() + 5, num_values - 5);
+    c_2.add(ranges.data(), num_values);
+    CHECK_EQUAL(c.size(), num_values);
+    CHECK_EQUAL(c_2.size(), num_values);
+
+    auto leaf_is_encoded = [](const IntegerColumn& col, size_t leaf_ndx) {
+        const Array* root = col.get_root_array();
+        Array leaf(root->get_alloc());
+        leaf.init_from_ref(root->get_as_ref(1 + leaf_ndx));
+        return leaf.is_encoded();
+    };
+
+    auto check = [&] {
+        CHECK_EQUAL(c.size(), values.size());
+        CHECK_EQUAL(c_2.size(), ranges.size());
+        for (size_t i = 0; i < values.size(); ++i)
+            CHECK_EQUAL(c.get(i), values[i]);
+        int64_t sum = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            CHECK_EQUAL(c_2.get(i), ranges[i]);
+            sum += ranges[i];
+        }
+        CHECK_EQUAL(c_2.sum(), sum);
+        CHECK_EQUAL(c_2.maximum(), ranges.back());
+        size_t ndx = 3 * (REALM_MAX_BPNODE_SIZE / 3 + 1); // A unique value
+        CHECK_EQUAL(c.find_first(values[ndx]), ndx);
+        CHECK_EQUAL(c_2.find_first(ranges[2 * REALM_MAX_BPNODE_SIZE + 1]), 2 * REALM_MAX_BPNODE_SIZE + 1);
+        CHECK_EQUAL(c_2.find_first(ranges[50] - 1), not_found);
+        CHECK_EQUAL(c_2.lower_bound(ranges[50] - 1), 50);
+        CHECK_EQUAL(c_2.upper_bound(ranges[50]), 51);
+        CHECK_EQUAL(c_2.upper_bound(ranges[49]), 50);
+    };
+    check();
+
+    c.encode_leaves();
+    c_2.encode_leaves();
+    CHECK(leaf_is_encoded(c, 0));
+    CHECK(leaf_is_encoded(c_2, 0));
+    CHECK(leaf_is_encoded(c_2, 2));
+    check();
+
+    // Modifications decode the leaf that is modified
+    c_2.set(REALM_MAX_BPNODE_SIZE, 7);
+    CHECK(!leaf_is_encoded(c_2, 1));
+    CHECK(leaf_is_encoded(c_2, 2));
+    c_2.set(REALM_MAX_BPNODE_SIZE, ranges[REALM_MAX_BPNODE_SIZE]);
+    c_2.adjust_ge(ranges.back() + 1, 1);
+    CHECK(leaf_is_encoded(c_2, 2));
+    c_2.adjust_ge(ranges[2 * REALM_MAX_BPNODE_SIZE], 1);
+    for (size_t i = 2 * REALM_MAX_BPNODE_SIZE; i < num_values; ++i)
+        ++ranges[i];
+    c.add(7);
+    values.push_back(7);
+    c_2.add(ranges.back() + 5);
+    ranges.push_back(ranges.back() + 5);
+    c.erase(num_values - 1);
+    values.erase(values.begin() + (num_values - 1));
+    check();
+
+    c.destroy();
+    c_2.destroy();
+}
+
+// Committed leaves of nullable integer columns are stored with the nulls in a
+// bitmap. Queries must give the same results as on the plain leaves.
+TEST_IF(ArrayIntNull_NullBitmapEncodedLeaves, REALM_MAX_BPNODE_SIZE >= 1000)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    const int64_t epoch = 1500000000000; // Milliseconds
+
+    std::vector<int64_t> values_0 = {epoch, epoch + 7, epoch + 700, epoch - 1, 0, 127};
+    std::vector<int64_t> values_1 = {0, 1, 64, 126, 127, 128, -1};
+    auto run_queries = [&](const Table& table) {
+        std::vector<int64_t> results;
+        for (size_t col_ndx = 0; col_ndx < 2; ++col_ndx) {
+            for (int64_t v : col_ndx == 0 ? values_0 : values_1) {
+                results.push_back(table.where().equal(col_ndx, v).count());
+                results.push_back(table.where().not_equal(col_ndx, v).count());
+                results.push_back(table.where().greater(col_ndx, v).count());
+                results.push_back(table.where().less_equal(col_ndx, v).count());
+                results.push_back(table.where().greater_equal(col_ndx, v).find());
+                results.push_back(table.where().less(col_ndx, v).find(REALM_MAX_BPNODE_SIZE + 3));
+                results.push_back(table.where().greater(col_ndx, v).sum_int(col_ndx));
+                results.push_back(table.where().not_equal(col_ndx, v).maximum_int(col_ndx));
+            }
+            results.push_back(table.where().equal(col_ndx, null()).count());
+            results.push_back(table.where().equal(col_ndx, null()).find(REALM_MAX_BPNODE_SIZE + 1));
+            results.push_back(table.where().not_equal(col_ndx, null()).count());
+            results.push_back(table.sum_int(col_ndx));
+            results.push_back(table.minimum_int(col_ndx));
+            results.push_back(table.maximum_int(col_ndx));
+        }
+        for (size_t i = 0; i < num_rows; ++i) {
+            results.push_back(table.is_null(0, i) ? -1 : table.get_int(0, i));
+            results.push_back(table.is_null(1, i) ? -1 : table.get_int(1, i));
+        }
+        return results;
+    };
+
+    std::vector<int64_t> expected;
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "time", true);
+        table->add_column(type_Int, "small", true);
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (i % 5 != 0)
+                table->set_int(0, i, epoch + int64_t(i) * 7);
+            if (i % 3 != 0)
+                table->set_int(1, i, int64_t(i % 128));
+        }
+        expected = run_queries(*table);
+        wt.commit();
+    }
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(is_encoded(*table, 0, 1));
+        CHECK(is_encoded(*table, 1, 1));
+        CHECK(run_queries(*table) == expected);
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("table");
+        table->set_null(0, 1);
+        table->set_int(0, 0, epoch);
+        table->set_int(1, REALM_MAX_BPNODE_SIZE + 3, 127);
+        table->set_int(1, REALM_MAX_BPNODE_SIZE + 6, 32767);
+        expected = run_queries(*table);
+        wt.commit();
+    }
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK(run_queries(*table) == expected);
+    }
+}
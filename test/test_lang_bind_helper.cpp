@@ -769,6 +769,130 @@ TEST(LangBindHelper_AdvanceReadTransact_LinkListSort)
 }
 
 
+TEST(LangBindHelper_AdvanceReadTransact_IncrementalTableViewSync)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    ShortCircuitHistory hist(path);
+    SharedGroup sg(hist, SharedGroupOptions(crypt_key()));
+    SharedGroup sg_w(hist, SharedGroupOptions(crypt_key()));
+
+    {
+        WriteTransaction wt(sg_w);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_column(type_String, "str", true);
+        table->add_empty_row(200);
+        for (size_t i = 0; i < 200; ++i) {
+            table->set_int(0, i, i % 50);
+            std::string str = "s" + util::to_string(i % 7);
+            table->set_string(1, i, str);
+        }
+        wt.commit();
+    }
+
+    ReadTransaction rt(sg);
+    ConstTableRef table = rt.get_table("table");
+    TableView unsorted = table->where().less(0, 25).find_all();
+    unsorted.set_incremental_sync(true);
+    TableView sorted = table->where().not_equal(1, "s3").find_all();
+    sorted.sort(SortDescriptor(*table, {{1}, {0}}, {false, true}));
+    sorted.set_incremental_sync(true);
+    // Not refreshed incrementally as the view is limited
+    TableView limited = table->where().less(0, 25).find_all();
+    limited.limit(LimitDescriptor(10));
+    limited.set_incremental_sync(true);
+
+    auto check = [&] {
+        TableView expected_unsorted = table->where().less(0, 25).find_all();
+        unsorted.sync_if_needed();
+        CHECK_EQUAL(expected_unsorted.size(), unsorted.size());
+        for (size_t i = 0; i < expected_unsorted.size() && i < unsorted.size(); ++i)
+            CHECK_EQUAL(expected_unsorted.get_source_ndx(i), unsorted.get_source_ndx(i));
+
+        TableView expected_sorted = table->where().not_equal(1, "s3").find_all();
+        expected_sorted.sort(SortDescriptor(*table, {{1}, {0}}, {false, true}));
+        sorted.sync_if_needed();
+        CHECK_EQUAL(expected_sorted.size(), sorted.size());
+        for (size_t i = 0; i < expected_sorted.size() && i < sorted.size(); ++i)
+            CHECK_EQUAL(expected_sorted.get_source_ndx(i), sorted.get_source_ndx(i));
+
+        TableView expected_limited = table->where().less(0, 25).find_all();
+        expected_limited.limit(LimitDescriptor(10));
+        limited.sync_if_needed();
+        CHECK_EQUAL(expected_limited.size(), limited.size());
+        for (size_t i = 0; i < expected_limited.size() && i < limited.size(); ++i)
+            CHECK_EQUAL(expected_limited.get_source_ndx(i), limited.get_source_ndx(i));
+    };
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int iter = 0; iter < 50; ++iter) {
+        {
+            WriteTransaction wt(sg_w);
+            TableRef table_w = wt.get_table("table");
+            for (int op = 0; op < 5; ++op) {
+                size_t size = table_w->size();
+                switch (random.draw_int_mod(6)) {
+                    case 0:
+                    case 1:
+                        if (size > 0)
+                            table_w->set_int(0, random.draw_int_mod(size), random.draw_int_mod(50));
+                        break;
+                    case 2:
+                        if (size > 0) {
+                            std::string str = "s" + util::to_string(random.draw_int_mod(7));
+                            table_w->set_string(1, random.draw_int_mod(size), str);
+                        }
+                        break;
+                    case 3: {
+                        size_t row_ndx = random.draw_int_mod(size + 1);
+                        table_w->insert_empty_row(row_ndx);
+                        table_w->set_int(0, row_ndx, random.draw_int_mod(50));
+                        break;
+                    }
+                    case 4:
+                        if (size > 0)
+                            table_w->move_last_over(random.draw_int_mod(size));
+                        break;
+                    case 5:
+                        if (size > 0)
+                            table_w->remove(random.draw_int_mod(size));
+                        break;
+                }
+            }
+            wt.commit();
+        }
+        LangBindHelper::advance_read(sg);
+        check();
+
+        // Changes made while the views are not synchronized are accumulated
+        if (iter % 10 == 5) {
+            WriteTransaction wt(sg_w);
+            wt.get_table("table")->swap_rows(0, 1);
+            wt.commit();
+        }
+    }
+
+    // Changes in another table, and a cleared table
+    {
+        WriteTransaction wt(sg_w);
+        TableRef other = wt.add_table("other");
+        other->add_column(type_Int, "int");
+        other->add_empty_row();
+        wt.commit();
+    }
+    LangBindHelper::advance_read(sg);
+    check();
+    {
+        WriteTransaction wt(sg_w);
+        wt.get_table("table")->clear();
+        wt.commit();
+    }
+    LangBindHelper::advance_read(sg);
+    check();
+    CHECK_EQUAL(0, unsorted.size());
+}
+
+
 TEST(LangBindHelper_AdvanceReadTransact_ColumnRootTypeChange)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -7700,6 +7824,14 @@ public:
     {
         return false;
     }
+    bool add_range_index(size_t)
+    {
+        return false;
+    }
+    bool remove_range_index(size_t)
+    {
+        return false;
+    }
     bool add_primary_key(size_t)
     {
         return false;
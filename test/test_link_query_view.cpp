@@ -2037,4 +2037,104 @@ TEST(BackLink_Query_MultipleLevelsAndTables)
     CHECK_TABLE_VIEW(q.find_all(), {1});
 }
 
+// A condition on a small target table of links is evaluated on the target table, and the links are then followed
+// backwards to the rows that link to the matches. The results must be those of following the links forward.
+TEST(Link_QueryFollowsLinksBackwards)
+{
+    Group g;
+    TableRef cities = g.add_table("cities");
+    TableRef owners = g.add_table("owners");
+    TableRef items = g.add_table("items");
+    size_t col_city_name = cities->add_column(type_String, "name");
+    size_t col_owner_name = owners->add_column(type_String, "name", true);
+    size_t col_age = owners->add_column(type_Int, "age");
+    size_t col_city = owners->add_column_link(type_Link, "city", *cities);
+    size_t col_owner = items->add_column_link(type_Link, "owner", *owners);
+    size_t col_tags = items->add_column_link(type_LinkList, "tags", *owners);
+
+    cities->add_empty_row(3);
+    cities->set_string(col_city_name, 0, "Aarhus");
+    cities->set_string(col_city_name, 1, "Malmo");
+    cities->set_string(col_city_name, 2, "Oslo");
+    const size_t num_owners = 50;
+    owners->add_empty_row(num_owners);
+    for (size_t i = 0; i < num_owners; ++i) {
+        if (i != 13) {
+            std::string name = "owner " + util::to_string(i);
+            owners->set_string(col_owner_name, i, name);
+        }
+        owners->set_int(col_age, i, int64_t(20 + i));
+        if (i % 4 != 0)
+            owners->set_link(col_city, i, i % 3);
+    }
+    const size_t num_items = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    items->add_empty_row(num_items);
+    for (size_t i = 0; i < num_items; ++i) {
+        if (i % 9 != 0)
+            items->set_link(col_owner, i, i * 7 % num_owners);
+        LinkViewRef tags = items->get_linklist(col_tags, i);
+        for (size_t j = 0; j < i % 3; ++j)
+            tags->add((i + j * 11) % num_owners);
+    }
+
+    // The owner of an item, or none
+    auto owner = [&](size_t i) -> util::Optional<size_t> {
+        if (items->is_null_link(col_owner, i))
+            return util::none;
+        return items->get_link(col_owner, i);
+    };
+    auto check = [&](Query q, std::function<bool(size_t)> expected) {
+        TableView tv = q.find_all();
+        size_t n = 0;
+        for (size_t i = 0; i < num_items; ++i) {
+            if (expected(i)) {
+                if (n < tv.size())
+                    CHECK_EQUAL(tv.get_source_ndx(n), i);
+                ++n;
+            }
+        }
+        CHECK_EQUAL(tv.size(), n);
+        CHECK_EQUAL(q.count(), n);
+    };
+    auto owner_name_is = [&](size_t i, StringData name) {
+        return owner(i) && owners->get_string(col_owner_name, *owner(i)) == name;
+    };
+
+    Columns<String> owner_name = items->link(col_owner).column<String>(col_owner_name);
+    check(owner_name == "owner 7", [&](size_t i) { return owner_name_is(i, "owner 7"); });
+    check(owner_name.begins_with("owner 2"), [&](size_t i) {
+        return owner(i) && owners->get_string(col_owner_name, *owner(i)).begins_with("owner 2");
+    });
+    // Missing links match these, so they are followed forward
+    check(owner_name != "owner 7", [&](size_t i) { return !owner_name_is(i, "owner 7"); });
+    check(owner_name == StringData(), [&](size_t i) { return !owner(i) || *owner(i) == 13; });
+
+    check(items->link(col_owner).column<Int>(col_age) >= 65,
+          [&](size_t i) { return owner(i) && owners->get_int(col_age, *owner(i)) >= 65; });
+    check(items->link(col_owner).link(col_city).column<String>(col_city_name) == "Malmo", [&](size_t i) {
+        return owner(i) && !owners->is_null_link(col_city, *owner(i)) &&
+               owners->get_link(col_city, *owner(i)) == 1;
+    });
+    check(items->link(col_tags).column<String>(col_owner_name) == "owner 5", [&](size_t i) {
+        LinkViewRef tags = items->get_linklist(col_tags, i);
+        return tags->find(5) != not_found;
+    });
+
+    // Searches of part of the rows, for the owner of the last item
+    std::string name = owners->get_string(col_owner_name, *owner(num_items - 1));
+    Query q = owner_name == name;
+    const size_t start = std::min(size_t(REALM_MAX_BPNODE_SIZE + 1), num_items - 1);
+    size_t expected = start;
+    while (!owner_name_is(expected, name))
+        ++expected;
+    CHECK_EQUAL(q.find(start), expected);
+    CHECK_EQUAL(q.count(start, expected), 0);
+    CHECK_EQUAL(q.count(start, expected + 1), 1);
+
+    // The links are followed again when the query is run again
+    items->nullify_link(col_owner, expected);
+    CHECK_NOT_EQUAL(q.find(start), expected);
+    check(q, [&](size_t i) { return owner_name_is(i, name); });
+}
+
 #endif
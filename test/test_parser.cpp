@@ -2677,6 +2677,64 @@ TEST(Parser_OperatorIN)
     CHECK_EQUAL(message, "The keypath preceeding 'IN' must not contain a list, list vs list comparisons are not currently supported");
 }
 
+TEST(Parser_OperatorINList)
+{
+    Group g;
+    TableRef t = g.add_table("table");
+    size_t int_col = t->add_column(type_Int, "int");
+    size_t nullable_col = t->add_column(type_Int, "nullable", true);
+    size_t string_col = t->add_column(type_String, "string", true);
+    size_t date_col = t->add_column(type_Timestamp, "date", true);
+    size_t double_col = t->add_column(type_Double, "double");
+    size_t link_col = t->add_column_link(type_Link, "link", *t);
+    t->add_empty_row(10);
+    for (size_t i = 0; i < t->size(); ++i) {
+        t->set_int(int_col, i, i);
+        if (i % 3 != 0) {
+            t->set_int(nullable_col, i, i);
+            std::string str(i, 'a');
+            t->set_string(string_col, i, str);
+            t->set_timestamp(date_col, i, Timestamp(i, 0));
+        }
+        t->set_double(double_col, i, i / 2.0);
+        t->set_link(link_col, i, (i + 1) % t->size());
+    }
+
+    verify_query(test_context, t, "int IN {1, 2, 3, 42}", 3);
+    verify_query(test_context, t, "int in{1,2}", 2);
+    verify_query(test_context, t, "int IN {}", 0);
+    verify_query(test_context, t, "!(int IN {1, 2, 3})", 7);
+    verify_query(test_context, t, "int IN {1, 2} || int IN {8}", 3);
+    verify_query(test_context, t, "nullable IN {1, 3, 4}", 2);
+    verify_query(test_context, t, "nullable IN {1, NULL}", 5);
+    verify_query(test_context, t, "string IN {'a', \"aa\", 'aaa', 'b'}", 2);
+    verify_query(test_context, t, "string IN {'A', 'AA'}", 0);
+    verify_query(test_context, t, "string IN[c] {'A', 'AA'}", 2);
+    verify_query(test_context, t, "string IN {NULL, 'a'}", 5);
+    verify_query(test_context, t, "date IN {T1:0, T2:0, T3:0}", 2);
+    verify_query(test_context, t, "double IN {0.5, 1, 7}", 2);
+    verify_query(test_context, t, "link.int IN {0, 1}", 2);
+
+    // the values can be substituted by arguments
+    util::Any args[] = { Int(2), String("aaaa") };
+    size_t num_args = 2;
+    verify_query_sub(test_context, t, "int IN {$0, 5}", args, num_args, 2);
+    verify_query_sub(test_context, t, "string IN {$1, 'a'}", args, num_args, 2);
+
+    // the query on a property of the table itself uses a single condition for all the values
+    Query q = t->where();
+    realm::query_builder::NoArguments no_args;
+    realm::query_builder::apply_predicate(q, realm::parser::parse("int IN {1, 2, 3}").predicate, no_args);
+    CHECK(q.get_description().find("int IN {1, 2, 3}") != std::string::npos);
+
+    std::string message;
+    CHECK_THROW_ANY_GET_MESSAGE(verify_query(test_context, t, "int == {1, 2}", 0), message);
+    CHECK_EQUAL(message, "A list of values can only follow the operator 'IN'");
+    CHECK_THROW_ANY(verify_query(test_context, t, "{1, 2} IN int", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "int IN {1, int}", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "int IN {1, 2", 0));
+}
+
 
 // we won't support full object comparisons until we have stable keys in core, but as an exception
 // we allow comparison with null objects because we can serialise that and bindings use it to check agains nulls.
@@ -2730,4 +2788,64 @@ TEST(Parser_Between)
     CHECK(message.find("Invalid Predicate. The 'between' operator is not supported yet, please rewrite the expression using '>' and '<'.") != std::string::npos);
 }
 
+TEST(Parser_PreparedQuery)
+{
+    Group g;
+    TableRef t = g.add_table("person");
+    size_t int_col_ndx = t->add_column(type_Int, "age");
+    size_t str_col_ndx = t->add_column(type_String, "name");
+    t->add_empty_row(5);
+    std::vector<std::string> names = {"Billy", "Bob", "Joe", "Jane", "Joel"};
+    for (size_t i = 0; i < t->size(); ++i) {
+        t->set_int(int_col_ndx, i, i);
+        t->set_string(str_col_ndx, i, names[i]);
+    }
+
+    query_builder::AnyContext ctx;
+    query_builder::PreparedQuery prepared("age > $0 && name BEGINSWITH $1 SORT(age DESC)");
+    CHECK_EQUAL(prepared.get_num_arguments(), 2);
+
+    // The same prepared query can be applied again with other arguments
+    util::Any args_0[] = {Int(0), String("J")};
+    util::Any args_1[] = {Int(2), String("Jo")};
+    util::Any args_2[] = {Int(4), String("B")};
+    util::Any* arg_lists[] = {args_0, args_1, args_2};
+    size_t expected_counts[] = {3, 1, 0};
+    for (size_t i = 0; i < 3; ++i) {
+        query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> args(ctx, arg_lists[i], 2);
+        Query q = t->where();
+        prepared.apply_predicate(q, args);
+        CHECK_EQUAL(q.count(), expected_counts[i]);
+    }
+
+    query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> args(ctx, args_0, 2);
+    Query q = t->where();
+    prepared.apply_predicate(q, args);
+    DescriptorOrdering ordering;
+    prepared.apply_ordering(ordering, t, args);
+    TableView tv = q.find_all();
+    tv.apply_descriptor_ordering(ordering);
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_int(int_col_ndx, 0), 4);
+    CHECK_EQUAL(tv.get_int(int_col_ndx, 1), 3);
+    CHECK_EQUAL(tv.get_int(int_col_ndx, 2), 2);
+
+    // A copy shares the parsed query
+    query_builder::PreparedQuery copy = prepared;
+    Query q2 = t->where();
+    copy.apply_predicate(q2, args);
+    CHECK_EQUAL(q2.count(), 3);
+
+    // Too few arguments
+    query_builder::ArgumentConverter<util::Any, query_builder::AnyContext> too_few(ctx, args_0, 1);
+    Query q3 = t->where();
+    CHECK_THROW_ANY(prepared.apply_predicate(q3, too_few));
+
+    // Placeholders are found in lists and subqueries as well
+    CHECK_EQUAL(query_builder::PreparedQuery("age == 1").get_num_arguments(), 0);
+    CHECK_EQUAL(query_builder::PreparedQuery("age IN {$1, $3}").get_num_arguments(), 4);
+    CHECK_EQUAL(query_builder::PreparedQuery("age == 1 || (name == $2 && age == $0)").get_num_arguments(), 3);
+    CHECK_EQUAL(query_builder::PreparedQuery("SUBQUERY(items, $x, $x.price > $5).@count > 0").get_num_arguments(), 6);
+}
+
 #endif // TEST_PARSER
@@ -1584,6 +1584,80 @@ TEST(Query_Expressions0)
     CHECK_EQUAL(match, not_found);
 }
 
+// Expressions of non-nullable numeric columns and constants are evaluated a leaf's worth of rows at a time. The
+// results must be those of evaluating them row by row.
+TEST(Query_ExpressionBatches)
+{
+    Table table;
+    size_t col_price = table.add_column(type_Int, "price");
+    size_t col_qty = table.add_column(type_Int, "qty");
+    size_t col_weight = table.add_column(type_Double, "weight");
+    size_t col_discount = table.add_column(type_Int, "discount", true);
+
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(col_price, i, int64_t(i * 37 % 101));
+        table.set_int(col_qty, i, int64_t(i % 23) - 3);
+        table.set_double(col_weight, i, double(i % 17) / 4);
+        if (i % 5 != 0)
+            table.set_int(col_discount, i, int64_t(i % 7));
+    }
+
+    Columns<Int> price = table.column<Int>(col_price);
+    Columns<Int> qty = table.column<Int>(col_qty);
+    Columns<Double> weight = table.column<Double>(col_weight);
+    Columns<Int> discount = table.column<Int>(col_discount);
+
+    auto check = [&](Query q, std::function<bool(size_t)> expected) {
+        TableView tv = q.find_all();
+        size_t n = 0;
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (expected(i)) {
+                if (n < tv.size())
+                    CHECK_EQUAL(tv.get_source_ndx(n), i);
+                ++n;
+            }
+        }
+        CHECK_EQUAL(tv.size(), n);
+        CHECK_EQUAL(q.count(), n);
+    };
+    auto p = [&](size_t i) { return table.get_int(col_price, i); };
+    auto q = [&](size_t i) { return table.get_int(col_qty, i); };
+    auto w = [&](size_t i) { return table.get_double(col_weight, i); };
+
+    check(price * qty > 1000, [&](size_t i) { return p(i) * q(i) > 1000; });
+    check(price * qty <= 0, [&](size_t i) { return p(i) * q(i) <= 0; });
+    check(price + qty == 50, [&](size_t i) { return p(i) + q(i) == 50; });
+    check(price - 3 != qty * 2, [&](size_t i) { return p(i) - 3 != q(i) * 2; });
+    check(price * weight >= 100.5, [&](size_t i) { return double(p(i)) * w(i) >= 100.5; });
+    check(price / weight < 10, [&](size_t i) { return double(p(i)) / w(i) < 10; });
+    check(weight * 2 > qty, [&](size_t i) { return w(i) * 2 > double(q(i)); });
+
+    // Not evaluated in batches, as the column is nullable
+    check(price * discount > 100, [&](size_t i) {
+        return !table.is_null(col_discount, i) && p(i) * table.get_int(col_discount, i) > 100;
+    });
+    // Nor when dividing integers
+    check(price / (qty + 4) > 10, [&](size_t i) { return p(i) / (q(i) + 4) > 10; });
+
+    // Search from rows in the middle of a batch, and within a range
+    Query query = price * qty > 1000;
+    const size_t start = REALM_MAX_BPNODE_SIZE / 2 + 1;
+    size_t expected = start;
+    while (expected < num_rows && p(expected) * q(expected) <= 1000)
+        ++expected;
+    CHECK_OR_RETURN(expected < num_rows);
+    CHECK_EQUAL(query.find(start), expected);
+    CHECK_EQUAL(query.count(start, expected), 0);
+    CHECK_EQUAL(query.count(start, expected + 1), 1);
+
+    // The results of the previous search are not reused after the table is modified
+    table.set_int(col_price, expected, 0);
+    CHECK_NOT_EQUAL(query.find(start), expected);
+    check(query, [&](size_t i) { return p(i) * q(i) > 1000; });
+}
+
 TEST(Query_LimitUntyped2)
 {
     Table table;
@@ -4552,6 +4626,136 @@ TEST(Query_FindWithDescriptorOrderingOverTableviewSync)
 }
 
 
+TEST(Query_FindWithSortAndLimit)
+{
+    // When a sort is followed by a limit, the matches which cannot make it past the limit are discarded during the
+    // search. The result must be the same as if all the matches had been sorted.
+    Group g;
+    TableRef t = g.add_table("t");
+    size_t int_col = t->add_column(type_Int, "int");
+    size_t nullable_col = t->add_column(type_Int, "nullable", true);
+    size_t str_col = t->add_column(type_String, "str");
+    size_t link_col = t->add_column_link(type_Link, "link", *t);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const size_t num_rows = 5000;
+    t->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        t->set_int(int_col, i, random.draw_int_mod(500));
+        if (random.draw_bool())
+            t->set_int(nullable_col, i, random.draw_int_mod(100));
+        std::string str = util::to_string(random.draw_int_mod(50));
+        t->set_string(str_col, i, str);
+        if (random.draw_bool())
+            t->set_link(link_col, i, random.draw_int_mod(num_rows));
+    }
+
+    std::vector<SortDescriptor> sorts = {
+        SortDescriptor(*t, {{int_col}}, {true}),
+        SortDescriptor(*t, {{nullable_col}}, {false}),
+        SortDescriptor(*t, {{str_col}, {int_col}}, {false, true}),
+        SortDescriptor(*t, {{link_col, int_col}}, {true}),
+    };
+    std::vector<Query> queries = {t->where(), t->where().greater(int_col, 100), t->where().equal(int_col, 1000)};
+
+    auto check = [&](const TableView& tv, const TableView& sorted, size_t top) {
+        size_t expected_size = std::min(top, sorted.size());
+        CHECK_EQUAL(tv.size(), expected_size);
+        CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), sorted.size() - expected_size);
+        bool same_rows = true;
+        for (size_t i = 0; i < tv.size() && i < expected_size; ++i)
+            same_rows = same_rows && tv.get_source_ndx(i) == sorted.get_source_ndx(i);
+        CHECK(same_rows);
+    };
+
+    for (Query& query : queries) {
+        for (const SortDescriptor& sort : sorts) {
+            TableView sorted = query.find_all();
+            sorted.sort(sort);
+            for (size_t top : {size_t(0), size_t(1), size_t(20), size_t(1500), num_rows}) {
+                DescriptorOrdering ordering;
+                ordering.append_sort(sort);
+                ordering.append_limit(top);
+                TableView tv = query.find_all(ordering);
+                check(tv, sorted, top);
+
+                // A limit on the number of matches applies before the sort
+                TableView limited = query.find_all(0, size_t(-1), 1200);
+                limited.apply_descriptor_ordering(ordering);
+                TableView limited_sorted = query.find_all(0, size_t(-1), 1200);
+                limited_sorted.sort(sort);
+                check(limited, limited_sorted, top);
+            }
+        }
+    }
+
+    // A view which is sorted and limited stays so when it is brought back in sync
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor(*t, {{int_col}}, {false}));
+    ordering.append_limit(10);
+    ordering.append_distinct(DistinctDescriptor(*t, {{str_col}}));
+    TableView tv = t->where().find_all(ordering);
+    for (size_t i = 0; i < 20; ++i)
+        t->set_int(int_col, random.draw_int_mod(num_rows), 1000 + i);
+    tv.sync_if_needed();
+    CHECK_LESS_EQUAL(tv.size(), 10);
+    CHECK_EQUAL(tv.get_int(int_col, 0), 1019);
+}
+
+TEST(Query_Cursor)
+{
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    Table table;
+    table.add_column(type_Int, "value");
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+        table.set_int(0, i, i % 7);
+
+    // The rows from all batches of a cursor must be those of find_all()
+    auto check = [&](Query q, size_t start, size_t end, size_t limit) {
+        TableView tv = q.find_all(start, end, limit);
+        QueryCursor cursor(q, start, end, limit);
+        size_t n = 0;
+        while (cursor.next_batch()) {
+            CHECK_GREATER(cursor.size(), 0);
+            CHECK_LESS_EQUAL(cursor.size(), REALM_MAX_BPNODE_SIZE);
+            for (size_t i = 0; i < cursor.size() && n < tv.size(); ++i)
+                CHECK_EQUAL(cursor.get_source_ndx(i), tv.get_source_ndx(n++));
+            CHECK_EQUAL(cursor.get_num_found(), n);
+        }
+        CHECK_EQUAL(cursor.size(), 0);
+        CHECK_EQUAL(n, tv.size());
+        CHECK_EQUAL(cursor.get_num_found(), tv.size());
+        CHECK(!cursor.next_batch());
+    };
+
+    check(table.where(), 0, size_t(-1), size_t(-1));
+    check(table.where().greater(0, 1), 0, size_t(-1), size_t(-1));
+    check(table.where().equal(0, 3), 0, size_t(-1), size_t(-1));
+    check(table.where().equal(0, 3), 5, num_rows - 5, size_t(-1));
+    check(table.where().equal(0, 3), 0, size_t(-1), REALM_MAX_BPNODE_SIZE / 2);
+    check(table.where().greater(0, 1), 0, size_t(-1), REALM_MAX_BPNODE_SIZE + 1);
+    check(table.where().equal(0, 8), 0, size_t(-1), size_t(-1));
+    check(table.where().greater(0, 1), 0, size_t(-1), 0);
+
+    TableView odd = table.where().not_equal(0, 0).find_all();
+    odd.sort(0);
+    check(table.where(&odd).less(0, 4), 0, size_t(-1), size_t(-1));
+    check(table.where(&odd), 7, size_t(-1), 100);
+
+    // A cursor can stop early, and the query can be changed while it is in use
+    Query q = table.where().equal(0, 2);
+    QueryCursor cursor(q);
+    q.equal(0, 3);
+    CHECK(cursor.next_batch());
+    CHECK_EQUAL(cursor.get_source_ndx(0), 2);
+    CHECK_EQUAL(cursor.get_source_ndx(1), 9);
+    CHECK_EQUAL(q.count(), 0);
+
+    table.add_empty_row();
+    CHECK_LOGIC_ERROR(cursor.next_batch(), LogicError::illegal_combination);
+}
+
 TEST(Query_DistinctAndSort)
 {
     Group g;
@@ -5588,6 +5792,43 @@ TEST(Query_LongEnum)
     }
 }
 
+TEST(Query_ThreadsSpreadHits)
+{
+    // The same searches as the ones above, on several threads
+    auto check = [&](bool use_enum, const std::string& a, const std::string& b, const std::string& c) {
+        TestTable ttt;
+        ttt.add_column(type_Int, "1");
+        ttt.add_column(type_String, "2");
+        for (int i = 0; i < 30; i++) {
+            for (int j = 0; j < 10; j++) {
+                add(ttt, 5, a.c_str());
+                add(ttt, j, b.c_str());
+                add(ttt, 6, c.c_str());
+                add(ttt, 6, a.c_str());
+                add(ttt, 6, b.c_str());
+                add(ttt, 6, c.c_str());
+                add(ttt, 6, a.c_str());
+            }
+        }
+        if (use_enum)
+            ttt.optimize();
+        Query q1 = use_enum ? ttt.where().equal(0, 2).not_equal(1, a) : ttt.where().equal(0, 2).equal(1, b);
+
+        q1.set_threads(5);
+        TableView tv = q1.find_all();
+
+        CHECK_EQUAL(30, tv.size());
+        for (int i = 0; i < 30; i++) {
+            const size_t expected = i * 7 * 10 + 14 + 1;
+            const size_t actual = tv.get_source_ndx(i);
+            CHECK_EQUAL(expected, actual);
+        }
+    };
+    check(false, "a", "b", "c");
+    check(false, "aaaaaaaaaaaaaaaaaa", "bbbbbbbbbbbbbbbbbb", "cccccccccccccccccc");
+    check(true, "aaaaaaaaaaaaaaaaaa", "bbbbbbbbbbbbbbbbbb", "cccccccccccccccccc");
+}
+
 TEST(Query_BigString)
 {
     TestTable ttt;
@@ -11356,4 +11597,248 @@ TEST(Query_Group_bug)
     CHECK_EQUAL(5, q0.count());
 }
 
+TEST(Query_IntegerLeafBounds)
+{
+    // Committed leaves of an integer column get min/max bounds cached which are used to skip leaves during
+    // searches. Check that results are unaffected, also after the column has been modified.
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 5 + 17;
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i)
+            table->set_int(0, i, int64_t(i) * 2);
+        wt.commit();
+    }
+
+    // A value in the middle of the column, and a value larger than all of them
+    const size_t mid_row = num_rows / 2;
+    const int64_t mid = int64_t(mid_row) * 2;
+    const int64_t big = int64_t(num_rows) * 2 + 1;
+
+    auto check = [&](const Table& table) {
+        int64_t last = int64_t(num_rows - 1) * 2;
+        // Run every query a few times, as bounds are only computed once a leaf has been visited more than once
+        for (int i = 0; i < 3; ++i) {
+            CHECK_EQUAL(table.where().greater(0, last - 10).count(), 5);
+            CHECK_EQUAL(table.where().greater_equal(0, last - 10).count(), 6);
+            CHECK_EQUAL(table.where().less(0, 10).count(), 5);
+            CHECK_EQUAL(table.where().less_equal(0, 10).count(), 6);
+            CHECK_EQUAL(table.where().equal(0, mid).count(), 1);
+            CHECK_EQUAL(table.where().equal(0, mid + 1).count(), 0);
+            CHECK_EQUAL(table.where().equal(0, last + 2).count(), 0);
+            CHECK_EQUAL(table.where().not_equal(0, mid).count(), num_rows - 1);
+            CHECK_EQUAL(table.where().equal(0, mid).find(), mid_row);
+            CHECK_EQUAL(table.where().greater(0, last - 4).find(), num_rows - 2);
+            CHECK_EQUAL(table.where().between(0, mid, mid + 9).sum_int(0), 5 * mid + 20);
+            TableView tv = table.where().greater(0, last - 6).find_all();
+            CHECK_EQUAL(tv.size(), 3);
+            CHECK_EQUAL(tv.get_source_ndx(0), num_rows - 3);
+            CHECK_EQUAL(table.where().greater(0, 0).equal(0, 7).count(), 0);
+            CHECK_EQUAL(table.where().greater(0, 0).less(0, 7).count(), 3);
+        }
+    };
+
+    std::unique_ptr<Replication> hist_r(make_in_realm_history(path));
+    SharedGroup sg_r(*hist_r, SharedGroupOptions(crypt_key()));
+    ReadTransaction rt(sg_r);
+    check(*rt.get_table("table"));
+
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.get_table("table");
+        check(*table);
+        // Place values outside the cached bounds in the first and the last leaf
+        table->set_int(0, 0, big);
+        table->set_int(0, num_rows - 1, -1);
+        CHECK_EQUAL(table->where().equal(0, big).count(), 1);
+        CHECK_EQUAL(table->where().less(0, 0).find(), num_rows - 1);
+        wt.commit();
+    }
+
+    // The read transaction still sees the old snapshot
+    check(*rt.get_table("table"));
+
+    {
+        ReadTransaction rt2(sg);
+        ConstTableRef table = rt2.get_table("table");
+        for (int i = 0; i < 3; ++i) {
+            CHECK_EQUAL(table->where().equal(0, big).find(), 0);
+            CHECK_EQUAL(table->where().less(0, 0).find(), num_rows - 1);
+            CHECK_EQUAL(table->where().greater(0, big - 1).count(), 1);
+        }
+    }
+}
+
+TEST(Query_ParallelSearch)
+{
+    // Searching with several threads must give the same results as a search on a single thread, including the row
+    // reported by min and max when several rows hold the same value.
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 7 + 17;
+    {
+        WriteTransaction wt(sg);
+        TableRef target = wt.add_table("target");
+        target->add_column(type_Int, "id");
+        target->add_empty_row(5);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_column(type_Int, "nullable", true);
+        table->add_column(type_Double, "double");
+        table->add_column(type_String, "string");
+        table->add_column_link(type_Link, "link", *target);
+        table->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            table->set_int(0, i, int64_t(i % 1000));
+            if (i % 7 != 0)
+                table->set_int(1, i, int64_t(i));
+            table->set_double(2, i, double(i % 100) / 4);
+            table->set_string(3, i, i % 3 == 0 ? "foo" : "bar");
+            table->set_link(4, i, i % 5);
+        }
+        wt.commit();
+    }
+
+    ReadTransaction rt(sg);
+    ConstTableRef table = rt.get_table("table");
+    ConstTableRef target = rt.get_table("target");
+    std::vector<Query> queries;
+    queries.push_back(table->where().greater(0, 500));
+    queries.push_back(table->where().greater(0, 100).less(0, 120).equal(3, "foo"));
+    queries.push_back(table->where().equal(1, null()).Or().less(2, 3.0));
+    queries.push_back(table->where().Not().equal(3, "bar").greater(1, 2000));
+    queries.push_back(table->where().equal(0, 12345));
+    queries.push_back(table->where().links_to(4, target->get(2)).less(0, 10)); // Searched on a single thread
+
+    for (Query& query : queries) {
+        Query parallel = query;
+        parallel.set_threads(4);
+        CHECK_EQUAL(parallel.get_threads(), 4);
+
+        CHECK_EQUAL(parallel.count(), query.count());
+        CHECK_EQUAL(parallel.count(REALM_MAX_BPNODE_SIZE + 500, REALM_MAX_BPNODE_SIZE * 5 + 3),
+                    query.count(REALM_MAX_BPNODE_SIZE + 500, REALM_MAX_BPNODE_SIZE * 5 + 3));
+        CHECK_EQUAL(parallel.count(0, size_t(-1), 10), query.count(0, size_t(-1), 10));
+
+        TableView expected = query.find_all();
+        TableView tv = parallel.find_all();
+        CHECK_EQUAL(tv.size(), expected.size());
+        bool same_rows = true;
+        for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+            same_rows = same_rows && tv.get_source_ndx(i) == expected.get_source_ndx(i);
+        CHECK(same_rows);
+        CHECK_EQUAL(parallel.find_all(REALM_MAX_BPNODE_SIZE + 500).size(),
+                    query.find_all(REALM_MAX_BPNODE_SIZE + 500).size());
+
+        size_t expected_count = 0, count = 0;
+        size_t expected_ndx = 0, ndx = 0;
+        CHECK_EQUAL(parallel.sum_int(0, &count), query.sum_int(0, &expected_count));
+        CHECK_EQUAL(count, expected_count);
+        CHECK_EQUAL(parallel.sum_int(1), query.sum_int(1));
+        CHECK_EQUAL(parallel.average_int(1), query.average_int(1));
+        CHECK_EQUAL(parallel.minimum_int(0, nullptr, 0, size_t(-1), size_t(-1), &ndx),
+                    query.minimum_int(0, nullptr, 0, size_t(-1), size_t(-1), &expected_ndx));
+        CHECK_EQUAL(ndx, expected_ndx);
+        CHECK_EQUAL(parallel.maximum_int(0, nullptr, 0, size_t(-1), size_t(-1), &ndx),
+                    query.maximum_int(0, nullptr, 0, size_t(-1), size_t(-1), &expected_ndx));
+        CHECK_EQUAL(ndx, expected_ndx);
+        CHECK_EQUAL(parallel.maximum_int(1, &count), query.maximum_int(1, &expected_count));
+        CHECK_EQUAL(count, expected_count);
+        CHECK_EQUAL(parallel.sum_double(2), query.sum_double(2));
+        CHECK_EQUAL(parallel.minimum_double(2, nullptr, 0, size_t(-1), size_t(-1), &ndx),
+                    query.minimum_double(2, nullptr, 0, size_t(-1), size_t(-1), &expected_ndx));
+        CHECK_EQUAL(ndx, expected_ndx);
+    }
+}
+
+TEST(Query_In)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_Int, "nullable", true);
+    table.add_column(type_String, "string", true);
+    table.add_column(type_Timestamp, "date", true);
+    table.add_column(type_Double, "double");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        int64_t v = random.draw_int_mod(200);
+        table.set_int(0, i, v);
+        if (v % 10 != 0) {
+            table.set_int(1, i, v);
+            std::string str = util::to_string(v);
+            table.set_string(2, i, str);
+            table.set_timestamp(3, i, Timestamp(v, 0));
+        }
+    }
+
+    std::vector<int64_t> ints = {3, 17, 42, 42, 150, 1000, -5};
+    std::vector<StringData> strings = {"3", "17", "42", "150", "1000", "x", StringData()};
+    std::vector<Timestamp> dates = {Timestamp(3, 0), Timestamp(17, 0), Timestamp(42, 0), Timestamp(42, 1),
+                                    Timestamp(null())};
+
+    // An IN condition must find the same rows as an equality condition for each of the values
+    auto check = [&](Query in, Query expected) {
+        TableView tv = in.find_all();
+        TableView expected_tv = expected.find_all();
+        CHECK_EQUAL(tv.size(), expected_tv.size());
+        bool same_rows = true;
+        for (size_t i = 0; i < tv.size() && i < expected_tv.size(); ++i)
+            same_rows = same_rows && tv.get_source_ndx(i) == expected_tv.get_source_ndx(i);
+        CHECK(same_rows);
+        CHECK_EQUAL(in.count(), expected.count());
+        CHECK_EQUAL(in.find(500), expected.find(500));
+    };
+    auto check_all = [&] {
+        Query q0 = table.where().group();
+        Query q1 = table.where().group();
+        for (int64_t v : ints) {
+            q0.Or().equal(0, v);
+            q1.Or().equal(1, v);
+        }
+        check(table.where().in(0, ints), q0.end_group());
+        check(table.where().in(1, ints), q1.end_group());
+
+        Query q2 = table.where().group();
+        for (StringData v : strings)
+            q2.Or().equal(2, v);
+        check(table.where().in(2, strings), q2.end_group());
+        CHECK_EQUAL(table.where().Not().in(2, strings).count(), num_rows - q2.count());
+
+        Query q3 = table.where().group();
+        for (Timestamp v : dates)
+            q3.Or().equal(3, v);
+        check(table.where().in(3, dates), q3.end_group());
+
+        // In combination with other conditions
+        check(table.where().greater(0, 20).in(0, ints).less(0, 100), table.where().equal(0, 42));
+        check(table.where().in(0, std::vector<int64_t>()), table.where().equal(0, 1000));
+    };
+
+    check_all();
+
+    table.optimize(true);
+    CHECK_EQUAL(_impl::TableFriend::get_spec(table).get_column_type(2), col_type_StringEnum);
+    check_all();
+
+    for (size_t col = 0; col < 4; ++col)
+        table.add_search_index(col);
+    check_all();
+
+    std::string description = table.where().in(0, {3, 17}).get_description();
+    CHECK(description.find("int IN {3, 17}") != std::string::npos);
+
+    CHECK_LOGIC_ERROR(table.where().in(4, {1, 2}), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(table.where().in(0, dates), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(table.where().in(3, strings), LogicError::type_mismatch);
+}
+
 #endif // TEST_QUERY
@@ -1488,6 +1488,360 @@ TEST(Shared_WriterThreads)
 }
 
 
+TEST(Shared_GroupCommits)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const size_t thread_count = 8;
+    const int num_commits = 50;
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(path));
+        SharedGroupOptions options(crypt_key());
+        options.group_commits = true;
+        SharedGroup sg(*hist, options);
+        {
+            WriteTransaction wt(sg);
+            auto t = wt.add_table("test");
+            t->add_column(type_Int, "value");
+            t->add_empty_row(thread_count);
+            wt.commit();
+        }
+
+        Thread threads[thread_count];
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads[i].start([&path, i] {
+                // Writers with and without group commits can be mixed
+                SharedGroupOptions thread_options(crypt_key());
+                thread_options.group_commits = (i % 4 != 0);
+                std::unique_ptr<Replication> thread_hist(make_in_realm_history(path));
+                SharedGroup thread_sg(*thread_hist, thread_options);
+                for (int j = 0; j < num_commits; ++j) {
+                    Group& group = const_cast<Group&>(thread_sg.begin_read());
+                    LangBindHelper::promote_to_write(thread_sg);
+                    group.get_table("test")->add_int(0, i, 1);
+                    if (j % 2 == 0) {
+                        thread_sg.commit();
+                    }
+                    else {
+                        LangBindHelper::commit_and_continue_as_read(thread_sg);
+                        thread_sg.end_read();
+                    }
+                }
+            });
+        }
+        for (size_t i = 0; i < thread_count; ++i)
+            threads[i].join();
+
+        ReadTransaction rt(sg);
+        auto t = rt.get_table("test");
+        for (size_t i = 0; i < thread_count; ++i)
+            CHECK_EQUAL(num_commits, t->get_int(0, i));
+    }
+
+    // Once every commit has returned, the header of the file selects the latest snapshot
+    Group group(path, crypt_key());
+    ConstTableRef t = group.get_table("test");
+    for (size_t i = 0; i < thread_count; ++i)
+        CHECK_EQUAL(num_commits, t->get_int(0, i));
+}
+
+
+TEST(Shared_DeferredDurability)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SharedGroupOptions options(SharedGroupOptions::Durability::Deferred);
+    options.max_flush_delay = std::chrono::milliseconds(10);
+
+    // The value in the snapshot that is selected by the header of the file
+    auto durable_value = [&] {
+        Group group(path);
+        return group.get_table("test")->get_int(0, 0);
+    };
+
+    {
+        SharedGroup sg(path, false, options);
+        SharedGroup::version_type version;
+        {
+            WriteTransaction wt(sg);
+            auto t = wt.add_table("test");
+            t->add_column(type_Int, "value");
+            t->add_empty_row();
+            t->set_int(0, 0, 1);
+            version = wt.commit();
+        }
+        sg.wait_for_durable(version);
+        CHECK_EQUAL(1, durable_value());
+
+        // The background flusher catches up without being asked to
+        {
+            WriteTransaction wt(sg);
+            wt.get_table("test")->set_int(0, 0, 2);
+            wt.commit();
+        }
+        int64_t value = durable_value();
+        for (int i = 0; i < 1000 && value != 2; ++i) {
+            millisleep(1);
+            value = durable_value();
+        }
+        CHECK_EQUAL(2, value);
+
+        // Both SharedGroups use the same flusher
+        SharedGroup sg_2(path, false, options);
+        {
+            WriteTransaction wt(sg_2);
+            wt.get_table("test")->set_int(0, 0, 3);
+            version = wt.commit();
+        }
+        sg.wait_for_durable(version);
+        CHECK_EQUAL(3, durable_value());
+        {
+            WriteTransaction wt(sg);
+            wt.get_table("test")->set_int(0, 0, 4);
+            wt.commit();
+        }
+    }
+
+    // What was left is flushed when the last SharedGroup is closed
+    CHECK_EQUAL(4, durable_value());
+}
+
+
+TEST(Shared_ChangesetLog)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(crash_path);
+    std::string log_path = std::string(path) + ".wal";
+    std::string crash_log_path = std::string(crash_path) + ".wal";
+
+    SharedGroupOptions options;
+    options.durability = SharedGroupOptions::Durability::Logged;
+    // The snapshots are only flushed when the session ends
+    options.max_flush_delay = std::chrono::hours(1);
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(path));
+        SharedGroup sg(*hist, options);
+        {
+            WriteTransaction wt(sg);
+            TableRef table = wt.add_table("table");
+            table->add_column(type_Int, "value");
+            table->add_empty_row(10);
+            wt.commit();
+        }
+        for (int i = 0; i < 10; ++i) {
+            WriteTransaction wt(sg);
+            wt.get_table("table")->set_int(0, i, i + 1);
+            wt.commit();
+        }
+        CHECK_GREATER(File(log_path).get_size(), 0);
+
+        // Copies of the files taken now are what a crash would leave behind,
+        // as the header of the Realm file still selects the initial empty
+        // snapshot
+        File::copy(path, crash_path);
+        File::copy(log_path, crash_log_path);
+    }
+
+    // The snapshots were flushed when the session ended, and the log emptied
+    CHECK_EQUAL(File(log_path).get_size(), 0);
+    {
+        Group group(path);
+        ConstTableRef table = group.get_table("table");
+        for (size_t i = 0; i < 10; ++i)
+            CHECK_EQUAL(table->get_int(0, i), i + 1);
+    }
+    {
+        Group group(crash_path);
+        CHECK_NOT(group.has_table("table"));
+    }
+
+    // Add a record that was only partially written when the process crashed
+    {
+        File log(crash_log_path, File::mode_Append);
+        uint64_t header[3] = {100, 1000, 0};
+        log.write(reinterpret_cast<const char*>(header), sizeof header);
+        log.write("abc", 3);
+    }
+
+    // The commits are applied again when the next session begins, and the
+    // partial record is ignored
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(crash_path));
+        SharedGroup sg(*hist, options);
+        CHECK_EQUAL(File(crash_log_path).get_size(), 0);
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        for (size_t i = 0; i < 10; ++i)
+            CHECK_EQUAL(table->get_int(0, i), i + 1);
+    }
+    {
+        Group group(crash_path);
+        ConstTableRef table = group.get_table("table");
+        for (size_t i = 0; i < 10; ++i)
+            CHECK_EQUAL(table->get_int(0, i), i + 1);
+    }
+
+    // The changes of a commit can only be logged when there is a history
+    CHECK_LOGIC_ERROR(SharedGroup(path, false, options), LogicError::no_history);
+}
+
+
+TEST(Shared_ChangesetLogTornRecord)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(crash_path);
+    std::string log_path = std::string(path) + ".wal";
+    std::string crash_log_path = std::string(crash_path) + ".wal";
+
+    SharedGroupOptions options;
+    options.durability = SharedGroupOptions::Durability::Logged;
+    options.max_flush_delay = std::chrono::hours(1);
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(path));
+        SharedGroup sg(*hist, options);
+        SharedGroup::version_type version;
+        {
+            WriteTransaction wt(sg);
+            TableRef table = wt.add_table("table");
+            table->add_column(type_Int, "value");
+            table->add_empty_row(2);
+            table->set_int(0, 0, 1);
+            version = wt.commit();
+        }
+
+        // A writer in another process was killed while it appended the record
+        // of the next version, so the log ends in the middle of a record
+        {
+            File log(log_path, File::mode_Append);
+            uint64_t header[3] = {version + 1, 1000, 0};
+            log.write(reinterpret_cast<const char*>(header), sizeof header);
+            log.write("abc", 3);
+        }
+
+        // The next commit produces that version, and its record replaces the
+        // incomplete one
+        {
+            WriteTransaction wt(sg);
+            wt.get_table("table")->set_int(0, 1, 2);
+            CHECK_EQUAL(wt.commit(), version + 1);
+        }
+        File::copy(path, crash_path);
+        File::copy(log_path, crash_log_path);
+    }
+
+    // Both commits are applied again when the next session begins
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(crash_path));
+        SharedGroup sg(*hist, options);
+        ReadTransaction rt(sg);
+        ConstTableRef table = rt.get_table("table");
+        CHECK_EQUAL(table->get_int(0, 0), 1);
+        CHECK_EQUAL(table->get_int(0, 1), 2);
+    }
+}
+
+
+TEST(Shared_PinnedVersions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    uint64_t reported_version = 0;
+    uint64_t reported_num_versions = 0;
+    int num_reports = 0;
+    SharedGroupOptions options;
+    options.max_retained_versions = 4;
+    options.retention_callback = [&](uint64_t oldest_version, uint64_t num_versions, uint64_t) {
+        reported_version = oldest_version;
+        reported_num_versions = num_versions;
+        ++num_reports;
+    };
+    SharedGroup sg(path, false, options);
+    SharedGroup sg_r(path);
+    {
+        WriteTransaction wt(sg);
+        wt.add_table("table")->add_column(type_Int, "value");
+        wt.commit();
+    }
+    CHECK(sg.get_pinned_versions().empty());
+
+    // A long-lived reader pins the version it reads
+    sg_r.begin_read();
+    SharedGroup::version_type pinned_version = sg_r.get_version_of_current_transaction().version;
+    for (int i = 0; i < 6; ++i) {
+        WriteTransaction wt(sg);
+        wt.get_table("table")->add_empty_row();
+        wt.commit();
+    }
+    std::vector<SharedGroup::PinnedVersion> versions = sg.get_pinned_versions();
+    CHECK_EQUAL(versions.size(), 1);
+    CHECK_EQUAL(versions[0].version, pinned_version);
+    CHECK_EQUAL(versions[0].num_readers, 1);
+#ifndef _WIN32
+    CHECK_EQUAL(versions[0].owner_pid, uint64_t(getpid()));
+#endif
+    CHECK_GREATER_EQUAL(versions[0].age.count(), 0);
+
+    // The callback is called once for the pinned version, when the limit is
+    // first exceeded
+    CHECK_EQUAL(num_reports, 1);
+    CHECK_EQUAL(reported_version, pinned_version);
+    CHECK_EQUAL(reported_num_versions, 5);
+
+    // Pins and the current version of a write transaction are reported too
+    SharedGroup::VersionID pin = sg_r.pin_version();
+    {
+        WriteTransaction wt(sg);
+        versions = sg.get_pinned_versions();
+        CHECK_EQUAL(versions.size(), 2);
+        CHECK_EQUAL(versions[0].version, pinned_version);
+        CHECK_EQUAL(versions[0].num_readers, 2);
+        CHECK_EQUAL(versions[1].version, wt.get_version());
+    }
+    sg_r.unpin_version(pin);
+    sg_r.end_read();
+    sg_r.begin_read();
+    {
+        WriteTransaction wt(sg);
+        wt.get_table("table")->add_empty_row();
+        wt.commit();
+    }
+    CHECK_EQUAL(num_reports, 1);
+    versions = sg.get_pinned_versions();
+    CHECK_EQUAL(versions.size(), 1);
+    CHECK_GREATER(versions[0].version, pinned_version);
+    sg_r.end_read();
+}
+
+
+TEST(Shared_RetainedBytes)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    uint64_t reported_num_bytes = 0;
+    SharedGroupOptions options;
+    options.max_retained_bytes = 1;
+    options.retention_callback = [&](uint64_t, uint64_t, uint64_t num_bytes) { reported_num_bytes = num_bytes; };
+    SharedGroup sg(path, false, options);
+    SharedGroup sg_r(path);
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "value");
+        table->add_empty_row(1000);
+        wt.commit();
+    }
+    {
+        // The space freed by these commits cannot be reused while the reader is
+        // bound to the first version
+        ReadTransaction rt(sg_r);
+        for (int i = 0; i < 10; ++i) {
+            WriteTransaction wt(sg);
+            wt.get_table("table")->set_int(0, i, i);
+            wt.commit();
+        }
+        CHECK_GREATER(reported_num_bytes, 0);
+    }
+}
+
+
 #if !REALM_ENABLE_ENCRYPTION && defined(ENABLE_ROBUST_AGAINST_DEATH_DURING_WRITE)
 // this unittest has issues that has not been fully understood, but could be
 // related to interaction between posix robust mutexes and the fork() system call.
@@ -4605,6 +4605,173 @@ TEST(Table_Pivot)
 }
 
 
+TEST(Table_GroupBy)
+{
+    Group g;
+    TableRef target = g.add_table("target");
+    TableRef table = g.add_table("table");
+    target->add_column(type_String, "country");
+    size_t col_city = table->add_column(type_String, "city", true);
+    size_t col_kind = table->add_column(type_Int, "kind");
+    size_t col_price = table->add_column(type_Int, "price", true);
+    size_t col_weight = table->add_column(type_Double, "weight");
+    size_t col_time = table->add_column(type_Timestamp, "time");
+    size_t col_link = table->add_column_link(type_Link, "link", *target);
+
+    target->add_empty_row(2);
+    target->set_string(0, 0, "Denmark");
+    target->set_string(0, 1, "Sweden");
+
+    // city, kind, price, weight, time, link
+    table->add_empty_row(7);
+    const char* cities[] = {"Aarhus", "Malmo", "Aarhus", nullptr, "Aarhus", nullptr, "Malmo"};
+    int64_t kinds[] = {1, 1, 1, 2, 2, 2, 1};
+    util::Optional<int64_t> prices[] = {10, 20, 30, util::none, 5, 7, util::none};
+    double weights[] = {1.5, 2.5, 0.5, 3, 4, 5, 6};
+    for (size_t i = 0; i < 7; ++i) {
+        table->set_string(col_city, i, cities[i]);
+        table->set_int(col_kind, i, kinds[i]);
+        if (prices[i])
+            table->set_int(col_price, i, *prices[i]);
+        else
+            table->set_null(col_price, i);
+        table->set_double(col_weight, i, weights[i]);
+        table->set_timestamp(col_time, i, Timestamp(int64_t(i), 0));
+        if (i != 3 && i != 5)
+            table->set_link(col_link, i, cities[i][0] == 'A' ? 0 : 1);
+    }
+
+    GroupBy group_by(*table, {{col_city}, {col_kind}});
+    size_t count = group_by.count();
+    size_t sum = group_by.sum(col_price);
+    size_t min = group_by.minimum(col_price);
+    size_t max = group_by.maximum(col_time);
+    size_t avg = group_by.average(col_weight);
+
+    GroupByResult result = group_by.aggregate();
+    CHECK_EQUAL(4, result.size());
+    // Aarhus/1, Malmo/1, null/2 and Aarhus/2, in the order of their first rows
+    CHECK_EQUAL(0, result.get_row(0));
+    CHECK_EQUAL(1, result.get_row(1));
+    CHECK_EQUAL(3, result.get_row(2));
+    CHECK_EQUAL(4, result.get_row(3));
+    CHECK_EQUAL(2, result.get_count(0));
+    CHECK_EQUAL(2, result.get_count(1));
+    CHECK_EQUAL(2, result.get_count(2));
+    CHECK_EQUAL(1, result.get_count(3));
+    CHECK_EQUAL(2, result.get(0, count)->get_int());
+    CHECK_EQUAL(40, result.get(0, sum)->get_int());
+    CHECK_EQUAL(20, result.get(1, sum)->get_int());
+    CHECK_EQUAL(7, result.get(2, sum)->get_int());
+    CHECK_EQUAL(10, result.get(0, min)->get_int());
+    CHECK_EQUAL(7, result.get(2, min)->get_int());
+    CHECK_EQUAL(Timestamp(2, 0), result.get(0, max)->get_timestamp());
+    CHECK_EQUAL(Timestamp(6, 0), result.get(1, max)->get_timestamp());
+    CHECK_EQUAL(1.0, result.get(0, avg)->get_double());
+    CHECK_EQUAL(4.25, result.get(1, avg)->get_double());
+    CHECK_EQUAL(4.0, result.get(2, avg)->get_double());
+    CHECK_EQUAL(5, result.get(3, min)->get_int());
+
+    // Rows that do not match the query are left out of their groups
+    Query query = table->where().greater(col_weight, 1.0);
+    result = group_by.aggregate(query);
+    CHECK_EQUAL(4, result.size());
+    CHECK_EQUAL(0, result.get_row(0));
+    CHECK_EQUAL(1, result.get_count(0));
+    CHECK_EQUAL(4, result.get_row(3));
+    CHECK_EQUAL(5, result.get(3, sum)->get_int());
+
+    // Minimum and average are none when all values of a group are null
+    TableView view = table->where().equal(col_price, null()).find_all();
+    result = group_by.aggregate(view);
+    CHECK_EQUAL(2, result.size());
+    CHECK_EQUAL(3, result.get_row(0));
+    CHECK_EQUAL(6, result.get_row(1));
+    CHECK_NOT(result.get(0, min));
+    CHECK_EQUAL(0, result.get(0, sum)->get_int());
+    CHECK_EQUAL(6.0, result.get(1, avg)->get_double());
+
+    // Grouping across a link, where rows with a null link form a group of their own
+    GroupBy by_country(*table, {{col_link, 0}});
+    size_t country_sum = by_country.sum(col_weight);
+    result = by_country.aggregate();
+    CHECK_EQUAL(3, result.size());
+    CHECK_EQUAL(0, result.get_row(0));
+    CHECK_EQUAL(1, result.get_row(1));
+    CHECK_EQUAL(3, result.get_row(2));
+    CHECK_EQUAL(6.0, result.get(0, country_sum)->get_double());
+    CHECK_EQUAL(8.5, result.get(1, country_sum)->get_double());
+    CHECK_EQUAL(8.0, result.get(2, country_sum)->get_double());
+
+    // Grouping by the linked row itself
+    GroupBy by_link(*table, {{col_link}});
+    by_link.count();
+    CHECK_EQUAL(3, by_link.aggregate().size());
+
+    CHECK_LOGIC_ERROR(GroupBy(*table, {{col_kind, 0}}), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(GroupBy(*table, {{col_link}, {42}}), LogicError::column_index_out_of_range);
+    CHECK_LOGIC_ERROR(group_by.sum(col_city), LogicError::type_mismatch);
+    CHECK_LOGIC_ERROR(group_by.average(col_time), LogicError::type_mismatch);
+}
+
+
+TEST(Table_GroupByWithThreads)
+{
+    Table table;
+    size_t col_str = table.add_column(type_String, "str");
+    size_t col_int = table.add_column(type_Int, "int", true);
+    size_t col_float = table.add_column(type_Float, "float");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const size_t num_rows = 45000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        std::string str = "s" + util::to_string(random.draw_int_mod(100));
+        table.set_string(col_str, i, str);
+        if (random.draw_int_mod(10) == 0)
+            table.set_null(col_int, i);
+        else
+            table.set_int(col_int, i, random.draw_int_mod(1000));
+        table.set_float(col_float, i, float(random.draw_int_mod(20)) - 10);
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        GroupBy group_by(table, {{col_str}, {col_float}});
+        group_by.count();
+        group_by.sum(col_int);
+        group_by.minimum(col_int);
+        group_by.maximum(col_float);
+        group_by.average(col_int);
+        GroupByResult expected = group_by.aggregate();
+        group_by.set_threads(4);
+        GroupByResult result = group_by.aggregate();
+
+        CHECK_EQUAL(expected.size(), result.size());
+        size_t total = 0;
+        for (size_t g = 0; g < expected.size() && g < result.size(); ++g) {
+            CHECK_EQUAL(expected.get_row(g), result.get_row(g));
+            CHECK_EQUAL(expected.get_count(g), result.get_count(g));
+            // Count and sum
+            CHECK_EQUAL(expected.get(g, 0)->get_int(), result.get(g, 0)->get_int());
+            CHECK_EQUAL(expected.get(g, 1)->get_int(), result.get(g, 1)->get_int());
+            // Minimum and average are none for the groups where all values are null
+            CHECK_EQUAL(bool(expected.get(g, 2)), bool(result.get(g, 2)));
+            CHECK_EQUAL(bool(expected.get(g, 4)), bool(result.get(g, 4)));
+            if (expected.get(g, 2) && result.get(g, 2)) {
+                CHECK_EQUAL(expected.get(g, 2)->get_int(), result.get(g, 2)->get_int());
+                CHECK_APPROXIMATELY_EQUAL(expected.get(g, 4)->get_double(), result.get(g, 4)->get_double(), 1e-9);
+            }
+            CHECK_EQUAL(expected.get(g, 3)->get_float(), result.get(g, 3)->get_float());
+            total += result.get_count(g);
+        }
+        CHECK_EQUAL(num_rows, total);
+
+        // Test with enumerated strings in second loop
+        table.optimize();
+    }
+}
+
+
 namespace {
 
 void compare_table_with_slice(TestContext& test_context, const Table& table, const Table& slice, size_t offset,
@@ -8116,6 +8283,517 @@ TEST(Table_StaleLinkIndexOnTableRemove)
     CHECK_EQUAL(t2->get_link(0, 0), realm::npos); // no link
 }
 
+TEST(Table_ColumnStatistics)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(realm::make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    ColumnStatistics stats;
+
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.add_table("table");
+        t->add_column(type_Int, "int");
+        t->add_column(type_Int, "nullable", true);
+        t->add_column(type_String, "string");
+        t->add_column(type_Bool, "bool");
+        t->add_empty_row(1000);
+        for (size_t i = 0; i < 1000; ++i) {
+            t->set_int(0, i, i % 100);
+            if (i % 4 != 0)
+                t->set_int(1, i, i);
+            t->set_bool(3, i, i % 10 == 0);
+        }
+        // Statistics are only computed on commit
+        CHECK_NOT(t->get_column_statistics(0, stats));
+        wt.commit();
+    }
+
+    // All rows are sampled in a table this small, so the statistics are exact
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(0, stats));
+        CHECK_EQUAL(stats.row_count, 1000);
+        CHECK_EQUAL(stats.null_count, 0);
+        CHECK_EQUAL(stats.distinct_count, 100);
+        CHECK_EQUAL(stats.min(), 0);
+        CHECK_EQUAL(stats.max(), 99);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Equal(), 5), 0.01, 0.001);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(NotEqual(), 5), 0.99, 0.001);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Less(), 50), 0.5, 0.05);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(GreaterEqual(), 50), 0.5, 0.05);
+        CHECK_EQUAL(stats.estimate(Less(), 0), 0);
+        CHECK_EQUAL(stats.estimate(LessEqual(), 99), 1);
+        CHECK_EQUAL(stats.estimate(Greater(), 99), 0);
+        CHECK_EQUAL(stats.estimate(Equal(), 100), 0);
+        CHECK_EQUAL(stats.estimate(Equal(), null()), 0);
+
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_EQUAL(stats.null_count, 250);
+        CHECK_EQUAL(stats.distinct_count, 750);
+        CHECK_EQUAL(stats.min(), 1);
+        CHECK_EQUAL(stats.max(), 999);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Equal(), null()), 0.25, 0.001);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Greater(), 500), 0.375, 0.05);
+        CHECK_EQUAL(stats.estimate(Greater(), null()), 0);
+
+        CHECK_NOT(t->get_column_statistics(2, stats));
+
+        CHECK(t->get_column_statistics(3, stats));
+        CHECK_EQUAL(stats.distinct_count, 2);
+        CHECK_GREATER(stats.estimate(Equal(), 1), 0.05);
+        CHECK_LESS(stats.estimate(Equal(), 1), 0.15);
+    }
+
+    // Only the statistics of modified columns are recomputed
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        for (size_t i = 0; i < 1000; ++i)
+            t->set_null(1, i);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_EQUAL(stats.null_count, 1000);
+        CHECK_NOT(stats.has_values());
+        CHECK_EQUAL(stats.estimate(Equal(), null()), 1);
+        CHECK_EQUAL(stats.estimate(Equal(), 7), 0);
+        CHECK(t->get_column_statistics(0, stats));
+        CHECK_EQUAL(stats.distinct_count, 100);
+    }
+
+    // Columns are shifted by a schema change
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->insert_column(0, type_Int, "unique");
+        for (size_t i = 0; i < 1000; ++i)
+            t->set_int(0, i, i);
+        t->remove_column(4);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(0, stats));
+        CHECK_EQUAL(stats.distinct_count, 1000);
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_EQUAL(stats.distinct_count, 100);
+        CHECK(t->get_column_statistics(2, stats));
+        CHECK_EQUAL(stats.null_count, 1000);
+        CHECK_NOT(t->get_column_statistics(3, stats));
+        CHECK_NOT(t->get_column_statistics(4, stats));
+    }
+
+    // Larger tables are sampled
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->add_empty_row(99000);
+        for (size_t i = 1000; i < 100000; ++i) {
+            t->set_int(0, i, i);
+            t->set_int(1, i, i % 100);
+        }
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(0, stats));
+        CHECK_EQUAL(stats.row_count, 100000);
+        CHECK_GREATER(stats.distinct_count, 10000);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Less(), 50000), 0.5, 0.1);
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_EQUAL(stats.distinct_count, 100);
+        CHECK_APPROXIMATELY_EQUAL(stats.estimate(Equal(), 5), 0.01, 0.005);
+
+        // The statistics only guide the order in which the conditions are searched
+        Query q = t->where().equal(1, 5).greater(0, 99000).not_equal(2, 3);
+        CHECK_EQUAL(q.count(), 10);
+        CHECK_EQUAL(q.find(), 99005);
+        TableView tv = q.find_all();
+        CHECK_EQUAL(tv.size(), 10);
+        CHECK_EQUAL(tv.get_source_ndx(9), 99905);
+        Query q2 = t->where().greater(0, 500).equal(1, 5);
+        CHECK_EQUAL(q2.find(), 505);
+        CHECK_EQUAL(q2.count(), 995);
+    }
+
+    // The statistics are kept until a large enough part of the column has been modified
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->set_int(1, 50000, 1000);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_GREATER(stats.modified_count, 0);
+        CHECK_LESS_EQUAL(stats.modified_count, REALM_MAX_BPNODE_SIZE + 1);
+        CHECK_EQUAL(stats.max(), 99);
+        CHECK(t->get_column_statistics(0, stats));
+        CHECK_EQUAL(stats.modified_count, 0);
+    }
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        // More than a tenth of the rows, whatever the size of the leaves
+        for (size_t i = 0; i < 100000; i += 5)
+            t->set_int(1, i, 1000);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->get_column_statistics(1, stats));
+        CHECK_EQUAL(stats.modified_count, 0);
+        CHECK_EQUAL(stats.max(), 1000);
+    }
+}
+
+// Files that are kept in file format 9 must not get the column statistics, as
+// older versions of the library expect the top array of a table to have two
+// slots.
+TEST_IF(Table_ColumnStatisticsFileFormat9, REALM_MAX_BPNODE_SIZE == 4 || REALM_MAX_BPNODE_SIZE == 1000)
+{
+    std::string path = test_util::get_test_resource_path() + "test_upgrade_database_" +
+                       util::to_string(REALM_MAX_BPNODE_SIZE) + "_9_to_10.realm";
+    CHECK_OR_RETURN(File::exists(path));
+    SHARED_GROUP_TEST_PATH(temp_copy);
+    File::copy(path, temp_copy);
+
+    // Without a history, the file is not upgraded
+    SharedGroup sg(temp_copy);
+    ColumnStatistics stats;
+    {
+        WriteTransaction wt(sg);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(wt.get_group()), 9);
+        TableRef t = wt.get_table("table");
+        t->set_int(0, 0, 7);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        CHECK_NOT(rt.get_table("table")->get_column_statistics(0, stats));
+    }
+}
+
+TEST_IF(Table_RangeIndexFileFormat9, REALM_MAX_BPNODE_SIZE == 4 || REALM_MAX_BPNODE_SIZE == 1000)
+{
+    std::string path = test_util::get_test_resource_path() + "test_upgrade_database_" +
+                       util::to_string(REALM_MAX_BPNODE_SIZE) + "_9_to_10.realm";
+    CHECK_OR_RETURN(File::exists(path));
+    SHARED_GROUP_TEST_PATH(temp_copy);
+    File::copy(path, temp_copy);
+
+    // Without a history, the file is not upgraded, and older versions of the
+    // library must still be able to open it
+    {
+        SharedGroup sg(temp_copy);
+        WriteTransaction wt(sg);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(wt.get_group()), 9);
+        TableRef t = wt.get_table("table");
+        CHECK_LOGIC_ERROR(t->add_range_index(0), LogicError::file_format_too_old);
+        CHECK_NOT(t->has_range_index(0));
+        t->set_int(0, 0, 7);
+        wt.commit();
+    }
+
+    // Once the file is upgraded, the index can be added
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(temp_copy));
+        SharedGroup sg(*hist);
+        WriteTransaction wt(sg);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(wt.get_group()), 11);
+        TableRef t = wt.get_table("table");
+        t->add_range_index(0);
+        wt.commit();
+    }
+    {
+        std::unique_ptr<Replication> hist(make_in_realm_history(temp_copy));
+        SharedGroup sg(*hist);
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        CHECK(t->has_range_index(0));
+        std::unique_ptr<RangeIndex> index = t->get_range_index(0);
+        CHECK_OR_RETURN(index);
+        CHECK_EQUAL(index->size(), t->size());
+        CHECK_EQUAL(t->where().equal(0, 7).find_all().size(), t->where().equal(0, 7).count());
+    }
+}
+
+TEST(Table_RangeIndex)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(realm::make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    const size_t num_rows = 2000;
+
+    {
+        Table t;
+        t.add_column(type_Int, "int");
+        CHECK_LOGIC_ERROR(t.add_range_index(0), LogicError::wrong_kind_of_table);
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.add_table("table");
+        t->add_column(type_Int, "int");
+        t->add_column(type_Int, "nullable", true);
+        t->add_column(type_Timestamp, "timestamp", true);
+        t->add_column(type_Float, "float");
+        t->add_column(type_Double, "double", true);
+        t->add_column(type_String, "string");
+        t->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            t->set_int(0, i, int64_t(i * 7 % num_rows));
+            if (i % 5 != 0)
+                t->set_int(1, i, int64_t(i % 500));
+            else
+                t->set_null(1, i);
+            if (i % 7 != 0)
+                t->set_timestamp(2, i, Timestamp(int64_t(i % 1000), 0));
+            else
+                t->set_null(2, i);
+            t->set_float(3, i, float(i * 3 % num_rows) / 2);
+            if (i % 3 != 0)
+                t->set_double(4, i, double(i % 700) - 350);
+            else
+                t->set_null(4, i);
+            t->set_string(5, i, i % 2 == 0 ? "even" : "odd");
+        }
+
+        CHECK_LOGIC_ERROR(t->add_range_index(5), LogicError::illegal_type);
+        CHECK_LOGIC_ERROR(t->add_range_index(6), LogicError::column_index_out_of_range);
+        for (size_t col = 0; col < 5; ++col) {
+            t->add_range_index(col);
+            CHECK(t->has_range_index(col));
+        }
+        CHECK_NOT(t->has_range_index(5));
+        CHECK_NOT(t->has_range_index(6));
+
+        // The indexes are built at once
+        CHECK(t->get_range_index(0));
+        wt.commit();
+    }
+
+    // Compare the results of a query with those of testing every row
+    auto check_query = [&](Query q, std::function<bool(size_t)> matches) {
+        std::vector<size_t> expected;
+        size_t n = q.get_table()->size();
+        for (size_t i = 0; i < n; ++i) {
+            if (matches(i))
+                expected.push_back(i);
+        }
+        TableView tv = q.find_all();
+        std::vector<size_t> actual;
+        for (size_t i = 0; i < tv.size(); ++i)
+            actual.push_back(tv.get_source_ndx(i));
+        CHECK(actual == expected);
+        CHECK_EQUAL(q.count(), expected.size());
+        CHECK_EQUAL(q.find(), expected.empty() ? not_found : expected.front());
+    };
+
+    auto check_queries = [&](ConstTableRef t) {
+        auto get_int = [&](size_t i) { return t->get_int(0, i); };
+        auto get_nullable = [&](size_t i) { return t->get<util::Optional<int64_t>>(1, i); };
+        auto get_timestamp = [&](size_t i) { return t->get_timestamp(2, i); };
+        auto get_float = [&](size_t i) { return t->get_float(3, i); };
+        auto get_double = [&](size_t i) { return t->get_double(4, i); };
+        auto is_odd = [&](size_t i) { return t->get_string(5, i) == "odd"; };
+
+        check_query(t->where().equal(0, 1234), [&](size_t i) { return get_int(i) == 1234; });
+        check_query(t->where().greater(0, 1980), [&](size_t i) { return get_int(i) > 1980; });
+        check_query(t->where().greater_equal(0, 1980), [&](size_t i) { return get_int(i) >= 1980; });
+        check_query(t->where().less(0, 20), [&](size_t i) { return get_int(i) < 20; });
+        check_query(t->where().less_equal(0, 20), [&](size_t i) { return get_int(i) <= 20; });
+        check_query(t->where().less(0, 1000), [&](size_t i) { return get_int(i) < 1000; });
+        check_query(t->where().between(0, 1000, 1010),
+                    [&](size_t i) { return get_int(i) >= 1000 && get_int(i) <= 1010; });
+        check_query(t->where().greater(0, 1900).equal(5, "odd"),
+                    [&](size_t i) { return get_int(i) > 1900 && is_odd(i); });
+        check_query(t->where().equal(5, "odd").Or().less(0, 10),
+                    [&](size_t i) { return is_odd(i) || get_int(i) < 10; });
+        CHECK_EQUAL(t->where().less(0, 20).sum_int(0), 190);
+        CHECK_EQUAL(t->where().less(0, 20).maximum_int(0), 19);
+
+        check_query(t->where().equal(1, 7), [&](size_t i) { return get_nullable(i) == util::some<int64_t>(7); });
+        check_query(t->where().less(1, 3), [&](size_t i) { return get_nullable(i) && *get_nullable(i) < 3; });
+        check_query(t->where().greater(1, 495), [&](size_t i) { return get_nullable(i) && *get_nullable(i) > 495; });
+        check_query(t->where().equal(1, null()), [&](size_t i) { return !get_nullable(i); });
+
+        check_query(t->where().greater(2, Timestamp(990, 0)),
+                    [&](size_t i) { return !get_timestamp(i).is_null() && get_timestamp(i) > Timestamp(990, 0); });
+        check_query(t->where().less(2, Timestamp(5, 0)),
+                    [&](size_t i) { return !get_timestamp(i).is_null() && get_timestamp(i) < Timestamp(5, 0); });
+        check_query(t->where().equal(2, Timestamp(500, 0)),
+                    [&](size_t i) { return get_timestamp(i) == Timestamp(500, 0); });
+        check_query(t->where().equal(2, Timestamp{}), [&](size_t i) { return get_timestamp(i).is_null(); });
+
+        check_query(t->where().greater(3, 995.f), [&](size_t i) { return get_float(i) > 995.f; });
+        check_query(t->where().less_equal(3, 2.f), [&](size_t i) { return get_float(i) <= 2.f; });
+        check_query(t->where().equal(3, 10.f), [&](size_t i) { return get_float(i) == 10.f; });
+
+        check_query(t->where().greater(4, 340.), [&](size_t i) { return !t->is_null(4, i) && get_double(i) > 340.; });
+        check_query(t->where().less(4, -345.), [&](size_t i) { return !t->is_null(4, i) && get_double(i) < -345.; });
+        CHECK_EQUAL(t->where().greater(4, 340.).count(), t->where().greater(4, 340.).find_all().size());
+    };
+
+    // Check that a sorted view that may be read from a range index is the same as one that was sorted
+    auto check_sorted_view = [&](ConstTableRef t, size_t col, bool ascending) {
+        ConstTableView tv_1 = t->get_sorted_view(col, ascending);
+        ConstTableView tv_2 = t->where().find_all();
+        tv_2.sort(col, ascending);
+        CHECK_EQUAL(tv_1.size(), tv_2.size());
+        bool equal = tv_1.size() == tv_2.size();
+        for (size_t i = 0; equal && i < tv_1.size(); ++i)
+            equal = tv_1.get_source_ndx(i) == tv_2.get_source_ndx(i);
+        CHECK(equal);
+    };
+
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        for (size_t col = 0; col < 5; ++col)
+            CHECK(t->get_range_index(col));
+        CHECK_EQUAL(t->get_range_index(0)->size(), num_rows);
+        CHECK_EQUAL(t->get_range_index(0)->get(0), 0);
+        CHECK_EQUAL(t->get_range_index(0)->get(1), 1143);
+        // NaNs and nulls are not listed in the index of a float or double column
+        CHECK_EQUAL(t->get_range_index(4)->size(), t->where().not_equal(4, null()).count());
+        check_queries(t);
+
+        check_sorted_view(t, 0, true);
+        check_sorted_view(t, 0, false);
+        check_sorted_view(t, 1, true);
+        check_sorted_view(t, 2, true);
+        ConstTableView tv = t->get_sorted_view(0);
+        tv.sync_if_needed();
+        for (size_t i = 0; i < num_rows; ++i)
+            CHECK_EQUAL(tv.get_int(0, i), int64_t(i));
+    }
+
+    // Check that an index lists the rows that it should, in the order of their values
+    auto check_index = [&](ConstTableRef t, size_t col) {
+        std::unique_ptr<RangeIndex> index = t->get_range_index(col);
+        CHECK_OR_RETURN(index);
+        DataType type = t->get_column_type(col);
+        bool skips_nulls = (type == type_Float || type == type_Double) && t->is_nullable(col);
+        ConstTableView tv = skips_nulls ? t->where().not_equal(col, null()).find_all() : t->where().find_all();
+        tv.sort(col);
+        CHECK_EQUAL(index->size(), tv.size());
+        bool equal = index->size() == tv.size();
+        for (size_t i = 0; equal && i < tv.size(); ++i)
+            equal = index->get(i) == tv.get_source_ndx(i);
+        CHECK(equal);
+    };
+
+    // The indexes are kept up to date as the table is modified
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->set_int(0, 0, 5000);
+        t->set_float(3, 1, 5000.f);
+        t->set_null(1, 2);
+        t->set_double(4, 3, 1.5);
+        t->set_null(4, 4);
+        t->add_int(0, 5, 3);
+        t->insert_empty_row(10, 3);
+        t->add_empty_row();
+        t->remove(20);
+        t->move_last_over(30);
+        t->swap_rows(40, 50);
+        t->move_row(60, 70);
+        t->move_row(90, 80);
+        t->move_row(100, 101);
+        for (size_t col = 0; col < 5; ++col)
+            check_index(t, col);
+        check_queries(t);
+        check_sorted_view(t, 0, true);
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(sg);
+        ConstTableRef t = rt.get_table("table");
+        for (size_t col = 0; col < 5; ++col)
+            check_index(t, col);
+        CHECK_EQUAL(t->where().greater(0, 1990).find(), 0);
+        check_queries(t);
+        check_sorted_view(t, 0, true);
+    }
+
+    // Indexes move along with their columns, and other SharedGroups learn about added and removed indexes
+    {
+        std::unique_ptr<Replication> hist_2(realm::make_in_realm_history(path));
+        SharedGroup sg_2(*hist_2, SharedGroupOptions(crypt_key()));
+        const Group& group_2 = sg_2.begin_read();
+        ConstTableRef t_2 = group_2.get_table("table");
+        CHECK(t_2->has_range_index(4));
+        {
+            WriteTransaction wt(sg);
+            TableRef t = wt.get_table("table");
+            t->remove_range_index(4);
+            t->insert_column(0, type_Int, "new");
+            wt.commit();
+        }
+        LangBindHelper::advance_read(sg_2);
+        CHECK_NOT(t_2->has_range_index(0));
+        CHECK(t_2->has_range_index(1));
+        CHECK(t_2->get_range_index(1));
+        CHECK_NOT(t_2->has_range_index(5));
+        CHECK_NOT(t_2->get_range_index(5));
+        CHECK_EQUAL(t_2->where().greater(1, 1990).find(), 0);
+        sg_2.end_read();
+    }
+
+    // A copy of a group that has uncommitted modifications contains up to date indexes
+    {
+        GROUP_TEST_PATH(copy_path);
+        {
+            WriteTransaction wt(sg);
+            TableRef t = wt.get_table("table");
+            t->set_int(1, 1, 6000);
+            wt.get_group().write(copy_path, crypt_key());
+        }
+        Group group(copy_path, crypt_key());
+        ConstTableRef t = group.get_table("table");
+        CHECK(t->get_range_index(1));
+        CHECK_EQUAL(t->where().greater(1, 1990).count(), 11);
+        CHECK_EQUAL(t->where().greater(1, 5500).find(), 1);
+        check_index(t, 1);
+    }
+
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->clear();
+        CHECK_EQUAL(t->get_range_index(1)->size(), 0);
+        t->add_empty_row(10);
+        t->set_int(1, 3, -1);
+        check_index(t, 1);
+        check_index(t, 4);
+        CHECK_EQUAL(t->get_range_index(1)->get(0), 3);
+
+        // Columns keep their indexes when others are inserted and removed
+        t->insert_column(0, type_Int, "first");
+        t->add_column(type_Int, "last");
+        t->add_range_index(8);
+        t->set_int(8, 7, -5);
+        check_index(t, 2);
+        check_index(t, 8);
+        t->remove_column(0);
+        CHECK_EQUAL(t->get_range_index(7)->get(0), 7);
+        check_index(t, 1);
+        wt.commit();
+    }
+}
+
 TEST(Table_ColumnsSupportStringIndex)
 {
     std::vector<DataType> all_types{type_Int,    type_Bool,        type_Float,     type_Double, type_String,
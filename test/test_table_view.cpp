@@ -1553,6 +1553,282 @@ TEST(TableView_QueryCopy)
     CHECK_EQUAL(t, 2);
 }
 
+TEST(TableView_SortByExtractedKeys)
+{
+    // Int, bool, timestamp and enumerated string columns are sorted by keys extracted from the column, and by a
+    // radix sort when there are enough rows. The result must be the same as when the values are compared in the
+    // column, including where nulls and null links go and that ties keep the order of the view.
+    Group g;
+    TableRef t = g.add_table("t");
+    size_t int_col = t->add_column(type_Int, "int");
+    size_t nullable_col = t->add_column(type_Int, "nullable", true);
+    size_t bool_col = t->add_column(type_Bool, "bool", true);
+    size_t date_col = t->add_column(type_Timestamp, "date", true);
+    size_t enum_col = t->add_column(type_String, "enum", true);
+    size_t str_col = t->add_column(type_String, "str");
+    size_t link_col = t->add_column_link(type_Link, "link", *t);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* strings[] = {"b", "a", "B", "\xc3\xa6", "ab", ""};
+    const size_t num_rows = 2000;
+    t->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        int64_t value = random.draw_int<int64_t>();
+        if (random.draw_bool())
+            value = random.draw_int_mod(4) == 0 ? std::numeric_limits<int64_t>::min() : random.draw_int(-10, 10);
+        t->set_int(int_col, i, value);
+        if (random.draw_int_mod(5) != 0)
+            t->set_int(nullable_col, i, random.draw_int(-50, 50));
+        if (random.draw_int_mod(5) != 0)
+            t->set_bool(bool_col, i, random.draw_bool());
+        if (random.draw_int_mod(5) != 0) {
+            int64_t seconds = random.draw_int(-10, 10);
+            int32_t nanoseconds = int32_t(random.draw_int_mod(3) * 1000);
+            t->set_timestamp(date_col, i, Timestamp(seconds, seconds < 0 ? -nanoseconds : nanoseconds));
+        }
+        if (random.draw_int_mod(7) != 0)
+            t->set_string(enum_col, i, strings[random.draw_int_mod(6)]);
+        std::string str = util::to_string(random.draw_int_mod(num_rows));
+        t->set_string(str_col, i, str);
+        if (random.draw_int_mod(4) != 0)
+            t->set_link(link_col, i, random.draw_int_mod(num_rows));
+    }
+    t->optimize();
+    CHECK_EQUAL(_impl::TableFriend::get_spec(*t).get_column_type(enum_col), col_type_StringEnum);
+    CHECK_EQUAL(_impl::TableFriend::get_spec(*t).get_column_type(str_col), col_type_String);
+
+    // Sort the rows of `tv` one by one with compare_values(), and check that sorting the view gives the same order
+    auto check_sort = [&](TableView tv, std::vector<std::vector<size_t>> columns, std::vector<bool> ascending) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < tv.size(); ++i)
+            expected.push_back(tv.get_source_ndx(i));
+        std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                size_t row_a = a, row_b = b;
+                bool null_a = false, null_b = false;
+                for (size_t j = 0; j + 1 < columns[c].size(); ++j) {
+                    null_a = null_a || t->is_null_link(columns[c][j], row_a);
+                    null_b = null_b || t->is_null_link(columns[c][j], row_b);
+                    if (!null_a)
+                        row_a = t->get_link(columns[c][j], row_a);
+                    if (!null_b)
+                        row_b = t->get_link(columns[c][j], row_b);
+                }
+                if (null_a && null_b)
+                    continue;
+                if (null_a || null_b)
+                    return ascending[c] != null_a;
+                const ColumnBase& column = _impl::TableFriend::get_column(*t, columns[c].back());
+                if (int cmp = column.compare_values(row_a, row_b))
+                    return ascending[c] ? cmp > 0 : cmp < 0;
+            }
+            return false;
+        });
+
+        tv.sort(SortDescriptor(*t, columns, ascending));
+        CHECK_EQUAL(tv.size(), expected.size());
+        size_t num_mismatches = 0;
+        for (size_t i = 0; i < tv.size(); ++i) {
+            if (tv.get_source_ndx(i) != expected[i])
+                ++num_mismatches;
+        }
+        CHECK_EQUAL(num_mismatches, 0);
+    };
+
+    // Views in table order, in an order of their own, and too small for a radix sort
+    std::vector<TableView> views;
+    views.push_back(t->where().find_all());
+    views.push_back(t->where().find_all());
+    views.back().sort(str_col);
+    views.push_back(t->where().less(nullable_col, -40).find_all());
+    CHECK_LESS(views.back().size(), 256);
+
+    for (auto& tv : views) {
+        for (bool ascending : {true, false}) {
+            check_sort(tv, {{int_col}}, {ascending});
+            check_sort(tv, {{nullable_col}}, {ascending});
+            check_sort(tv, {{bool_col}}, {ascending});
+            check_sort(tv, {{date_col}}, {ascending});
+            check_sort(tv, {{enum_col}}, {ascending});
+            check_sort(tv, {{link_col, nullable_col}}, {ascending});
+            check_sort(tv, {{link_col, link_col, enum_col}}, {ascending});
+            check_sort(tv, {{bool_col}, {date_col}}, {ascending, !ascending});
+            check_sort(tv, {{enum_col}, {link_col, int_col}, {nullable_col}}, {ascending, ascending, !ascending});
+            check_sort(tv, {{str_col}, {nullable_col}}, {ascending, !ascending});
+            check_sort(tv, {{bool_col}, {str_col}}, {ascending, ascending});
+        }
+    }
+}
+
+TEST(TableView_SortAndDistinctWithThreads)
+{
+    // A view from a query with several threads sorts and removes duplicates in parallel when it is large enough,
+    // which must give the same rows in the same order as on a single thread
+    Table t;
+    size_t int_col = t.add_column(type_Int, "int");
+    size_t str_col = t.add_column(type_String, "str", true);
+    size_t double_col = t.add_column(type_Double, "double");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const size_t num_rows = 45000;
+    t.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        t.set_int(int_col, i, random.draw_int(-1000, 1000));
+        std::string str = util::to_string(random.draw_int_mod(5000));
+        if (random.draw_int_mod(10) != 0)
+            t.set_string(str_col, i, str);
+        t.set_double(double_col, i, random.draw_int_mod(100) / 4.0);
+    }
+
+    Query query = t.where().greater(int_col, -900);
+    Query threaded_query = query;
+    threaded_query.set_threads(4);
+
+    auto check_ordering = [&](DescriptorOrdering ordering) {
+        TableView tv = query.find_all();
+        TableView threaded_tv = threaded_query.find_all();
+        CHECK_GREATER(tv.size(), 40000);
+        tv.apply_descriptor_ordering(ordering);
+        threaded_tv.apply_descriptor_ordering(ordering);
+        CHECK_EQUAL(threaded_tv.size(), tv.size());
+        size_t num_mismatches = 0;
+        for (size_t i = 0; i < std::min(tv.size(), threaded_tv.size()); ++i) {
+            if (tv.get_source_ndx(i) != threaded_tv.get_source_ndx(i))
+                ++num_mismatches;
+        }
+        CHECK_EQUAL(num_mismatches, 0);
+    };
+
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor(t, {{int_col}}));
+    check_ordering(ordering);
+
+    ordering = DescriptorOrdering();
+    ordering.append_sort(SortDescriptor(t, {{str_col}}, {false}));
+    check_ordering(ordering);
+
+    ordering = DescriptorOrdering();
+    ordering.append_sort(SortDescriptor(t, {{double_col}, {int_col}}, {true, false}));
+    check_ordering(ordering);
+
+    ordering = DescriptorOrdering();
+    ordering.append_distinct(DistinctDescriptor(t, {{str_col}}));
+    check_ordering(ordering);
+
+    ordering = DescriptorOrdering();
+    ordering.append_sort(SortDescriptor(t, {{double_col}}));
+    ordering.append_distinct(DistinctDescriptor(t, {{str_col}, {int_col}}));
+    ordering.append_limit(LimitDescriptor(30000));
+    check_ordering(ordering);
+}
+
+TEST(TableView_DistinctByHash)
+{
+    // Distinct keeps the first row with each set of values, and the rows in their order in the view, whether the
+    // duplicates are found by hashing the values or, for other column types, by sorting the rows
+    Group g;
+    TableRef t = g.add_table("t");
+    size_t int_col = t->add_column(type_Int, "int", true);
+    size_t str_col = t->add_column(type_String, "str", true);
+    size_t enum_col = t->add_column(type_String, "enum");
+    size_t float_col = t->add_column(type_Float, "float", true);
+    size_t double_col = t->add_column(type_Double, "double");
+    size_t date_col = t->add_column(type_Timestamp, "date");
+    size_t binary_col = t->add_column(type_Binary, "binary");
+    size_t link_col = t->add_column_link(type_Link, "link", *t);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const size_t num_rows = 1000;
+    const char* binaries[] = {"a", "b", "c"};
+    t->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (random.draw_int_mod(8) != 0)
+            t->set_int(int_col, i, random.draw_int(-20, 20));
+        // Too many distinct strings for optimize() to turn the column into an enumerated one
+        std::string str = util::to_string(random.draw_int_mod(2000));
+        if (random.draw_int_mod(8) != 0)
+            t->set_string(str_col, i, str);
+        std::string enum_str = util::to_string(random.draw_int_mod(5));
+        t->set_string(enum_col, i, enum_str);
+        if (random.draw_int_mod(8) != 0)
+            t->set_float(float_col, i, random.draw_int(-3, 3) / 2.0f);
+        // Zero and negative zero are the same value
+        t->set_double(double_col, i, random.draw_bool() ? 0.0 : -0.0);
+        t->set_timestamp(date_col, i, Timestamp(random.draw_int(0, 3), int32_t(random.draw_int_mod(2))));
+        t->set_binary(binary_col, i, BinaryData(binaries[random.draw_int_mod(3)], 1));
+        if (random.draw_int_mod(4) != 0)
+            t->set_link(link_col, i, random.draw_int_mod(num_rows));
+    }
+    t->optimize();
+    CHECK_EQUAL(_impl::TableFriend::get_spec(*t).get_column_type(enum_col), col_type_StringEnum);
+    CHECK_EQUAL(_impl::TableFriend::get_spec(*t).get_column_type(str_col), col_type_String);
+
+    auto check_distinct = [&](TableView tv, std::vector<std::vector<size_t>> columns) {
+        // Rows with a null link on the way to a column are removed, and of the others, those with the same values as
+        // a row before them
+        std::vector<size_t> expected;
+        std::vector<std::vector<size_t>> expected_targets;
+        for (size_t i = 0; i < tv.size(); ++i) {
+            std::vector<size_t> targets;
+            for (auto& chain : columns) {
+                size_t row = tv.get_source_ndx(i);
+                for (size_t j = 0; j + 1 < chain.size() && row != npos; ++j)
+                    row = t->is_null_link(chain[j], row) ? npos : t->get_link(chain[j], row);
+                if (row == npos)
+                    break;
+                targets.push_back(row);
+            }
+            if (targets.size() < columns.size())
+                continue;
+            bool is_duplicate = std::any_of(expected_targets.begin(), expected_targets.end(), [&](auto& other) {
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    const ColumnBase& column = _impl::TableFriend::get_column(*t, columns[c].back());
+                    if (column.compare_values(targets[c], other[c]) != 0)
+                        return false;
+                }
+                return true;
+            });
+            if (!is_duplicate) {
+                expected.push_back(tv.get_source_ndx(i));
+                expected_targets.push_back(targets);
+            }
+        }
+
+        tv.distinct(DistinctDescriptor(*t, columns));
+        CHECK_EQUAL(tv.size(), expected.size());
+        size_t num_mismatches = 0;
+        for (size_t i = 0; i < std::min(tv.size(), expected.size()); ++i) {
+            if (tv.get_source_ndx(i) != expected[i])
+                ++num_mismatches;
+        }
+        CHECK_EQUAL(num_mismatches, 0);
+    };
+
+    std::vector<TableView> views;
+    views.push_back(t->where().find_all());
+    views.push_back(t->where().find_all());
+    views.back().sort(SortDescriptor(*t, {{str_col}, {int_col}}, {false, true}));
+
+    for (auto& tv : views) {
+        check_distinct(tv, {{int_col}});
+        check_distinct(tv, {{str_col}});
+        check_distinct(tv, {{enum_col}});
+        check_distinct(tv, {{float_col}});
+        check_distinct(tv, {{double_col}});
+        check_distinct(tv, {{date_col}});
+        check_distinct(tv, {{binary_col}});
+        check_distinct(tv, {{int_col}, {enum_col}});
+        check_distinct(tv, {{float_col}, {double_col}, {date_col}});
+        check_distinct(tv, {{link_col, str_col}});
+        check_distinct(tv, {{link_col, link_col, enum_col}, {binary_col}});
+        check_distinct(tv, {{link_col, int_col}, {enum_col}});
+    }
+
+    TableView tv = t->where().find_all();
+    tv.distinct(double_col);
+    CHECK_EQUAL(tv.size(), 1);
+}
+
 TEST(TableView_SortEnum)
 {
     Table table;
@@ -3470,4 +3746,52 @@ TEST(TableView_TimestampMaxRemoveRow)
     CHECK_EQUAL(tv.maximum_timestamp(0), Timestamp(8, 0));
 }
 
+// The row indexes of large views are stored in encoded form. They must stay
+// correct as rows are inserted and removed, both before and after a sync.
+TEST(TableView_EncodedRowIndexes)
+{
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 17;
+    Table table;
+    table.add_column(type_Int, "value");
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+        table.set_int(0, i, i % 10);
+
+    TableView all = table.where().find_all();
+    TableView most = table.where().not_equal(0, 3).find_all();
+    TableView first = table.where().not_equal(0, 3).find_all(0, size_t(-1), REALM_MAX_BPNODE_SIZE + 1);
+
+    auto check = [&](const TableView& tv, size_t limit) {
+        size_t n = 0;
+        for (size_t i = 0; i < table.size() && n < limit; ++i) {
+            if (&tv != &all && table.get_int(0, i) == 3)
+                continue;
+            CHECK_EQUAL(tv.get_source_ndx(n), i);
+            ++n;
+        }
+        CHECK_EQUAL(tv.size(), n);
+    };
+    check(all, size_t(-1));
+    check(most, size_t(-1));
+    check(first, REALM_MAX_BPNODE_SIZE + 1);
+    CHECK_EQUAL(most.sum_int(0), table.sum_int(0) - 3 * table.count_int(0, 3));
+
+    table.insert_empty_row(REALM_MAX_BPNODE_SIZE + 2);
+    table.set_int(0, REALM_MAX_BPNODE_SIZE + 2, 3);
+    table.add_empty_row();
+    table.remove(5);
+    table.move_last_over(2 * REALM_MAX_BPNODE_SIZE);
+    all.sync_if_needed();
+    most.sync_if_needed();
+    first.sync_if_needed();
+    check(all, size_t(-1));
+    check(most, size_t(-1));
+    check(first, REALM_MAX_BPNODE_SIZE + 1);
+
+    most.sort(0);
+    CHECK_EQUAL(most.size(), table.size() - table.count_int(0, 3));
+    for (size_t i = 1; i < most.size(); ++i)
+        CHECK_LESS_EQUAL(most.get_int(0, i - 1), most.get_int(0, i));
+}
+
 #endif // TEST_TABLE_VIEW
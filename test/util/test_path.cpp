@@ -180,6 +180,7 @@ void SharedGroupTestPathGuard::cleanup() const noexcept
         if (File::is_dir(m_path + ".management"))
             remove_dir(m_path + ".management");
         File::try_remove(get_lock_path());
+        File::try_remove(m_path + ".wal");
     }
     catch (...) {
         // Exception deliberately ignored